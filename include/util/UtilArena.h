@@ -0,0 +1,82 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_UTIL_ARENA_H
+#define EXEIN_UTIL_ARENA_H
+
+#pragma once
+
+// Monotonic memory resource for records that all die at the same time. Memory is only
+// ever handed out, deallocations are no-ops and everything is returned to the heap in
+// a few large blocks when the arena is destroyed. Unlike std::pmr::monotonic_buffer_resource
+// it can be shared by threads that fill different containers at the same time.
+class Arena : public std::pmr::memory_resource
+{
+public:
+	Arena(size_t initial_size = k_default_initial_size) :
+		m_resource(initial_size)
+	{
+	}
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+public:
+	// Total of bytes handed out so far
+	inline size_t get_num_bytes() const
+	{
+		std::lock_guard lock(m_mutex);
+		return m_num_bytes;
+	}
+
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override
+	{
+		std::lock_guard lock(m_mutex);
+		m_num_bytes += bytes;
+		return m_resource.allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void*, size_t, size_t) override
+	{
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+
+private:
+	static constexpr size_t k_default_initial_size = 64 * 1024;
+
+	mutable std::mutex m_mutex;
+	std::pmr::monotonic_buffer_resource m_resource;
+	size_t m_num_bytes = 0;
+};
+
+#endif
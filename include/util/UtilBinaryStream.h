@@ -0,0 +1,152 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_BINARY_STREAM_H
+#define EXEIN_BINARY_STREAM_H
+
+#pragma once
+
+// Compact little-endian binary records, used by the parse cache. Values are written
+// as their raw bytes, so only trivially copyable types are accepted and the format
+// is tied to the byte order of the machine (same as the cache directory itself).
+class BinaryWriter
+{
+public:
+	template<typename T> requires(std::is_trivially_copyable<T>::value)
+	inline void write(const T& value)
+	{
+		auto p = reinterpret_cast<const uint8_t*>(&value);
+		m_data.insert(m_data.end(), p, p + sizeof(T));
+	}
+
+	// Length-prefixed
+	inline void write_string(std::string_view str)
+	{
+		write((uint32_t)str.size());
+		m_data.insert(m_data.end(), str.begin(), str.end());
+	}
+
+	template<typename T, typename Alloc> requires(std::is_trivially_copyable<T>::value)
+	inline void write_array(const std::vector<T, Alloc>& values)
+	{
+		write((uint32_t)values.size());
+
+		auto p = reinterpret_cast<const uint8_t*>(values.data());
+		m_data.insert(m_data.end(), p, p + values.size() * sizeof(T));
+	}
+
+	inline const auto& data() const { return m_data; }
+
+private:
+	std::vector<uint8_t> m_data;
+};
+
+// Reads records written by BinaryWriter. Every read is bounds-checked, once a read
+// fails the reader stays failed and all following reads return false too, so that
+// a whole record can be read first and checked only once at the end.
+class BinaryReader
+{
+public:
+	BinaryReader(const uint8_t* data, size_t size) :
+		m_data(data), m_size(size)
+	{
+	}
+
+	template<typename T> requires(std::is_trivially_copyable<T>::value)
+	inline bool read(T& value)
+	{
+		if (!can_read(sizeof(T)))
+			return false;
+
+		std::memcpy(&value, m_data + m_pos, sizeof(T));
+		m_pos += sizeof(T);
+		return true;
+	}
+
+	// For loops, e.g. reading a count in a for statement
+	template<typename T> requires(std::is_trivially_copyable<T>::value)
+	inline T read()
+	{
+		T value = {};
+		read(value);
+		return value;
+	}
+
+	inline bool read_string(std::string& str)
+	{
+		uint32_t size;
+		if (!read(size) || !can_read(size))
+			return false;
+
+		str.assign(reinterpret_cast<const char*>(m_data + m_pos), size);
+		m_pos += size;
+		return true;
+	}
+
+	template<typename T, typename Alloc> requires(std::is_trivially_copyable<T>::value)
+	inline bool read_array(std::vector<T, Alloc>& values)
+	{
+		uint32_t count;
+		if (!read(count) || !can_read((uint64_t)count * sizeof(T)))
+			return false;
+
+		values.resize(count);
+		if (count)
+			std::memcpy(values.data(), m_data + m_pos, count * sizeof(T));
+		m_pos += count * sizeof(T);
+		return true;
+	}
+
+	// Upper bound for a count that was read from the stream, so that a corrupted
+	// count can't make the caller reserve gigabytes.
+	inline bool can_hold(uint64_t count, size_t min_element_size) const
+	{
+		return !m_failed && count <= (m_size - m_pos) / min_element_size;
+	}
+
+	inline bool failed() const { return m_failed; }
+	inline bool at_end() const { return m_pos == m_size; }
+
+private:
+	inline bool can_read(uint64_t size)
+	{
+		if (m_failed || size > m_size - m_pos)
+			m_failed = true;
+
+		return !m_failed;
+	}
+
+private:
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_pos = 0;
+
+	bool m_failed = false;
+};
+
+#endif
@@ -43,6 +43,10 @@ public:
 	// Create data from a buffer
 	bool create(uint8_t* data, A size);
 
+	// Map the file into memory instead of copying it. The view is read-only and
+	// private, so the file contents are paged in by the OS only when touched.
+	bool map(const std::filesystem::path& filepath, A size);
+
 	void destroy();
 
 private:
@@ -58,33 +62,79 @@ private:
 	// Copy data from buffer
 	bool copy_data(uint8_t* data);
 
+	// Creates and releases the read-only file view
+	bool map_view(const std::filesystem::path& filepath);
+	void unmap_view();
+
 public:
 	inline uint8_t* const get_raw() const { return m_byte_buffer; }
 	inline auto get_size() const { return m_size; }
 
-	// Returns pointer to the address at specified offset
+	inline bool is_mapped() const { return m_mapped; }
+
+	// Returns pointer to the address at specified offset, nullptr unless the whole T
+	// lies inside of the buffer.
 	template<class T>
 	inline T* get_at(A off) const
+	{
+		return get_array_at<T>(off, 1);
+	}
+
+	// Same as get_at(), for count consecutive elements
+	template<class T>
+	inline T* get_array_at(A off, A count) const
 	{
 		if (!m_byte_buffer)
 			return nullptr;
 
 		if (off >= m_size)
 		{
-			CDebugConsole::get().output_error(std::format("Offset too large: 0x{:08X} (limit=0x{:08X}, exceeded=0x{:08X})", 
-														  off, m_size, off - m_size));
+			CDebugConsole::get().output_error("Offset too large: 0x{:08X} (limit=0x{:08X}, exceeded=0x{:08X})", 
+											  off, m_size, off - m_size);
+			return nullptr;
+		}
+
+		// A file view ends right at the end of the file, there's no slack to read into
+		if (count > (m_size - off) / sizeof(T))
+		{
+			CDebugConsole::get().output_error("Data at 0x{:08X} runs past the end of the buffer (0x{:X} elements of {} bytes, limit=0x{:08X})",
+											  off, count, sizeof(T), m_size);
 			return nullptr;
 		}
 
 		return reinterpret_cast<T*>(m_byte_buffer + off);
 	}
 
+	// Returns view of a NUL-terminated string at specified offset. Nothing is copied, the
+	// view is valid for as long as the buffer is. A string that isn't terminated before
+	// the end of the buffer yields an empty view. The view is always followed by a NUL.
+	inline std::string_view get_cstring_at(A off) const
+	{
+		auto str = get_at<const char>(off);
+
+		if (!str)
+			return "";
+
+		auto terminator = reinterpret_cast<const char*>(memchr(str, '\0', static_cast<size_t>(m_size - off)));
+
+		if (!terminator)
+		{
+			CDebugConsole::get().output_error("Unterminated string at 0x{:08X}", off);
+			return "";
+		}
+
+		return std::string_view(str, terminator - str);
+	}
+
 	// Converts all bytes into readable string form
 	std::string to_string(A at, const std::string& delimiter = " ") const;
 
 private:
-	uint8_t* m_byte_buffer;
-	A m_size;
+	uint8_t* m_byte_buffer = nullptr;
+	A m_size = 0;
+
+	// True if the buffer is a file view rather than our own allocation
+	bool m_mapped = false;
 };
 
 template<typename A> requires(std::is_integral<A>::value)
@@ -96,7 +146,7 @@ inline bool ByteBuffer<A>::create(const std::filesystem::path& filepath, A size)
 	if (!copy_data(filepath))
 		return false;
 
-	CDebugConsole::get().output_message(std::format("Created byte buffer from {} of size {} bytes", filepath.string(), size));
+	CDebugConsole::get().output_message<LogCategory::Io>("Created byte buffer from {} of size {} bytes", filepath.string(), size);
 
 	return true;
 }
@@ -110,7 +160,26 @@ inline bool ByteBuffer<A>::create(uint8_t* data, A size)
 	if (!copy_data(data))
 		return false;
 
-	CDebugConsole::get().output_message(std::format("Created byte buffer from raw buffer of size {} bytes", size));
+	CDebugConsole::get().output_message<LogCategory::Io>("Created byte buffer from raw buffer of size {} bytes", size);
+
+	return true;
+}
+
+template<typename A> requires(std::is_integral<A>::value)
+inline bool ByteBuffer<A>::map(const std::filesystem::path& filepath, A size)
+{
+	if (!size)
+	{
+		CDebugConsole::get().output_error("Cannot map an empty file");
+		return false;
+	}
+
+	m_size = size;
+
+	if (!map_view(filepath))
+		return false;
+
+	CDebugConsole::get().output_message<LogCategory::Io>("Mapped byte buffer from {} of size {} bytes", filepath.string(), size);
 
 	return true;
 }
@@ -118,7 +187,10 @@ inline bool ByteBuffer<A>::create(uint8_t* data, A size)
 template<typename A> requires(std::is_integral<A>::value)
 inline void ByteBuffer<A>::destroy()
 {
-	deallocate();
+	if (m_mapped)
+		unmap_view();
+	else
+		deallocate();
 }
 
 template<typename A> requires(std::is_integral<A>::value)
@@ -134,7 +206,7 @@ inline bool ByteBuffer<A>::allocate(A size)
 		return false;
 	}
 
-	CDebugConsole::get().output_message("Allocated byte buffer");
+	CDebugConsole::get().output_message<LogCategory::Io>("Allocated byte buffer");
 
 	return true;
 }
@@ -151,7 +223,7 @@ inline void ByteBuffer<A>::deallocate()
 	delete[] m_byte_buffer;
 	m_byte_buffer = nullptr;
 
-	CDebugConsole::get().output_message("Deallocated byte buffer");
+	CDebugConsole::get().output_message<LogCategory::Io>("Deallocated byte buffer");
 }
 
 template<typename A> requires(std::is_integral<A>::value)
@@ -167,8 +239,8 @@ inline bool ByteBuffer<A>::copy_data(const std::filesystem::path& filepath)
 
 	ifs.read(reinterpret_cast<char*>(m_byte_buffer), m_size);
 
-	CDebugConsole::get().output_message(std::format("Read {} from file to the buffer",
-													CUtil::make_filesize_nice(m_size)));
+	CDebugConsole::get().output_message<LogCategory::Io>("Read {} from file to the buffer",
+										CUtil::make_filesize_nice(m_size));
 
 	ifs.close();
 
@@ -186,12 +258,98 @@ inline bool ByteBuffer<A>::copy_data(uint8_t* data)
 
 	memcpy(m_byte_buffer, data, m_size);
 
-	CDebugConsole::get().output_message(std::format("Copied {} from raw data stream",
-													CUtil::make_filesize_nice(m_size)));
+	CDebugConsole::get().output_message<LogCategory::Io>("Copied {} from raw data stream",
+										CUtil::make_filesize_nice(m_size));
+
+	return true;
+}
+
+template<typename A> requires(std::is_integral<A>::value)
+inline bool ByteBuffer<A>::map_view(const std::filesystem::path& filepath)
+{
+	// A 32-bit process simply cannot fit such view inside its address space.
+	if (m_size > SIZE_MAX)
+	{
+		CDebugConsole::get().output_error("File too large to be mapped by this build ({} bytes)", m_size);
+		return false;
+	}
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		CDebugConsole::get().output_error("Failed to open the file for mapping (error {})", GetLastError());
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	// The view keeps the mapping object alive on its own, so we can close the file right away.
+	CloseHandle(file);
+
+	if (!mapping)
+	{
+		CDebugConsole::get().output_error("Failed to create file mapping (error {})", GetLastError());
+		return false;
+	}
+
+	m_byte_buffer = reinterpret_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(m_size)));
+
+	CloseHandle(mapping);
+
+	if (!m_byte_buffer)
+	{
+		CDebugConsole::get().output_error("Failed to map view of the file (error {})", GetLastError());
+		return false;
+	}
+#else
+	int fd = open(filepath.c_str(), O_RDONLY);
+	if (fd == -1)
+	{
+		CDebugConsole::get().output_error("Failed to open the file for mapping (errno {})", errno);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// Same as on windows, the mapping outlives the descriptor.
+	close(fd);
+
+	if (view == MAP_FAILED)
+	{
+		CDebugConsole::get().output_error("Failed to map the file (errno {})", errno);
+		return false;
+	}
+
+	m_byte_buffer = reinterpret_cast<uint8_t*>(view);
+#endif
+
+	m_mapped = true;
 
 	return true;
 }
 
+template<typename A> requires(std::is_integral<A>::value)
+inline void ByteBuffer<A>::unmap_view()
+{
+	if (!m_byte_buffer)
+	{
+		CDebugConsole::get().output_error("Tried to unmap nullptr byte buffer");
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_byte_buffer);
+#else
+	munmap(m_byte_buffer, static_cast<size_t>(m_size));
+#endif
+
+	m_byte_buffer = nullptr;
+	m_mapped = false;
+
+	CDebugConsole::get().output_message<LogCategory::Io>("Unmapped byte buffer");
+}
+
 template<typename A> requires(std::is_integral<A>::value)
 inline std::string ByteBuffer<A>::to_string(A at, const std::string& delimiter) const
 {
@@ -200,7 +358,7 @@ inline std::string ByteBuffer<A>::to_string(A at, const std::string& delimiter)
 
 	if (at >= m_size - at)
 	{
-		CDebugConsole::get().output_error(std::format("Byte buffer: offset too big: val={} off={}", at, m_size - at));
+		CDebugConsole::get().output_error("Byte buffer: offset too big: val={} off={}", at, m_size - at);
 		return "null";
 	}
 
@@ -0,0 +1,195 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_CHECKSUM_H
+#define EXEIN_CHECKSUM_H
+
+#pragma once
+
+// The image checksum stored in the optional header. It's the sum of every dword of
+// the file folded with end-around carry into 16 bits, plus the size of the file.
+// The end-around carry makes the sum associative modulo 0xFFFF, so we can add the
+// dwords up into plain 64-bit sums (vectorized and split into any amount of pieces)
+// and fold only once at the very end.
+class ImageChecksum
+{
+public:
+	// Sum of the little-endian dwords inside of [data, data + size), the last one
+	// padded with zeros. Exact as long as there are less than 2^32 dwords, so the
+	// sums of pieces of a file can be simply added together.
+	static uint64_t sum_dwords(const uint8_t* data, size_t size);
+
+	// Folds the sum of all of the dwords into the final checksum
+	static uint32_t finish(uint64_t sum, uint64_t file_size);
+
+private:
+	using SumFn_t = uint64_t(*)(const uint8_t* p, size_t num_blocks);
+
+	// Sum num_blocks * 64 bytes
+	static uint64_t sum_blocks_scalar(const uint8_t* p, size_t num_blocks);
+#ifdef EXEIN_X86_SIMD
+	static uint64_t sum_blocks_sse2(const uint8_t* p, size_t num_blocks);
+	EXEIN_TARGET_AVX2 static uint64_t sum_blocks_avx2(const uint8_t* p, size_t num_blocks);
+#endif
+
+	// Picks the fastest kernel supported by this cpu
+	static SumFn_t select_sum_blocks();
+
+	static inline uint32_t load_dword(const uint8_t* p)
+	{
+		uint32_t dw;
+		std::memcpy(&dw, p, sizeof(dw));
+		return dw;
+	}
+};
+
+inline uint64_t ImageChecksum::sum_blocks_scalar(const uint8_t* p, size_t num_blocks)
+{
+	// Independent accumulators, so that the additions don't wait on each other
+	uint64_t sum[4] = {};
+
+	for (size_t i = 0; i < num_blocks; i++, p += 64)
+	{
+		for (uint32_t j = 0; j < 16; j += 4)
+		{
+			sum[0] += load_dword(p + j * 4);
+			sum[1] += load_dword(p + j * 4 + 4);
+			sum[2] += load_dword(p + j * 4 + 8);
+			sum[3] += load_dword(p + j * 4 + 12);
+		}
+	}
+
+	return sum[0] + sum[1] + sum[2] + sum[3];
+}
+
+#ifdef EXEIN_X86_SIMD
+// Dwords are widened into 64-bit lanes, which can't overflow, so there's no carry
+// to take care of inside of the loop.
+
+inline uint64_t ImageChecksum::sum_blocks_sse2(const uint8_t* p, size_t num_blocks)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i sum0 = _mm_setzero_si128();
+	__m128i sum1 = _mm_setzero_si128();
+
+	for (size_t i = 0; i < num_blocks; i++, p += 64)
+	{
+		for (uint32_t j = 0; j < 4; j++)
+		{
+			__m128i dwords = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + j * 16));
+
+			sum0 = _mm_add_epi64(sum0, _mm_unpacklo_epi32(dwords, zero));
+			sum1 = _mm_add_epi64(sum1, _mm_unpackhi_epi32(dwords, zero));
+		}
+	}
+
+	__m128i sum = _mm_add_epi64(sum0, sum1);
+	sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+
+	uint64_t result;
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(&result), sum);
+	return result;
+}
+
+EXEIN_TARGET_AVX2 inline uint64_t ImageChecksum::sum_blocks_avx2(const uint8_t* p, size_t num_blocks)
+{
+	const __m256i low_dwords = _mm256_set1_epi64x(0xFFFFFFFF);
+
+	__m256i sum_lo0 = _mm256_setzero_si256(), sum_hi0 = _mm256_setzero_si256();
+	__m256i sum_lo1 = _mm256_setzero_si256(), sum_hi1 = _mm256_setzero_si256();
+
+	for (size_t i = 0; i < num_blocks; i++, p += 64)
+	{
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+
+		sum_lo0 = _mm256_add_epi64(sum_lo0, _mm256_and_si256(a, low_dwords));
+		sum_hi0 = _mm256_add_epi64(sum_hi0, _mm256_srli_epi64(a, 32));
+		sum_lo1 = _mm256_add_epi64(sum_lo1, _mm256_and_si256(b, low_dwords));
+		sum_hi1 = _mm256_add_epi64(sum_hi1, _mm256_srli_epi64(b, 32));
+	}
+
+	__m256i sum = _mm256_add_epi64(_mm256_add_epi64(sum_lo0, sum_hi0), _mm256_add_epi64(sum_lo1, sum_hi1));
+	__m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi64(half, _mm_unpackhi_epi64(half, half));
+
+	uint64_t result;
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(&result), half);
+	return result;
+}
+#endif
+
+inline ImageChecksum::SumFn_t ImageChecksum::select_sum_blocks()
+{
+#ifdef EXEIN_X86_SIMD
+	if (CpuFeatures::get().has_avx2())
+		return &sum_blocks_avx2;
+
+	if (CpuFeatures::get().has_sse2())
+		return &sum_blocks_sse2;
+#endif
+
+	return &sum_blocks_scalar;
+}
+
+inline uint64_t ImageChecksum::sum_dwords(const uint8_t* data, size_t size)
+{
+	static const SumFn_t sum_blocks = select_sum_blocks();
+
+	size_t num_blocks = size / 64;
+	uint64_t sum = sum_blocks(data, num_blocks);
+
+	// Remaining dwords and the zero padded last one
+	size_t pos = num_blocks * 64;
+	for (; pos + sizeof(uint32_t) <= size; pos += sizeof(uint32_t))
+		sum += load_dword(data + pos);
+
+	if (pos < size)
+	{
+		uint8_t last[sizeof(uint32_t)] = {};
+		std::memcpy(last, data + pos, size - pos);
+		sum += load_dword(last);
+	}
+
+	return sum;
+}
+
+inline uint32_t ImageChecksum::finish(uint64_t sum, uint64_t file_size)
+{
+	// Fold into 32 and then into 16 bits, the carries go back into the sum
+	while (sum >> 32)
+		sum = (sum & 0xFFFFFFFF) + (sum >> 32);
+
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	sum = (sum + (sum >> 16)) & 0xFFFF;
+
+	return static_cast<uint32_t>(sum + file_size);
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_CPU_FEATURES_H
+#define EXEIN_CPU_FEATURES_H
+
+#pragma once
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define EXEIN_X86_SIMD
+#endif
+
+// MSVC lets us use any intrinsic anywhere, gcc and clang want the function
+// itself to be compiled for the target instruction set.
+#if defined(EXEIN_X86_SIMD) && !defined(_MSC_VER)
+#define EXEIN_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define EXEIN_TARGET_AVX2
+#endif
+
+// Runtime detection of instruction set extensions that we have vectorized kernels for.
+// Kernels that use these must always have a scalar fallback.
+class CpuFeatures
+{
+public:
+	static const auto& get()
+	{
+		static CpuFeatures features;
+		return features;
+	}
+
+public:
+	inline bool has_sse2() const { return m_sse2; }
+	inline bool has_avx2() const { return m_avx2; }
+
+private:
+	CpuFeatures()
+	{
+#if defined(EXEIN_X86_SIMD) && defined(_MSC_VER)
+		int regs[4];
+
+		__cpuid(regs, 0);
+		int max_leaf = regs[0];
+
+		__cpuid(regs, 1);
+		m_sse2 = (regs[3] & (1 << 26)) != 0;
+
+		// AVX2 also needs the OS to preserve the upper halves of ymm registers.
+		bool osxsave = (regs[2] & (1 << 27)) != 0;
+		bool os_saves_ymm = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+
+		if (max_leaf >= 7 && os_saves_ymm)
+		{
+			__cpuidex(regs, 7, 0);
+			m_avx2 = (regs[1] & (1 << 5)) != 0;
+		}
+#elif defined(EXEIN_X86_SIMD)
+		// These take care of the OS support as well.
+		__builtin_cpu_init();
+		m_sse2 = __builtin_cpu_supports("sse2");
+		m_avx2 = __builtin_cpu_supports("avx2");
+#endif
+	}
+
+private:
+	bool m_sse2 = false;
+	bool m_avx2 = false;
+};
+
+#endif
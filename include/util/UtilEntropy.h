@@ -0,0 +1,236 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_ENTROPY_H
+#define EXEIN_ENTROPY_H
+
+#pragma once
+
+// Counts occurrences of every byte value. Consecutive bytes are often equal (padding,
+// zeroed data) and incrementing the same counter over and over makes every increment
+// wait for the store of the previous one. Bytes are spread over four sub-histograms
+// instead, so that there are four independent chains, and summed up at the end.
+class ByteHistogram
+{
+public:
+	// Adds the counts of [data, data + size) into histogram
+	static void count(const uint8_t* data, size_t size, uint32_t* histogram);
+};
+
+inline void ByteHistogram::count(const uint8_t* data, size_t size, uint32_t* histogram)
+{
+	uint32_t sub[4][256] = {};
+
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		uint64_t lo, hi;
+		std::memcpy(&lo, data + i, sizeof(lo));
+		std::memcpy(&hi, data + i + 8, sizeof(hi));
+
+		for (uint32_t shift = 0; shift < 64; shift += 32)
+		{
+			sub[0][(uint8_t)(lo >> shift)]++;
+			sub[1][(uint8_t)(lo >> (shift + 8))]++;
+			sub[2][(uint8_t)(lo >> (shift + 16))]++;
+			sub[3][(uint8_t)(lo >> (shift + 24))]++;
+			sub[0][(uint8_t)(hi >> shift)]++;
+			sub[1][(uint8_t)(hi >> (shift + 8))]++;
+			sub[2][(uint8_t)(hi >> (shift + 16))]++;
+			sub[3][(uint8_t)(hi >> (shift + 24))]++;
+		}
+	}
+
+	for (; i < size; i++)
+		sub[0][data[i]]++;
+
+	for (uint32_t b = 0; b < 256; b++)
+		histogram[b] += sub[0][b] + sub[1][b] + sub[2][b] + sub[3][b];
+}
+
+// Shannon entropy in bits per byte (0 to 8) of a stream of bytes, both of the whole of it
+// and of windows sliding over it by half of their size. High entropy of the whole section
+// hints at packed or encrypted data, high entropy of a window at a blob inside of it.
+// Data can be fed in pieces of any size.
+class EntropyMeter
+{
+public:
+	static inline constexpr size_t k_window_size = 4096;
+	static inline constexpr size_t k_window_step = k_window_size / 2;
+
+public:
+	void update(const uint8_t* data, size_t size);
+
+	// Of everything fed so far
+	double entropy() const;
+
+	// Only whole windows are measured. If there are none, the entropy of the whole is returned.
+	double max_window_entropy() const;
+	inline const auto& get_window_entropies() const { return m_window_entropies; }
+
+	static double entropy_of(const uint64_t* histogram, uint64_t total);
+
+private:
+	void process_step(const uint8_t* step);
+
+	// c * log2(c) for every count a window can have
+	static const float* window_count_log_table();
+
+private:
+	uint64_t m_histogram[256] = {};
+	uint64_t m_total = 0;
+
+	// Counts of the previous and of the current step, the window spans both
+	uint32_t m_step_histograms[2][256] = {};
+	uint32_t m_num_steps = 0;
+
+	// Leftover that doesn't make a whole step yet
+	uint8_t m_step[k_window_step];
+	size_t m_step_used = 0;
+
+	std::vector<float> m_window_entropies;
+};
+
+inline void EntropyMeter::update(const uint8_t* data, size_t size)
+{
+	if (m_step_used)
+	{
+		size_t n = std::min(size, k_window_step - m_step_used);
+		std::memcpy(m_step + m_step_used, data, n);
+
+		m_step_used += n;
+		data += n;
+		size -= n;
+
+		if (m_step_used < k_window_step)
+			return;
+
+		process_step(m_step);
+		m_step_used = 0;
+	}
+
+	for (; size >= k_window_step; data += k_window_step, size -= k_window_step)
+		process_step(data);
+
+	if (size)
+	{
+		std::memcpy(m_step, data, size);
+		m_step_used = size;
+	}
+}
+
+inline void EntropyMeter::process_step(const uint8_t* step)
+{
+	uint32_t* current = m_step_histograms[m_num_steps % 2];
+	const uint32_t* previous = m_step_histograms[(m_num_steps + 1) % 2];
+
+	std::fill_n(current, 256, 0);
+	ByteHistogram::count(step, k_window_step, current);
+
+	m_total += k_window_step;
+	m_num_steps++;
+
+	if (m_num_steps < 2)
+	{
+		for (uint32_t b = 0; b < 256; b++)
+			m_histogram[b] += current[b];
+
+		return;
+	}
+
+	// log2(window) - sum(c * log2(c)) / window
+	static const float* count_log = window_count_log_table();
+
+	float sum = 0.f;
+	for (uint32_t b = 0; b < 256; b++)
+	{
+		m_histogram[b] += current[b];
+		sum += count_log[current[b] + previous[b]];
+	}
+
+	m_window_entropies.push_back(std::log2((float)k_window_size) - sum / k_window_size);
+}
+
+inline const float* EntropyMeter::window_count_log_table()
+{
+	static const auto table = []()
+	{
+		std::array<float, k_window_size + 1> t;
+		t[0] = 0.f;
+
+		for (size_t c = 1; c <= k_window_size; c++)
+			t[c] = (float)(c * std::log2((double)c));
+
+		return t;
+	}();
+
+	return table.data();
+}
+
+inline double EntropyMeter::entropy_of(const uint64_t* histogram, uint64_t total)
+{
+	if (!total)
+		return 0.0;
+
+	double entropy = 0.0;
+	for (uint32_t b = 0; b < 256; b++)
+	{
+		if (!histogram[b])
+			continue;
+
+		double p = (double)histogram[b] / total;
+		entropy -= p * std::log2(p);
+	}
+
+	return entropy;
+}
+
+inline double EntropyMeter::entropy() const
+{
+	if (!m_step_used)
+		return entropy_of(m_histogram, m_total);
+
+	// Leftover hasn't been counted yet
+	uint64_t histogram[256];
+	std::copy_n(m_histogram, 256, histogram);
+
+	for (size_t i = 0; i < m_step_used; i++)
+		histogram[m_step[i]]++;
+
+	return entropy_of(histogram, m_total + m_step_used);
+}
+
+inline double EntropyMeter::max_window_entropy() const
+{
+	if (m_window_entropies.empty())
+		return entropy();
+
+	return *std::max_element(m_window_entropies.begin(), m_window_entropies.end());
+}
+
+#endif
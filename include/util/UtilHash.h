@@ -0,0 +1,837 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_HASH_H
+#define EXEIN_HASH_H
+
+#pragma once
+
+// Incremental hash over 64-byte blocks (MD5, SHA-1, SHA-256). Data can be fed in pieces
+// of any size, whole blocks are hashed straight from the caller's memory and only
+// the leftover is copied. The derived class implements compress() and write_digest()
+// and tells whether the message length is stored as big-endian (k_big_endian).
+template<typename Derived, size_t DigestSize>
+class BlockHash
+{
+public:
+	using Digest_t = std::array<uint8_t, DigestSize>;
+
+	static inline constexpr size_t k_block_size = 64;
+
+public:
+	void update(const uint8_t* data, size_t size);
+
+	// The hash can't be updated anymore afterwards
+	Digest_t finish();
+
+	static std::string digest_to_string(const Digest_t& digest);
+
+protected:
+	static inline uint32_t load_be32(const uint8_t* p)
+	{
+		return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+	}
+
+	static inline void store_be32(uint8_t* p, uint32_t v)
+	{
+		p[0] = (uint8_t)(v >> 24);
+		p[1] = (uint8_t)(v >> 16);
+		p[2] = (uint8_t)(v >> 8);
+		p[3] = (uint8_t)v;
+	}
+
+	static inline uint32_t load_le32(const uint8_t* p)
+	{
+		return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+	}
+
+	static inline void store_le32(uint8_t* p, uint32_t v)
+	{
+		p[0] = (uint8_t)v;
+		p[1] = (uint8_t)(v >> 8);
+		p[2] = (uint8_t)(v >> 16);
+		p[3] = (uint8_t)(v >> 24);
+	}
+
+private:
+	inline Derived& derived() { return static_cast<Derived&>(*this); }
+
+private:
+	uint64_t m_total_size = 0;
+
+	uint8_t m_block[k_block_size];
+	size_t m_block_used = 0;
+};
+
+template<typename Derived, size_t DigestSize>
+inline void BlockHash<Derived, DigestSize>::update(const uint8_t* data, size_t size)
+{
+	m_total_size += size;
+
+	if (m_block_used)
+	{
+		size_t n = std::min(size, k_block_size - m_block_used);
+		std::memcpy(m_block + m_block_used, data, n);
+
+		m_block_used += n;
+		data += n;
+		size -= n;
+
+		if (m_block_used < k_block_size)
+			return;
+
+		derived().compress(m_block, 1);
+		m_block_used = 0;
+	}
+
+	size_t num_blocks = size / k_block_size;
+	if (num_blocks)
+		derived().compress(data, num_blocks);
+
+	m_block_used = size % k_block_size;
+	std::memcpy(m_block, data + num_blocks * k_block_size, m_block_used);
+}
+
+template<typename Derived, size_t DigestSize>
+inline typename BlockHash<Derived, DigestSize>::Digest_t BlockHash<Derived, DigestSize>::finish()
+{
+	uint64_t total_bits = m_total_size * 8;
+
+	// Terminating bit, zeros and the length in bits in the last 8 bytes
+	uint8_t padding[k_block_size * 2] = { 0x80 };
+	size_t padding_size = (m_block_used < 56 ? 56 : 120) - m_block_used;
+
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		if constexpr (Derived::k_big_endian)
+			padding[padding_size + i] = (uint8_t)(total_bits >> (56 - i * 8));
+		else
+			padding[padding_size + i] = (uint8_t)(total_bits >> (i * 8));
+	}
+
+	update(padding, padding_size + 8);
+
+	Digest_t digest;
+	derived().write_digest(digest.data());
+	return digest;
+}
+
+template<typename Derived, size_t DigestSize>
+inline std::string BlockHash<Derived, DigestSize>::digest_to_string(const Digest_t& digest)
+{
+	static constexpr char k_hex_digits[] = "0123456789abcdef";
+
+	std::string str(DigestSize * 2, '\0');
+	for (size_t i = 0; i < DigestSize; i++)
+	{
+		str[i * 2] = k_hex_digits[digest[i] >> 4];
+		str[i * 2 + 1] = k_hex_digits[digest[i] & 0xF];
+	}
+
+	return str;
+}
+
+// https://www.rfc-editor.org/rfc/rfc1321
+class Md5 : public BlockHash<Md5, 16>
+{
+private:
+	friend class BlockHash<Md5, 16>;
+
+	static inline constexpr bool k_big_endian = false;
+
+	void compress(const uint8_t* p, size_t num_blocks);
+	void write_digest(uint8_t* out) const;
+
+private:
+	// floor(abs(sin(i + 1)) * 2^32)
+	static inline constexpr uint32_t k_sines[64] =
+	{
+		0xD76AA478, 0xE8C7B756, 0x242070DB, 0xC1BDCEEE, 0xF57C0FAF, 0x4787C62A, 0xA8304613, 0xFD469501,
+		0x698098D8, 0x8B44F7AF, 0xFFFF5BB1, 0x895CD7BE, 0x6B901122, 0xFD987193, 0xA679438E, 0x49B40821,
+		0xF61E2562, 0xC040B340, 0x265E5A51, 0xE9B6C7AA, 0xD62F105D, 0x02441453, 0xD8A1E681, 0xE7D3FBC8,
+		0x21E1CDE6, 0xC33707D6, 0xF4D50D87, 0x455A14ED, 0xA9E3E905, 0xFCEFA3F8, 0x676F02D9, 0x8D2A4C8A,
+		0xFFFA3942, 0x8771F681, 0x6D9D6122, 0xFDE5380C, 0xA4BEEA44, 0x4BDECFA9, 0xF6BB4B60, 0xBEBFBC70,
+		0x289B7EC6, 0xEAA127FA, 0xD4EF3085, 0x04881D05, 0xD9D4D039, 0xE6DB99E5, 0x1FA27CF8, 0xC4AC5665,
+		0xF4292244, 0x432AFF97, 0xAB9423A7, 0xFC93A039, 0x655B59C3, 0x8F0CCC92, 0xFFEFF47D, 0x85845DD1,
+		0x6FA87E4F, 0xFE2CE6E0, 0xA3014314, 0x4E0811A1, 0xF7537E82, 0xBD3AF235, 0x2AD7D2BB, 0xEB86D391,
+	};
+
+	static inline constexpr uint32_t k_shifts[16] = { 7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21 };
+
+	uint32_t m_state[4] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476 };
+};
+
+inline void Md5::compress(const uint8_t* p, size_t num_blocks)
+{
+	for (size_t block = 0; block < num_blocks; block++, p += k_block_size)
+	{
+		uint32_t m[16];
+		for (uint32_t i = 0; i < 16; i++)
+			m[i] = load_le32(p + i * 4);
+
+		uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+
+		for (uint32_t i = 0; i < 64; i++)
+		{
+			uint32_t f, g;
+			switch (i / 16)
+			{
+				case 0:
+					f = (b & c) | (~b & d);
+					g = i;
+					break;
+
+				case 1:
+					f = (d & b) | (~d & c);
+					g = (5 * i + 1) % 16;
+					break;
+
+				case 2:
+					f = b ^ c ^ d;
+					g = (3 * i + 5) % 16;
+					break;
+
+				default:
+					f = c ^ (b | ~d);
+					g = (7 * i) % 16;
+					break;
+			}
+
+			uint32_t t = d;
+			d = c;
+			c = b;
+			b = b + std::rotl(a + f + k_sines[i] + m[g], k_shifts[(i / 16) * 4 + i % 4]);
+			a = t;
+		}
+
+		m_state[0] += a;
+		m_state[1] += b;
+		m_state[2] += c;
+		m_state[3] += d;
+	}
+}
+
+inline void Md5::write_digest(uint8_t* out) const
+{
+	for (uint32_t i = 0; i < 4; i++)
+		store_le32(out + i * 4, m_state[i]);
+}
+
+// https://csrc.nist.gov/publications/detail/fips/180/4/final
+class Sha1 : public BlockHash<Sha1, 20>
+{
+private:
+	friend class BlockHash<Sha1, 20>;
+
+	static inline constexpr bool k_big_endian = true;
+
+	void compress(const uint8_t* p, size_t num_blocks);
+	void write_digest(uint8_t* out) const;
+
+private:
+	uint32_t m_state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+};
+
+inline void Sha1::compress(const uint8_t* p, size_t num_blocks)
+{
+	for (size_t block = 0; block < num_blocks; block++, p += k_block_size)
+	{
+		uint32_t w[80];
+		for (uint32_t i = 0; i < 16; i++)
+			w[i] = load_be32(p + i * 4);
+
+		for (uint32_t i = 16; i < 80; i++)
+			w[i] = std::rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+		uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3], e = m_state[4];
+
+		for (uint32_t i = 0; i < 80; i++)
+		{
+			uint32_t f, k;
+			if (i < 20)
+			{
+				f = (b & c) | (~b & d);
+				k = 0x5A827999;
+			}
+			else if (i < 40)
+			{
+				f = b ^ c ^ d;
+				k = 0x6ED9EBA1;
+			}
+			else if (i < 60)
+			{
+				f = (b & c) | (b & d) | (c & d);
+				k = 0x8F1BBCDC;
+			}
+			else
+			{
+				f = b ^ c ^ d;
+				k = 0xCA62C1D6;
+			}
+
+			uint32_t t = std::rotl(a, 5) + f + e + k + w[i];
+			e = d;
+			d = c;
+			c = std::rotl(b, 30);
+			b = a;
+			a = t;
+		}
+
+		m_state[0] += a;
+		m_state[1] += b;
+		m_state[2] += c;
+		m_state[3] += d;
+		m_state[4] += e;
+	}
+}
+
+inline void Sha1::write_digest(uint8_t* out) const
+{
+	for (uint32_t i = 0; i < 5; i++)
+		store_be32(out + i * 4, m_state[i]);
+}
+
+// https://csrc.nist.gov/publications/detail/fips/180/4/final
+class Sha256 : public BlockHash<Sha256, 32>
+{
+private:
+	friend class BlockHash<Sha256, 32>;
+
+	static inline constexpr bool k_big_endian = true;
+
+	void compress(const uint8_t* p, size_t num_blocks);
+	void write_digest(uint8_t* out) const;
+
+private:
+	static inline constexpr uint32_t k_round_constants[64] =
+	{
+		0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+		0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+		0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+		0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+		0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+		0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+		0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+		0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+	};
+
+	uint32_t m_state[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+};
+
+inline void Sha256::compress(const uint8_t* p, size_t num_blocks)
+{
+	for (size_t block = 0; block < num_blocks; block++, p += k_block_size)
+	{
+		uint32_t w[64];
+		for (uint32_t i = 0; i < 16; i++)
+			w[i] = load_be32(p + i * 4);
+
+		for (uint32_t i = 16; i < 64; i++)
+		{
+			uint32_t s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			uint32_t s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+		uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+
+		for (uint32_t i = 0; i < 64; i++)
+		{
+			uint32_t s1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+			uint32_t ch = (e & f) ^ (~e & g);
+			uint32_t t1 = h + s1 + ch + k_round_constants[i] + w[i];
+			uint32_t s0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+			uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+			uint32_t t2 = s0 + maj;
+
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		m_state[0] += a;
+		m_state[1] += b;
+		m_state[2] += c;
+		m_state[3] += d;
+		m_state[4] += e;
+		m_state[5] += f;
+		m_state[6] += g;
+		m_state[7] += h;
+	}
+}
+
+inline void Sha256::write_digest(uint8_t* out) const
+{
+	for (uint32_t i = 0; i < 8; i++)
+		store_be32(out + i * 4, m_state[i]);
+}
+
+// XXH64, a non-cryptographic hash running at memory speed. Used to detect damaged parse
+// cache entries, where SHA-256 would cost as much as parsing itself.
+class Xxh64
+{
+public:
+	static uint64_t hash(const uint8_t* data, size_t size, uint64_t seed = 0);
+
+	static std::string to_string(uint64_t hash);
+
+private:
+	static inline constexpr uint64_t k_prime1 = 0x9E3779B185EBCA87ull;
+	static inline constexpr uint64_t k_prime2 = 0xC2B2AE3D27D4EB4Full;
+	static inline constexpr uint64_t k_prime3 = 0x165667B19E3779F9ull;
+	static inline constexpr uint64_t k_prime4 = 0x85EBCA77C2B2AE63ull;
+	static inline constexpr uint64_t k_prime5 = 0x27D4EB2F165667C5ull;
+
+	static inline uint64_t load_le64(const uint8_t* p)
+	{
+		uint64_t v = 0;
+		for (uint32_t i = 0; i < 8; i++)
+			v |= (uint64_t)p[i] << (i * 8);
+		return v;
+	}
+
+	static inline uint32_t load_le32(const uint8_t* p)
+	{
+		return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+	}
+
+	static inline uint64_t round(uint64_t acc, uint64_t input)
+	{
+		acc += input * k_prime2;
+		acc = std::rotl(acc, 31);
+		return acc * k_prime1;
+	}
+
+	static inline uint64_t merge_round(uint64_t acc, uint64_t val)
+	{
+		acc ^= round(0, val);
+		return acc * k_prime1 + k_prime4;
+	}
+};
+
+inline uint64_t Xxh64::hash(const uint8_t* data, size_t size, uint64_t seed)
+{
+	const uint8_t* p = data;
+	const uint8_t* end = data + size;
+
+	uint64_t h;
+
+	if (size >= 32)
+	{
+		// Four independent lanes over 32-byte stripes
+		uint64_t v1 = seed + k_prime1 + k_prime2;
+		uint64_t v2 = seed + k_prime2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - k_prime1;
+
+		for (; p + 32 <= end; p += 32)
+		{
+			v1 = round(v1, load_le64(p));
+			v2 = round(v2, load_le64(p + 8));
+			v3 = round(v3, load_le64(p + 16));
+			v4 = round(v4, load_le64(p + 24));
+		}
+
+		h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+		h = merge_round(h, v1);
+		h = merge_round(h, v2);
+		h = merge_round(h, v3);
+		h = merge_round(h, v4);
+	}
+	else
+	{
+		h = seed + k_prime5;
+	}
+
+	h += (uint64_t)size;
+
+	for (; p + 8 <= end; p += 8)
+	{
+		h ^= round(0, load_le64(p));
+		h = std::rotl(h, 27) * k_prime1 + k_prime4;
+	}
+
+	if (p + 4 <= end)
+	{
+		h ^= (uint64_t)load_le32(p) * k_prime1;
+		h = std::rotl(h, 23) * k_prime2 + k_prime3;
+		p += 4;
+	}
+
+	for (; p < end; p++)
+	{
+		h ^= (uint64_t)(*p) * k_prime5;
+		h = std::rotl(h, 11) * k_prime1;
+	}
+
+	// Avalanche
+	h ^= h >> 33;
+	h *= k_prime2;
+	h ^= h >> 29;
+	h *= k_prime3;
+	h ^= h >> 32;
+
+	return h;
+}
+
+inline std::string Xxh64::to_string(uint64_t hash)
+{
+	return std::format("{:016x}", hash);
+}
+
+// XXH128, the 128-bit variant of XXH3 with its default secret. Addresses the parse cache
+// by the contents of a file.
+class Xxh128
+{
+public:
+	struct Hash
+	{
+		uint64_t m_low = 0, m_high = 0;
+
+		bool operator==(const Hash&) const = default;
+	};
+
+	static Hash hash(const uint8_t* data, size_t size);
+
+	// Canonical form, high half first
+	static std::string to_string(const Hash& hash);
+
+private:
+	static inline constexpr uint32_t k_prime32_1 = 0x9E3779B1u;
+	static inline constexpr uint32_t k_prime32_2 = 0x85EBCA77u;
+	static inline constexpr uint32_t k_prime32_3 = 0xC2B2AE3Du;
+
+	static inline constexpr uint64_t k_prime64_1 = 0x9E3779B185EBCA87ull;
+	static inline constexpr uint64_t k_prime64_2 = 0xC2B2AE3D27D4EB4Full;
+	static inline constexpr uint64_t k_prime64_3 = 0x165667B19E3779F9ull;
+	static inline constexpr uint64_t k_prime64_4 = 0x85EBCA77C2B2AE63ull;
+	static inline constexpr uint64_t k_prime64_5 = 0x27D4EB2F165667C5ull;
+
+	static inline constexpr uint64_t k_prime_mx1 = 0x165667919E3779F9ull;
+	static inline constexpr uint64_t k_prime_mx2 = 0x9FB21C651E98DF25ull;
+
+	static inline constexpr size_t k_stripe_len = 64;
+	static inline constexpr size_t k_secret_consume_rate = 8;
+	static inline constexpr size_t k_midsize_max = 240;
+
+	// The default secret of XXH3
+	static inline constexpr uint8_t k_secret[192] =
+	{
+		0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+		0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+		0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+		0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+		0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+		0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+		0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+		0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+		0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+		0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+		0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+		0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+	};
+
+	static inline uint64_t load_le64(const uint8_t* p)
+	{
+		uint64_t v = 0;
+		for (uint32_t i = 0; i < 8; i++)
+			v |= (uint64_t)p[i] << (i * 8);
+		return v;
+	}
+
+	static inline uint32_t load_le32(const uint8_t* p)
+	{
+		return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+	}
+
+	// Full 64x64 bit product, built from 32-bit halves so that it works on every compiler
+	static inline Hash multiply(uint64_t a, uint64_t b)
+	{
+		uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+		uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+		uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+		uint64_t hi_hi = (a >> 32) * (b >> 32);
+
+		uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+		uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+		uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+
+		return { lower, upper };
+	}
+
+	static inline uint64_t multiply_fold(uint64_t a, uint64_t b)
+	{
+		Hash product = multiply(a, b);
+		return product.m_low ^ product.m_high;
+	}
+
+	static inline uint32_t swap32(uint32_t v)
+	{
+		return (v >> 24) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | (v << 24);
+	}
+
+	static inline uint64_t swap64(uint64_t v)
+	{
+		return ((uint64_t)swap32((uint32_t)v) << 32) | swap32((uint32_t)(v >> 32));
+	}
+
+	static inline uint64_t xorshift(uint64_t v, uint32_t shift)
+	{
+		return v ^ (v >> shift);
+	}
+
+	static inline uint64_t avalanche(uint64_t h)
+	{
+		h = xorshift(h, 37);
+		h *= k_prime_mx1;
+		return xorshift(h, 32);
+	}
+
+	static inline uint64_t xxh64_avalanche(uint64_t h)
+	{
+		h ^= h >> 33;
+		h *= k_prime64_2;
+		h ^= h >> 29;
+		h *= k_prime64_3;
+		h ^= h >> 32;
+		return h;
+	}
+
+	static inline uint64_t mix16(const uint8_t* p, const uint8_t* secret, uint64_t seed)
+	{
+		return multiply_fold(load_le64(p) ^ (load_le64(secret) + seed), load_le64(p + 8) ^ (load_le64(secret + 8) - seed));
+	}
+
+	static inline void mix32(Hash& acc, const uint8_t* p1, const uint8_t* p2, const uint8_t* secret, uint64_t seed)
+	{
+		acc.m_low += mix16(p1, secret, seed);
+		acc.m_low ^= load_le64(p2) + load_le64(p2 + 8);
+		acc.m_high += mix16(p2, secret + 16, seed);
+		acc.m_high ^= load_le64(p1) + load_le64(p1 + 8);
+	}
+
+	static Hash hash_0to16(const uint8_t* p, size_t size);
+	static Hash hash_17to240(const uint8_t* p, size_t size);
+	static Hash hash_long(const uint8_t* p, size_t size);
+
+	static void accumulate_stripe(uint64_t* acc, const uint8_t* p, const uint8_t* secret);
+	static void scramble(uint64_t* acc, const uint8_t* secret);
+	static uint64_t merge(const uint64_t* acc, const uint8_t* secret, uint64_t start);
+};
+
+inline Xxh128::Hash Xxh128::hash(const uint8_t* data, size_t size)
+{
+	if (size <= 16)
+		return hash_0to16(data, size);
+
+	if (size <= k_midsize_max)
+		return hash_17to240(data, size);
+
+	return hash_long(data, size);
+}
+
+inline Xxh128::Hash Xxh128::hash_0to16(const uint8_t* p, size_t size)
+{
+	if (size > 8)
+	{
+		uint64_t bitflip_low = load_le64(k_secret + 32) ^ load_le64(k_secret + 40);
+		uint64_t bitflip_high = load_le64(k_secret + 48) ^ load_le64(k_secret + 56);
+
+		uint64_t input_low = load_le64(p);
+		uint64_t input_high = load_le64(p + size - 8);
+
+		Hash m = multiply(input_low ^ input_high ^ bitflip_low, k_prime64_1);
+		m.m_low += (uint64_t)(size - 1) << 54;
+
+		input_high ^= bitflip_high;
+		m.m_high += input_high + (input_high & 0xFFFFFFFF) * (k_prime32_2 - 1);
+		m.m_low ^= swap64(m.m_high);
+
+		Hash h = multiply(m.m_low, k_prime64_2);
+		h.m_high += m.m_high * k_prime64_2;
+
+		return { avalanche(h.m_low), avalanche(h.m_high) };
+	}
+
+	if (size >= 4)
+	{
+		uint64_t input = load_le32(p) + ((uint64_t)load_le32(p + size - 4) << 32);
+		uint64_t bitflip = load_le64(k_secret + 16) ^ load_le64(k_secret + 24);
+
+		Hash m = multiply(input ^ bitflip, k_prime64_1 + (size << 2));
+		m.m_high += m.m_low << 1;
+		m.m_low ^= m.m_high >> 3;
+
+		m.m_low = xorshift(m.m_low, 35);
+		m.m_low *= k_prime_mx2;
+		m.m_low = xorshift(m.m_low, 28);
+		m.m_high = avalanche(m.m_high);
+
+		return m;
+	}
+
+	if (size)
+	{
+		uint32_t combined_low = ((uint32_t)p[0] << 16) | ((uint32_t)p[size >> 1] << 24) | (uint32_t)p[size - 1] | ((uint32_t)size << 8);
+		uint32_t combined_high = std::rotl(swap32(combined_low), 13);
+
+		uint64_t bitflip_low = load_le32(k_secret) ^ load_le32(k_secret + 4);
+		uint64_t bitflip_high = load_le32(k_secret + 8) ^ load_le32(k_secret + 12);
+
+		return { xxh64_avalanche(combined_low ^ bitflip_low), xxh64_avalanche(combined_high ^ bitflip_high) };
+	}
+
+	return
+	{
+		xxh64_avalanche(load_le64(k_secret + 64) ^ load_le64(k_secret + 72)),
+		xxh64_avalanche(load_le64(k_secret + 80) ^ load_le64(k_secret + 88))
+	};
+}
+
+inline Xxh128::Hash Xxh128::hash_17to240(const uint8_t* p, size_t size)
+{
+	Hash acc = { size * k_prime64_1, 0 };
+
+	if (size <= 128)
+	{
+		// Pairs of 16-byte blocks from both ends, meeting in the middle
+		if (size > 32)
+		{
+			if (size > 64)
+			{
+				if (size > 96)
+					mix32(acc, p + 48, p + size - 64, k_secret + 96, 0);
+
+				mix32(acc, p + 32, p + size - 48, k_secret + 64, 0);
+			}
+
+			mix32(acc, p + 16, p + size - 32, k_secret + 32, 0);
+		}
+
+		mix32(acc, p, p + size - 16, k_secret, 0);
+	}
+	else
+	{
+		size_t num_rounds = size / 32;
+
+		for (size_t i = 0; i < 4; i++)
+			mix32(acc, p + i * 32, p + i * 32 + 16, k_secret + i * 32, 0);
+
+		acc.m_low = avalanche(acc.m_low);
+		acc.m_high = avalanche(acc.m_high);
+
+		for (size_t i = 4; i < num_rounds; i++)
+			mix32(acc, p + i * 32, p + i * 32 + 16, k_secret + 3 + (i - 4) * 32, 0);
+
+		// The last 32 bytes
+		mix32(acc, p + size - 16, p + size - 32, k_secret + 136 - 17 - 16, 0);
+	}
+
+	uint64_t low = acc.m_low + acc.m_high;
+	uint64_t high = acc.m_low * k_prime64_1 + acc.m_high * k_prime64_4 + size * k_prime64_2;
+
+	return { avalanche(low), 0 - avalanche(high) };
+}
+
+inline void Xxh128::accumulate_stripe(uint64_t* acc, const uint8_t* p, const uint8_t* secret)
+{
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		uint64_t data = load_le64(p + i * 8);
+		uint64_t key = data ^ load_le64(secret + i * 8);
+
+		acc[i ^ 1] += data;
+		acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+	}
+}
+
+inline void Xxh128::scramble(uint64_t* acc, const uint8_t* secret)
+{
+	for (uint32_t i = 0; i < 8; i++)
+		acc[i] = (xorshift(acc[i], 47) ^ load_le64(secret + i * 8)) * k_prime32_1;
+}
+
+inline uint64_t Xxh128::merge(const uint64_t* acc, const uint8_t* secret, uint64_t start)
+{
+	uint64_t result = start;
+
+	for (uint32_t i = 0; i < 4; i++)
+		result += multiply_fold(acc[i * 2] ^ load_le64(secret + i * 16), acc[i * 2 + 1] ^ load_le64(secret + i * 16 + 8));
+
+	return avalanche(result);
+}
+
+inline Xxh128::Hash Xxh128::hash_long(const uint8_t* p, size_t size)
+{
+	uint64_t acc[8] =
+	{
+		k_prime32_3, k_prime64_1, k_prime64_2, k_prime64_3,
+		k_prime64_4, k_prime32_2, k_prime64_5, k_prime32_1,
+	};
+
+	// Every block walks over the whole secret, one stripe per 8 bytes of it
+	constexpr size_t num_stripes_per_block = (sizeof(k_secret) - k_stripe_len) / k_secret_consume_rate;
+	constexpr size_t block_len = k_stripe_len * num_stripes_per_block;
+
+	size_t num_blocks = (size - 1) / block_len;
+
+	for (size_t n = 0; n < num_blocks; n++)
+	{
+		for (size_t s = 0; s < num_stripes_per_block; s++)
+			accumulate_stripe(acc, p + n * block_len + s * k_stripe_len, k_secret + s * k_secret_consume_rate);
+
+		scramble(acc, k_secret + sizeof(k_secret) - k_stripe_len);
+	}
+
+	// Partial last block, then the last stripe, which may overlap with it
+	size_t num_stripes = ((size - 1) - block_len * num_blocks) / k_stripe_len;
+
+	for (size_t s = 0; s < num_stripes; s++)
+		accumulate_stripe(acc, p + num_blocks * block_len + s * k_stripe_len, k_secret + s * k_secret_consume_rate);
+
+	accumulate_stripe(acc, p + size - k_stripe_len, k_secret + sizeof(k_secret) - k_stripe_len - 7);
+
+	return
+	{
+		merge(acc, k_secret + 11, size * k_prime64_1),
+		merge(acc, k_secret + sizeof(k_secret) - k_stripe_len - 11, ~(size * k_prime64_2))
+	};
+}
+
+inline std::string Xxh128::to_string(const Hash& hash)
+{
+	return std::format("{:016x}{:016x}", hash.m_high, hash.m_low);
+}
+
+#endif
@@ -0,0 +1,226 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_UTIL_JSON_WRITER_H
+#define EXEIN_UTIL_JSON_WRITER_H
+
+#pragma once
+
+// Builds a single-line JSON object. Used for machine-readable records, where
+// one object per line is written for every processed file.
+class JsonLineWriter
+{
+public:
+	JsonLineWriter()
+	{
+		m_line.push_back('{');
+	}
+
+	inline JsonLineWriter& add(std::string_view key, std::string_view value)
+	{
+		add_key(key);
+		add_escaped(value);
+		return *this;
+	}
+
+	inline JsonLineWriter& add(std::string_view key, const char* value)
+	{
+		return add(key, std::string_view(value));
+	}
+
+	inline JsonLineWriter& add(std::string_view key, bool value)
+	{
+		add_key(key);
+		m_line.append(value ? "true" : "false");
+		return *this;
+	}
+
+	template<typename T> requires(std::is_integral<T>::value && !std::is_same<T, bool>::value)
+	inline JsonLineWriter& add(std::string_view key, T value)
+	{
+		add_key(key);
+		m_line.append(std::to_string(value));
+		return *this;
+	}
+
+	inline JsonLineWriter& add(std::string_view key, double value)
+	{
+		add_key(key);
+		m_line.append(std::format("{:.3f}", value));
+		return *this;
+	}
+
+	// Nested values, e.g. one object per section. Every begin_* has to be closed by
+	// the matching end_*, objects can only be begun inside of an array.
+	inline JsonLineWriter& begin_array(std::string_view key)
+	{
+		add_key(key);
+		m_line.push_back('[');
+		m_first = true;
+		return *this;
+	}
+
+	inline JsonLineWriter& end_array()
+	{
+		m_line.push_back(']');
+		m_first = false;
+		return *this;
+	}
+
+	inline JsonLineWriter& begin_object()
+	{
+		if (!m_first)
+			m_line.push_back(',');
+
+		m_line.push_back('{');
+		m_first = true;
+		return *this;
+	}
+
+	inline JsonLineWriter& end_object()
+	{
+		m_line.push_back('}');
+		m_first = false;
+		return *this;
+	}
+
+	// Closes the object and returns it, terminated by a newline.
+	inline std::string finish()
+	{
+		m_line.append("}\n");
+		return std::move(m_line);
+	}
+
+private:
+	inline void add_key(std::string_view key)
+	{
+		if (!m_first)
+			m_line.push_back(',');
+
+		m_first = false;
+
+		add_escaped(key);
+		m_line.push_back(':');
+	}
+
+	// Names and paths come straight out of the file, so they don't have to be valid UTF-8.
+	// Bytes that aren't part of a valid sequence are escaped one by one as \u00XX.
+	inline void add_escaped(std::string_view str)
+	{
+		m_line.push_back('"');
+
+		for (size_t i = 0; i < str.size(); i++)
+		{
+			char c = str[i];
+
+			if ((uint8_t)c >= 0x80)
+			{
+				size_t length = utf8_sequence_length(str.substr(i));
+
+				if (!length)
+				{
+					m_line.append(std::format("\\u{:04x}", (uint8_t)c));
+					continue;
+				}
+
+				m_line.append(str.substr(i, length));
+				i += length - 1;
+				continue;
+			}
+
+			switch (c)
+			{
+				case '"':  m_line.append("\\\""); break;
+				case '\\': m_line.append("\\\\"); break;
+				case '\n': m_line.append("\\n"); break;
+				case '\r': m_line.append("\\r"); break;
+				case '\t': m_line.append("\\t"); break;
+				default:
+				{
+					if ((uint8_t)c < ' ')
+						m_line.append(std::format("\\u{:04x}", (uint8_t)c));
+					else
+						m_line.push_back(c);
+					break;
+				}
+			}
+		}
+
+		m_line.push_back('"');
+	}
+
+	// Length of the multi-byte sequence at the start of str, 0 if it's malformed, overlong,
+	// encodes a surrogate or lies past U+10FFFF.
+	static inline size_t utf8_sequence_length(std::string_view str)
+	{
+		auto byte = [&](size_t i) { return (uint8_t)str[i]; };
+
+		uint8_t lead = byte(0);
+
+		size_t length;
+		uint8_t min_second = 0x80, max_second = 0xBF;
+
+		if (lead >= 0xC2 && lead <= 0xDF)
+			length = 2;
+		else if (lead >= 0xE0 && lead <= 0xEF)
+		{
+			length = 3;
+			if (lead == 0xE0)
+				min_second = 0xA0;
+			else if (lead == 0xED)
+				max_second = 0x9F;
+		}
+		else if (lead >= 0xF0 && lead <= 0xF4)
+		{
+			length = 4;
+			if (lead == 0xF0)
+				min_second = 0x90;
+			else if (lead == 0xF4)
+				max_second = 0x8F;
+		}
+		else
+			return 0;
+
+		if (str.size() < length || byte(1) < min_second || byte(1) > max_second)
+			return 0;
+
+		for (size_t i = 2; i < length; i++)
+		{
+			if ((byte(i) & 0xC0) != 0x80)
+				return 0;
+		}
+
+		return length;
+	}
+
+private:
+	std::string m_line;
+	bool m_first = true;
+};
+
+#endif
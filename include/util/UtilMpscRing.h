@@ -0,0 +1,126 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_UTIL_MPSC_RING_H
+#define EXEIN_UTIL_MPSC_RING_H
+
+#pragma once
+
+// Bounded lock-free queue for many producers and a single consumer. Every slot
+// carries a sequence number telling whenever it's free for the producer of the
+// given lap or filled for the consumer, so producers only contend on the head
+// index and never on each other's data.
+// 
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+template<typename T, size_t Capacity> requires(std::has_single_bit(Capacity))
+class MpscRing
+{
+public:
+	MpscRing() :
+		m_slots(std::make_unique<Slot[]>(Capacity))
+	{
+		for (size_t i = 0; i < Capacity; i++)
+			m_slots[i].m_seq.store(i, std::memory_order_relaxed);
+	}
+
+	MpscRing(const MpscRing&) = delete;
+	MpscRing& operator=(const MpscRing&) = delete;
+
+public:
+	// Can be called from any thread. Returns false if the queue is full.
+	inline bool try_push(T&& value)
+	{
+		size_t pos = m_head.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			auto& slot = m_slots[pos & k_mask];
+			size_t seq = slot.m_seq.load(std::memory_order_acquire);
+			auto diff = (intptr_t)seq - (intptr_t)pos;
+
+			if (diff == 0)
+			{
+				// The slot is free for this lap, claim it.
+				if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					slot.m_value = std::move(value);
+					slot.m_seq.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false; // The consumer hasn't freed this slot yet
+			}
+			else
+			{
+				pos = m_head.load(std::memory_order_relaxed); // Claimed by someone else
+			}
+		}
+	}
+
+	// Consumer thread only
+	inline bool try_pop(T& value)
+	{
+		auto& slot = m_slots[m_tail & k_mask];
+
+		if (slot.m_seq.load(std::memory_order_acquire) != m_tail + 1)
+			return false;
+
+		value = std::move(slot.m_value);
+		slot.m_seq.store(m_tail + Capacity, std::memory_order_release);
+		m_tail++;
+
+		return true;
+	}
+
+	// Consumer thread only
+	inline bool empty() const
+	{
+		return m_slots[m_tail & k_mask].m_seq.load(std::memory_order_acquire) != m_tail + 1;
+	}
+
+	static constexpr size_t capacity() { return Capacity; }
+
+private:
+	static constexpr size_t k_mask = Capacity - 1;
+
+	struct Slot
+	{
+		std::atomic<size_t> m_seq;
+		T m_value;
+	};
+
+	std::unique_ptr<Slot[]> m_slots;
+
+	// Kept on separate cache lines, producers hammer the head.
+	alignas(64) std::atomic<size_t> m_head = 0;
+	alignas(64) size_t m_tail = 0;
+};
+
+#endif
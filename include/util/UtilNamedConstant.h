@@ -56,58 +56,37 @@ private:
 	std::pair<T, std::string> m_named_constant;
 };
 
-// Used with values that are used to store flags as individual bits. Allows to
-// add a simple description to each bit when constructing.
-template<typename T> requires(sizeof(T) <= sizeof(uint64_t))
+// Description of a single flag inside of a NamedBitfieldConstant table. Flags without
+// a name are described as reserved.
+template<typename T>
+struct NamedBit
+{
+	T m_flag;
+	const char* m_name;
+};
+
+// Used with values that are used to store flags as individual bits. The descriptions
+// come from a static table of NamedBits shared by every instance, so that only the
+// value itself is stored. Descriptions are resolved only when asked for.
+template<typename T, const auto& k_named_bits> requires(sizeof(T) <= sizeof(uint64_t))
 class NamedBitfieldConstant
 {
 public:
-	// Initialize the bit field and string vector with values. Each bit has to 
-	// have a string associated to it!
-	NamedBitfieldConstant(T value, const std::vector<std::pair<T, std::string>>&& v_strings)
+	constexpr NamedBitfieldConstant(T value) :
+		m_value(value)
 	{
-		if (v_strings.size() > get_size_bits())
-		{
-			CDebugConsole::get().output_error("FATAL ERROR! Invalid arguments passed to " __FUNCTION__ "!");
-			return;
-		}
-
-		// Set all bits individually depending on the value passed
-		for (uint32_t i = 0; i < get_size_bits(); i++)
-		{
-			m_bit_field.set(i, value & (1 << i));
-
-			// Search if we have a description for this bit
-			const auto& iter = std::find_if(v_strings.begin(), v_strings.end(), [&](const std::pair<T, std::string>& pair)
-				{
-					const auto& [key, string] = pair;
-					return key == (1 << i) && !string.empty();
-				});
-
-			// If we have, apply that description. Otherwise, apply the default one.
-			if (iter != v_strings.end())
-			{
-				const auto& [key, string] = *iter;
-				m_vec_strings.emplace_back(string);
-			}
-			else
-			{
-				m_vec_strings.emplace_back(i != 0 ? std::format("Reserved 0x{:X}", (uint32_t)(1 << i)) : "Null");
-			}
-		}
 	}
 
-	NamedBitfieldConstant() :
-		m_bit_field(0),
-		m_vec_strings({})
+	constexpr NamedBitfieldConstant() :
+		m_value(0)
 	{
 	}
 
 public:
 	// Returns true if #th bit is present
-	inline bool is_bit_present(uint32_t bit) const
+	inline constexpr bool is_bit_present(uint32_t bit) const
 	{
-		return (m_bit_field.test(bit) == 1) ? true : false;
+		return bit < get_size_bits() && ((m_value >> bit) & 1) != 0;
 	}
 
 	// Returns true if all bits inside this radius are present
@@ -115,7 +94,7 @@ public:
 	{
 		if (lo > get_size_bits() || hi > get_size_bits())
 		{
-			CDebugConsole::get().output_error(std::format(__FUNCTION__ ": Bad parameters (lo={}, hi={})", lo, hi));
+			CDebugConsole::get().output_error("{}: Bad parameters (lo={}, hi={})", __FUNCTION__, lo, hi);
 			return false;
 		}
 
@@ -133,7 +112,7 @@ public:
 	{
 		if (lo > get_size_bits() || hi > get_size_bits())
 		{
-			CDebugConsole::get().output_error(std::format(__FUNCTION__ ": Bad parameters (lo={}, hi={})", lo, hi));
+			CDebugConsole::get().output_error("{}: Bad parameters (lo={}, hi={})", __FUNCTION__, lo, hi);
 			return false;
 		}
 
@@ -150,35 +129,22 @@ public:
 	static inline constexpr T get_size_bytes() { return sizeof(T); }
 	static inline constexpr T get_size_bits() { return get_size_bytes() * 8; }
 
-	inline const auto& get_string_vec() const { return m_vec_strings; }
-
 	// Returns raw value containing all bits
-	inline T get_val() const
-	{
-		T ret = 0;
-
-		if constexpr (get_size_bytes() <= sizeof(uint32_t))
-			return ret |= static_cast<T>(m_bit_field.to_ulong());
-		else if constexpr (get_size_bytes() >= sizeof(uint32_t))
-			return ret |= static_cast<T>(m_bit_field.to_ullong());
-
-		// This theoretically shouldn't ever happen
-		static_assert("Bad type size");
-		return 0;
-	}
+	inline constexpr T get_val() const { return m_value; }
 
 	// Returns the string associated to specified bit
-	inline const std::string& get_string_at(T idx) const
+	inline std::string get_string_at(T idx) const
 	{
-		try
-		{
-			return m_vec_strings.at(idx);
-		}
-		catch (...)
+		if (idx >= get_size_bits())
 		{
-			CDebugConsole::get().output_error(std::format("Tried to get string with invalid index: {}", idx));
-			return m_vec_strings.at(0);
+			CDebugConsole::get().output_error("Tried to get string with invalid index: {}", idx);
+			return "Null";
 		}
+
+		if (k_bit_names[idx])
+			return k_bit_names[idx];
+
+		return std::format("Reserved 0x{:X}", (uint64_t)1 << idx);
 	}
 
 	// Returns an contiunous string containging strings of all set only bits.
@@ -186,28 +152,40 @@ public:
 	{
 		std::string ret;
 
-		for (uint32_t i = 1; i < m_vec_strings.size(); i++)
+		for (uint32_t i = 0; i < get_size_bits(); i++)
 		{
 			if (!is_bit_present(i))
 				continue;
 
-			ret += m_vec_strings[i] + separator;
-		}
+			if (!ret.empty())
+				ret += separator;
 
-		if (!ret.empty())
-		{
-			for (uint32_t i = 0; i < separator.length(); i++)
-				ret.pop_back();
+			ret += get_string_at(i);
 		}
 
 		return ret;
 	}
 
 private:
-	std::bitset<get_size_bits()> m_bit_field;
+	// Name of each bit, ranging from bit 0 to sizeof(T). Looked up in the table at
+	// compile time, nullptr for bits that aren't described.
+	static constexpr auto k_bit_names = []()
+	{
+		std::array<const char*, sizeof(T) * 8> names = {};
+
+		for (const auto& [flag, name] : k_named_bits)
+		{
+			for (uint32_t i = 0; i < names.size(); i++)
+			{
+				if (flag == ((T)1 << i) && name && *name && !names[i])
+					names[i] = name;
+			}
+		}
+
+		return names;
+	}();
 
-	// Each string is for individual bits. Ranging from bit 0 to sizeof(T).
-	std::vector<std::string> m_vec_strings;
+	T m_value;
 };
 
 #endif
\ No newline at end of file
@@ -31,15 +31,48 @@
 
 #pragma once
 
+//
+// Formatting policies
+//
+//	Decide how a smart value turns into a std::string. They're picked at compile time,
+//	so a smart value doesn't have to carry anything but the value itself.
+//
+
+struct SmartDecFormat
+{
+	template<typename T>
+	static inline std::string to_string(T value) { return value ? std::to_string(value) : "null"; }
+};
+
+struct SmartHexFormat
+{
+	template<typename T>
+	static inline std::string to_string(T value) { return value ? std::format("0x{:0>{}X}", value, sizeof(T) * 2) : "null"; }
+};
+
+// Addresses that are 64-bit wide only because PE32+ images need them to be. Printed with
+// 8 digits unless they don't fit, so that PE32 addresses look the same as they always did.
+struct SmartAddrFormat
+{
+	template<typename T>
+	static inline std::string to_string(T value) { return value ? std::format("0x{:0>{}X}", value, value > 0xFFFFFFFF ? 16 : 8) : "null"; }
+};
+
+struct SmartBinFormat
+{
+	template<typename T>
+	static inline std::string to_string(T value) { return value ? std::format("0b{:b}", value) : "null"; }
+};
+
 //
 // Smart value declaration
 //
 //	Wrapper around type T that contains helper methods while 
 //	sizeof(SmartValue<T>) == sizeof(T).
 //
-//	Note: Don't use this raw class, use pre-defined classes below.
+//	Note: Don't use this raw class, use pre-defined aliases below.
 //
-template<typename T> requires(std::is_integral<T>::value)
+template<typename T, typename Format = SmartDecFormat> requires(std::is_integral<T>::value)
 class SmartValue
 {
 public:
@@ -51,12 +84,11 @@ public:
 	{}
 
 public:
-	// These operators has to be overrided by the class that derives this.
-	virtual inline constexpr operator T() const { return m_value; };
-	virtual inline constexpr bool operator=(T val) { return m_value = val; };
+	inline constexpr operator T() const { return m_value; };
+	inline constexpr bool operator=(T val) { return m_value = val; };
 
-	// Returns a string depending on the overrided as_string() function.
-	inline constexpr operator std::string() const { return as_string(); }
+	// Returns a string formatted by the formatting policy.
+	inline operator std::string() const { return as_string(); }
 
 public:
 	inline constexpr T val() const { return m_value; }
@@ -81,78 +113,23 @@ public:
 	inline constexpr bool is_power_of_two() const { return m_value != 0 && !(m_value & (m_value - 1)); }
 
 public:
-	// Override this function to output custom-formatted values in a form of std::string
-	// when this object is implicitly casted into std::string.
-	virtual std::string as_string() const { return m_value ? std::to_string(m_value) : "null"; }
+	inline std::string as_string() const { return Format::to_string(m_value); }
 
 protected:
 	T m_value;
 };
 
 //
-// Hexadecimal smart value declaration
-//
-
-template<typename T> requires(std::is_integral<T>::value)
-class SmartHexValue : public SmartValue<T>
-{
-private:
-	using SmartValue<T>::m_value;
-
-public:
-	// These has to be declared in order for the compiler to figure stuff out.
-	constexpr SmartHexValue(T val) : SmartValue<T>(val) {}
-	constexpr SmartHexValue() : SmartValue<T>() {}
-
-	inline constexpr operator T() const override { return m_value; }
-	inline constexpr bool operator=(T val) { return m_value = val; }
-
-public:
-	inline std::string as_string() const override { return m_value ? std::format("0x{:0>{}X}", m_value, sizeof(T) * 2) : "null"; }
-};
-
-//
-// Decimal smart value declaration
-//
-
-template<typename T> requires(std::is_integral<T>::value)
-class SmartDecValue : public SmartValue<T>
-{
-private:
-	using SmartValue<T>::m_value;
-
-public:
-	// These has to be declared in order for the compiler to figure stuff out.
-	constexpr SmartDecValue(T val) : SmartValue<T>(val) {}
-	constexpr SmartDecValue() : SmartValue<T>() {}
-
-	inline constexpr operator T() const override { return m_value; }
-	inline constexpr bool operator=(T val) { return m_value = val; }
-
-public:
-	inline std::string as_string() const override { return m_value ? std::to_string(m_value) : "null"; }
-};
-
-//
-// Binary smart value declaration
+// Pre-defined smart values
 //
 
-template<typename T> requires(std::is_integral<T>::value)
-class SmartBinValue : public SmartValue<T>
-{
-private:
-	using SmartValue<T>::m_value;
+template<typename T> using SmartHexValue = SmartValue<T, SmartHexFormat>;
+template<typename T> using SmartDecValue = SmartValue<T, SmartDecFormat>;
+template<typename T> using SmartBinValue = SmartValue<T, SmartBinFormat>;
+template<typename T> using SmartAddrValue = SmartValue<T, SmartAddrFormat>;
 
-public:
-	// These has to be declared in order for the compiler to figure stuff out.
-	constexpr SmartBinValue(T val) : SmartValue<T>(val) {}
-	constexpr SmartBinValue() : SmartValue<T>() {}
-
-	inline constexpr operator T() const override { return m_value; }
-	inline constexpr bool operator=(T val) { return m_value = val; }
-
-public:
-	inline std::string as_string() const override { return m_value ? std::format("0b{:b}", m_value) : "null"; }
-};
+static_assert(sizeof(SmartHexValue<uint16_t>) == sizeof(uint16_t));
+static_assert(sizeof(SmartDecValue<uint32_t>) == sizeof(uint32_t));
+static_assert(std::is_trivially_copyable_v<SmartBinValue<uint64_t>>);
 
 #endif
\ No newline at end of file
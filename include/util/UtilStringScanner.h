@@ -0,0 +1,214 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_STRING_SCANNER_H
+#define EXEIN_STRING_SCANNER_H
+
+#pragma once
+
+// Finds runs of printable ASCII characters (' ' to '~') inside of a byte region.
+// Bytes are classified 64 at a time into a bitmask (using AVX2 or SSE2 when
+// available) and the runs are then located by scanning the mask transitions,
+// so no work is done per character once the mask is built.
+class PrintableRunScanner
+{
+public:
+	// Reports every run that starts inside of [chunk_begin, chunk_end) and is longer than
+	// min_length as on_run(offset, length), offsets being relative to the region. A run
+	// that crosses chunk_end is followed until it ends inside of the region and a run
+	// that started before chunk_begin is skipped, so that a region can be split into
+	// chunks scanned independently without losing or duplicating any run.
+	template<typename F>
+	static void scan(const uint8_t* region, size_t region_size, size_t chunk_begin, size_t chunk_end,
+					 size_t min_length, F&& on_run);
+
+	static inline bool is_printable(uint8_t c) { return c >= ' ' && c <= '~'; }
+
+private:
+	using ClassifyFn_t = uint64_t(*)(const uint8_t* p);
+
+	// Returns bitmask where n-th bit is set if p[n] is printable. Reads 64 bytes.
+	static uint64_t classify_64_scalar(const uint8_t* p);
+#ifdef EXEIN_X86_SIMD
+	static uint64_t classify_64_sse2(const uint8_t* p);
+	EXEIN_TARGET_AVX2 static uint64_t classify_64_avx2(const uint8_t* p);
+#endif
+
+	// Same as above but for the last, partial block. Bits past n are zero.
+	static uint64_t classify_tail(const uint8_t* p, size_t n);
+
+	// Picks the fastest kernel supported by this cpu
+	static ClassifyFn_t select_classify_64();
+};
+
+inline uint64_t PrintableRunScanner::classify_64_scalar(const uint8_t* p)
+{
+	uint64_t mask = 0;
+
+	for (uint32_t i = 0; i < 64; i++)
+		mask |= (uint64_t)is_printable(p[i]) << i;
+
+	return mask;
+}
+
+#ifdef EXEIN_X86_SIMD
+// A byte is printable if c - 0x20 < 0x5F when compared unsigned. SSE has only signed
+// byte compares, so we bias the value by 0x80 to get the same result: c + 0x60 < -33.
+
+inline uint64_t PrintableRunScanner::classify_64_sse2(const uint8_t* p)
+{
+	const __m128i bias = _mm_set1_epi8(0x60);
+	const __m128i limit = _mm_set1_epi8(-33);
+
+	uint64_t mask = 0;
+
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+		__m128i printable = _mm_cmplt_epi8(_mm_add_epi8(bytes, bias), limit);
+
+		mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(printable) << (i * 16);
+	}
+
+	return mask;
+}
+
+EXEIN_TARGET_AVX2 inline uint64_t PrintableRunScanner::classify_64_avx2(const uint8_t* p)
+{
+	const __m256i bias = _mm256_set1_epi8(0x60);
+	const __m256i limit = _mm256_set1_epi8(-33);
+
+	__m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	__m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+
+	// a > b is the same as b < a
+	__m256i printable_lo = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(lo, bias));
+	__m256i printable_hi = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(hi, bias));
+
+	return (uint64_t)(uint32_t)_mm256_movemask_epi8(printable_lo) |
+		((uint64_t)(uint32_t)_mm256_movemask_epi8(printable_hi) << 32);
+}
+#endif
+
+inline uint64_t PrintableRunScanner::classify_tail(const uint8_t* p, size_t n)
+{
+	uint64_t mask = 0;
+
+	for (size_t i = 0; i < n; i++)
+		mask |= (uint64_t)is_printable(p[i]) << i;
+
+	return mask;
+}
+
+inline PrintableRunScanner::ClassifyFn_t PrintableRunScanner::select_classify_64()
+{
+#ifdef EXEIN_X86_SIMD
+	if (CpuFeatures::get().has_avx2())
+		return &classify_64_avx2;
+
+	if (CpuFeatures::get().has_sse2())
+		return &classify_64_sse2;
+#endif
+
+	return &classify_64_scalar;
+}
+
+template<typename F>
+inline void PrintableRunScanner::scan(const uint8_t* region, size_t region_size, size_t chunk_begin, size_t chunk_end,
+									  size_t min_length, F&& on_run)
+{
+	static const ClassifyFn_t classify_64 = select_classify_64();
+
+	if (chunk_end > region_size)
+		chunk_end = region_size;
+
+	if (chunk_begin >= chunk_end)
+		return;
+
+	// A run that is already going on at the start of the chunk belongs to the previous one.
+	bool in_run = chunk_begin > 0 && is_printable(region[chunk_begin - 1]);
+	bool foreign_run = in_run;
+	size_t run_start = chunk_begin;
+
+	const auto end_run = [&](size_t run_end)
+	{
+		if (!foreign_run && run_end - run_start > min_length)
+			on_run(run_start, run_end - run_start);
+
+		in_run = foreign_run = false;
+	};
+
+	size_t pos = chunk_begin;
+	while (pos < region_size)
+	{
+		// We're done once there's no run left to finish and the next one would start
+		// in the following chunk.
+		if (!in_run && pos >= chunk_end)
+			return;
+
+		size_t n = std::min<size_t>(64, region_size - pos);
+		uint64_t mask = (n == 64) ? classify_64(region + pos) : classify_tail(region + pos, n);
+
+		// Walk the transitions between printable and non-printable bytes
+		uint32_t bit = 0;
+		while (bit < n)
+		{
+			if (in_run)
+			{
+				uint64_t rest = ~mask >> bit;
+				if (!rest)
+					break; // The run goes on into the next block
+
+				bit += std::countr_zero(rest);
+				end_run(pos + bit);
+			}
+			else
+			{
+				uint64_t rest = mask >> bit;
+				if (!rest)
+					break; // No more runs inside of this block
+
+				bit += std::countr_zero(rest);
+				run_start = pos + bit;
+
+				if (run_start >= chunk_end)
+					return;
+
+				in_run = true;
+			}
+		}
+
+		pos += n;
+	}
+
+	// The run lasts until the very end of the region
+	if (in_run)
+		end_run(region_size);
+}
+
+#endif
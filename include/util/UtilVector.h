@@ -396,7 +396,7 @@ public:
 	// 
 	//-----------------------------------------------------------------------------
 
-	constexpr inline auto& operator[](int i) const noexcept
+	inline auto& operator[](int i) const noexcept
 	{
 		if (i >= 0 && i < 2)
 			return ((float*)this)[i];
@@ -34,7 +34,18 @@ bool CApplication::run()
 	if (!CDebugConsole::get().create(con_size))
 		return false;
 
-	CDebugConsole::get().output_message(std::format("Created console with {} line limit", con_size));
+	CDebugConsole::get().output_message("Created console with {} line limit", con_size);
+
+	if (!CThreadPool::get().create())
+		return false;
+
+	// Files that have been opened before aren't parsed again. Not being able to cache
+	// isn't a reason to not start at all.
+	std::error_code ec;
+	auto temp_directory = std::filesystem::temp_directory_path(ec);
+
+	if (!ec)
+		CParseCache::get().set_directory(temp_directory / "x86executable_inspector" / "parse_cache");
 
 	if (!invoke_window())
 	{
@@ -50,10 +61,15 @@ bool CApplication::run()
 
 	while (on_frame()) { }
 
+	// Processing may still be running on the thread pool
+	close_active_processor();
+
 	CGUI::get().shutdown();
 
 	destroy_window();
 
+	CThreadPool::get().destroy();
+
 	CDebugConsole::get().destroy();
 
 	return true;
@@ -62,6 +78,7 @@ bool CApplication::run()
 void CApplication::halt()
 {
 	CDebugConsole::get().output_message("Press any key to continue...");
+	CDebugConsole::get().flush();
 	std::cin.get();
 }
 
@@ -128,7 +145,7 @@ bool CApplication::invoke_window()
 		return false;
 	}
 
-	CDebugConsole::get().output_message(std::format("Created window [{}: {:d}x{:d}]", m_app_title, m_app_width, m_app_height));
+	CDebugConsole::get().output_message("Created window [{}: {:d}x{:d}]", m_app_title, m_app_width, m_app_height);
 
 	// Pair context to current thread
 	glfwMakeContextCurrent(m_glfw_window);
@@ -192,13 +209,17 @@ void CApplication::create_new_active_processor(const std::filesystem::path& file
 	close_active_processor();
 
 	m_active_processor = new CX86PEProcessor;
-	if (!m_active_processor->process(filepath))
-	{
-		CDebugConsole::get().output_error(std::format("Failed to process \"{}\"", filepath.string()));
+	m_active_file = filepath;
 
-		close_active_processor();
-		m_failed_to_open_file = true;
-	}
+	m_processing_finished = false;
+	m_processing_succeeded = false;
+
+	m_processing_thread = std::thread(
+		[this, processor = m_active_processor, filepath]()
+		{
+			m_processing_succeeded = processor->process(filepath);
+			m_processing_finished.store(true, std::memory_order_release);
+		});
 }
 
 void CApplication::close_active_processor()
@@ -206,8 +227,60 @@ void CApplication::close_active_processor()
 	if (!m_active_processor)
 		return;
 
+	// Can't free the processor from under the processing thread
+	if (m_processing_thread.joinable())
+	{
+		m_active_processor->request_cancel();
+		m_processing_thread.join();
+	}
+
 	delete m_active_processor;
 	m_active_processor = nullptr;
+
+	m_active_file.clear();
+}
+
+void CApplication::poll_active_processor()
+{
+	if (!m_processing_thread.joinable() || !m_processing_finished.load(std::memory_order_acquire))
+		return;
+
+	m_processing_thread.join();
+
+	if (m_processing_succeeded)
+		return;
+
+	// Cancelled on purpose, nothing to report
+	if (m_active_processor->is_cancel_requested())
+	{
+		close_active_processor();
+		return;
+	}
+
+	CDebugConsole::get().output_error("Failed to process \"{}\"", m_active_file.string());
+
+	close_active_processor();
+	m_failed_to_open_file = true;
+}
+
+void CApplication::render_processing_progress()
+{
+	auto progress = m_active_processor->get_progress();
+
+	// Afterwards only the parts decoded on demand are tracked, these aren't cancelled
+	if (!is_processing())
+	{
+		ImGui::ProgressBar(progress, { -1.f, 0.f }, std::format("{} ({:.0f}%)", m_active_processor->get_progress_stage(), progress * 100.f).c_str());
+		return;
+	}
+
+	ImGui::ProgressBar(progress, { -100.f, 0.f }, std::format("{} ({:.0f}%)", m_active_processor->get_progress_stage(), progress * 100.f).c_str());
+
+	ImGui::SameLine();
+
+	// The processor stops at the nearest stage or chunk boundary
+	if (ImGui::Button(m_active_processor->is_cancel_requested() ? "Cancelling..." : "Cancel", { -1.f, 0.f }))
+		m_active_processor->request_cancel();
 }
 
 bool CApplication::is_alive()
@@ -217,7 +290,7 @@ bool CApplication::is_alive()
 
 void CApplication::render_ui_contents()
 {
-	std::thread processing_thread;
+	poll_active_processor();
 
 	if (ImGui::BeginMenuBar())
 	{
@@ -273,11 +346,11 @@ void CApplication::render_ui_contents()
 			});
 	}
 
-	if (processing_thread.joinable())
-		processing_thread.join();
-
 	if (is_processor_active())
 	{
+		if (is_processing() || m_active_processor->is_progress_pending())
+			render_processing_progress();
+
 		m_active_processor->render_gui();
 	}
 	else
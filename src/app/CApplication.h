@@ -76,9 +76,16 @@ private:
 
 	void compute_avg_fps();
 
+	// Processing runs on a background thread, the GUI keeps rendering whatever
+	// is ready in the meantime.
 	void create_new_active_processor(const std::filesystem::path& filepath);
 	void close_active_processor();
 
+	// Picks up the result once the background processing has finished
+	void poll_active_processor();
+
+	void render_processing_progress();
+
 	// Return false if the application has to be closed
 	bool is_alive();
 
@@ -86,8 +93,10 @@ private:
 
 	inline bool is_processor_active() const { return m_active_processor != nullptr; }
 
+	inline bool is_processing() const { return m_processing_thread.joinable(); }
+
 	// Always call is_processor_active before this one!
-	inline const auto& get_input_file() const { return m_active_processor->get_input_file(); }
+	inline const auto& get_input_file() const { return m_active_file; }
 
 private:
 	std::string m_app_title;
@@ -99,7 +108,14 @@ private:
 	std::chrono::high_resolution_clock::time_point frame_start, frame_end;
 	double m_avg_fps = 1.0; // Uses moving-average algorithm
 
-	IBaseProcessor* m_active_processor;
+	IBaseProcessor* m_active_processor = nullptr;
+
+	// The processor owns its copy of the path only once processing starts
+	std::filesystem::path m_active_file;
+
+	std::thread m_processing_thread;
+	std::atomic<bool> m_processing_finished = false;
+	bool m_processing_succeeded = false; // Written by the processing thread before it finishes
 
 	bool m_failed_to_open_file = false;
 };
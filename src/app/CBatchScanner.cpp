@@ -0,0 +1,298 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#include "exein_pch.h"
+
+int CBatchScanner::run(int argc, char** argv)
+{
+	if (!parse_args(argc, argv))
+	{
+		print_usage();
+		return 1;
+	}
+
+	// Per-file messages would drown everything else, only errors are printed by default.
+	// Everything below the level isn't even formatted.
+	if (!CDebugConsole::get().create_headless(m_verbose ? LogLevel::Verbose : LogLevel::Error))
+		return 1;
+
+	for (const auto& input : m_inputs)
+	{
+		if (input.starts_with('@'))
+		{
+			if (!collect_input_list(input.substr(1)))
+				return 1;
+		}
+		else
+		{
+			collect_input(input);
+		}
+	}
+
+	if (m_files.empty())
+	{
+		CDebugConsole::get().output_error("No files to scan.");
+		return 1;
+	}
+
+	if (!m_output_file.empty())
+	{
+		m_output_stream.open(m_output_file, std::ios_base::out | std::ios_base::trunc);
+
+		if (!m_output_stream.is_open())
+		{
+			CDebugConsole::get().output_error("Couldn't open {} for writing.", m_output_file.string());
+			return 1;
+		}
+
+		m_output = &m_output_stream;
+	}
+
+	if (!CParseCache::get().set_directory(m_cache_directory))
+		return 1;
+
+	uint32_t num_jobs = m_num_jobs ? m_num_jobs : std::max(std::thread::hardware_concurrency(), 1u);
+
+	if (!CThreadPool::get().create(num_jobs))
+		return 1;
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// Only num_jobs files are in flight at once, so that the amount of mapped
+	// files and parsed images in memory doesn't grow with the size of the input.
+	std::counting_semaphore<> free_slots(num_jobs);
+
+	CTaskGroup scan_group;
+	for (const auto& file : m_files)
+	{
+		free_slots.acquire();
+
+		CThreadPool::get().submit(scan_group,
+								  [&]()
+								  {
+									  scan_file(file);
+									  free_slots.release();
+								  });
+	}
+
+	CThreadPool::get().wait(scan_group);
+
+	double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	CThreadPool::get().destroy();
+
+	m_output->flush();
+
+	uint64_t num_files = m_files.size();
+	uint64_t total_bytes = m_total_bytes;
+
+	CDebugConsole::get().set_min_level(LogLevel::Message);
+	CDebugConsole::get().output_message<LogCategory::Batch>("Scanned {} files ({} failed, {}) in {:.3f} seconds using {} workers.",
+										num_files, m_num_failed.load(), CUtil::make_filesize_nice(total_bytes), elapsed, num_jobs);
+	CDebugConsole::get().output_message<LogCategory::Batch>("Throughput: {:.1f} files/s, {:.1f} MiB/s",
+										num_files / elapsed, total_bytes / elapsed / (1024.0 * 1024.0));
+
+	if (CParseCache::get().is_enabled())
+	{
+		CDebugConsole::get().output_message<LogCategory::Batch>("Parse cache: {} hits, {} misses",
+											CParseCache::get().get_num_hits(), CParseCache::get().get_num_misses());
+	}
+
+	CDebugConsole::get().destroy();
+
+	return m_num_failed == num_files ? 1 : 0;
+}
+
+bool CBatchScanner::parse_args(int argc, char** argv)
+{
+	for (int i = 0; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+
+		if (arg == "-j" || arg == "--jobs")
+		{
+			if (++i >= argc)
+				return false;
+
+			m_num_jobs = std::strtoul(argv[i], nullptr, 10);
+		}
+		else if (arg == "-o" || arg == "--output")
+		{
+			if (++i >= argc)
+				return false;
+
+			m_output_file = argv[i];
+		}
+		else if (arg == "-c" || arg == "--cache")
+		{
+			if (++i >= argc)
+				return false;
+
+			m_cache_directory = argv[i];
+		}
+		else if (arg == "--headers-only")
+		{
+			m_headers_only = true;
+		}
+		else if (arg == "-v" || arg == "--verbose")
+		{
+			m_verbose = true;
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			return false;
+		}
+		else
+		{
+			m_inputs.emplace_back(argv[i]);
+		}
+	}
+
+	return !m_inputs.empty();
+}
+
+void CBatchScanner::print_usage()
+{
+	std::cerr << "usage: x86executable_inspector --scan [options] <file|directory|@list>...\n"
+				 "\n"
+				 "  -j, --jobs <n>       number of workers (default: one per hardware thread)\n"
+				 "  -o, --output <file>  write records into a file instead of stdout\n"
+				 "  -c, --cache <dir>    keep parsed files in a cache, files seen before aren't parsed again\n"
+				 "      --headers-only   parse only the headers and sections, skip the data directories, strings and hashes\n"
+				 "  -v, --verbose        print all of the parser messages to stderr\n";
+}
+
+void CBatchScanner::collect_input(const std::filesystem::path& path)
+{
+	std::error_code ec;
+
+	if (std::filesystem::is_directory(path, ec))
+	{
+		auto options = std::filesystem::directory_options::skip_permission_denied;
+
+		for (auto iter = std::filesystem::recursive_directory_iterator(path, options, ec);
+			 iter != std::filesystem::recursive_directory_iterator();
+			 iter.increment(ec))
+		{
+			if (ec)
+			{
+				CDebugConsole::get().output_error("Error while walking {}: {}", path.string(), ec.message());
+				break;
+			}
+
+			if (iter->is_regular_file(ec))
+				m_files.push_back(iter->path());
+		}
+	}
+	else if (std::filesystem::is_regular_file(path, ec))
+	{
+		m_files.push_back(path);
+	}
+	else
+	{
+		CDebugConsole::get().output_error("{} isn't a file nor a directory.", path.string());
+	}
+}
+
+bool CBatchScanner::collect_input_list(const std::filesystem::path& list_file)
+{
+	std::ifstream ifs(list_file);
+
+	if (!ifs.is_open())
+	{
+		CDebugConsole::get().output_error("Couldn't open file list {}.", list_file.string());
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(ifs, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		if (!line.empty())
+			collect_input(line);
+	}
+
+	return true;
+}
+
+void CBatchScanner::scan_file(const std::filesystem::path& filepath)
+{
+	JsonLineWriter record;
+
+	std::error_code ec;
+	uint64_t filesize = std::filesystem::file_size(filepath, ec);
+
+	record.add("path", filepath.string());
+	record.add("size", ec ? 0 : filesize);
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	bool ok;
+	{
+		CX86PEProcessor processor;
+
+		try
+		{
+			ok = processor.process(filepath);
+
+			if (ok && !m_headers_only)
+				processor.decode_all();
+
+			// Truncated files are reported as failed, even though parts of them got decoded
+			ok = ok && !processor.is_malformed();
+		}
+		catch (const std::exception& e)
+		{
+			CDebugConsole::get().output_error("Failed to scan {}: {}", filepath.string(), e.what());
+			ok = false;
+		}
+
+		record.add("ok", ok);
+		record.add("ms", std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+
+		if (ok)
+			processor.write_summary(record);
+	}
+
+	if (!ec)
+		m_total_bytes += filesize;
+
+	if (!ok)
+		m_num_failed++;
+
+	write_record(record.finish());
+}
+
+void CBatchScanner::write_record(const std::string& record)
+{
+	std::lock_guard lock(m_output_lock);
+
+	m_output->write(record.data(), record.size());
+}
@@ -0,0 +1,79 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_C_BATCH_SCANNER_H
+#define EXEIN_C_BATCH_SCANNER_H
+
+#pragma once
+
+// Headless mode. Processes every file from the command line (directories are
+// walked recursively, @file reads a list of paths, one per line) on a bounded
+// amount of workers and writes one JSON record per line for every file.
+class CBatchScanner
+{
+public:
+	static auto& get()
+	{
+		static CBatchScanner scanner;
+		return scanner;
+	}
+
+public:
+	// Arguments without the program name. Returns the process exit code.
+	int run(int argc, char** argv);
+
+private:
+	bool parse_args(int argc, char** argv);
+	void print_usage();
+
+	void collect_input(const std::filesystem::path& path);
+	bool collect_input_list(const std::filesystem::path& list_file);
+
+	void scan_file(const std::filesystem::path& filepath);
+
+	void write_record(const std::string& record);
+
+private:
+	std::vector<std::string> m_inputs;
+	std::vector<std::filesystem::path> m_files;
+
+	uint32_t m_num_jobs = 0; // 0 means one per hardware thread
+	std::filesystem::path m_output_file;
+	std::filesystem::path m_cache_directory; // Empty if not cached
+	bool m_verbose = false;
+	bool m_headers_only = false;
+
+	std::mutex m_output_lock;
+	std::ofstream m_output_stream;
+	std::ostream* m_output = &std::cout;
+
+	std::atomic<uint64_t> m_num_failed = 0;
+	std::atomic<uint64_t> m_total_bytes = 0;
+};
+
+#endif
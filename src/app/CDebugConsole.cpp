@@ -30,6 +30,7 @@
 
 #define FANCY_TIMESTAMP "{}"
 
+#ifdef _WIN32
 uint16_t CWinBaseConsole::s_color_translation[] =
 {
 	/*White   */FOREGROUND_INTENSITY | FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED,
@@ -37,61 +38,297 @@ uint16_t CWinBaseConsole::s_color_translation[] =
 	/*Yellow  */FOREGROUND_INTENSITY | FOREGROUND_BLUE | FOREGROUND_GREEN,
 	/*NonPrint*/FOREGROUND_INTENSITY | FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED,
 };
+#endif
+
+CWinBaseConsole::~CWinBaseConsole()
+{
+	// In case that destroy() wasn't reached
+	stop_writer();
+}
 
 bool CWinBaseConsole::create(int32_t max_lines)
 {
+#ifdef _WIN32
 	AllocConsole();
 
 	// So that we can use printf and other std features
 	if (!redirect_con_io())
 		return false;
+#endif
 
 	m_max_lines = max_lines;
 
-	resize_con_buffer(NULL, m_max_lines);
+	resize_con_buffer(0, m_max_lines);
+
+	start_writer();
+
+	return true;
+}
+
+bool CWinBaseConsole::create_headless()
+{
+	m_headless = true;
+
+#ifdef _WIN32
+	// We're a windows subsystem application, hence we don't inherit the console
+	// of the shell that started us. Print into it if there's one.
+	if (AttachConsole(ATTACH_PARENT_PROCESS) && !redirect_con_io())
+		return false;
+#endif
+
+	start_writer();
 
 	return true;
 }
 
 void CWinBaseConsole::destroy()
 {
+	stop_writer();
+
+#ifdef _WIN32
 	FreeConsole();
+#endif
+}
+
+void CWinBaseConsole::output(std::string text, Type type, bool fancy_timestamp, bool newline)
+{
+	LogEntry entry;
+	entry.m_text = std::move(text);
+	entry.m_time = std::chrono::system_clock::now();
+	entry.m_type = type;
+	entry.m_fancy_timestamp = fancy_timestamp;
+	entry.m_newline = newline;
+
+	if (enter_producer())
+	{
+		push_entry(std::move(entry));
+		leave_producer();
+		return;
+	}
+
+	std::lock_guard lock(m_output_lock);
+
+	std::string line;
+	append_entry(line, entry);
+	write_out(line, color_by_type(type));
+}
+
+void CWinBaseConsole::flush()
+{
+	// Without a writer everything has been written synchronously already
+	if (!enter_producer())
+		return;
+
+	uint64_t ticket = m_last_flush_ticket.fetch_add(1) + 1;
+
+	LogEntry entry;
+	entry.m_flush_ticket = ticket;
+	push_entry(std::move(entry));
+
+	// The writer drains the queue before it exits, so the ticket is reached even if it's
+	// being stopped right now
+	leave_producer();
+
+	// Tickets of concurrent flushes may be queued out of order, anything past ours will do
+	while (true)
+	{
+		uint64_t flushed = m_flushed_ticket.load();
+		if (flushed >= ticket)
+			break;
+
+		m_flushed_ticket.wait(flushed);
+	}
+}
+
+void CWinBaseConsole::start_writer()
+{
+	if (m_writer.joinable())
+		return;
+
+	m_stop_writer = false;
+	m_writer = std::thread(&CWinBaseConsole::writer_thread, this);
+
+	m_writer_running.store(true, std::memory_order_release);
+}
+
+void CWinBaseConsole::stop_writer()
+{
+	if (!m_writer.joinable())
+		return;
+
+	// Producers that find the writer gone write synchronously, not before it's done
+	std::lock_guard lock(m_output_lock);
+
+	// Pairs with enter_producer(), either the producer sees that the writer is going away,
+	// or we see the producer and wait until its entry is queued.
+	m_writer_running.store(false);
+
+	while (m_num_producers.load() != 0)
+		std::this_thread::yield();
+
+	m_stop_writer.store(true, std::memory_order_release);
+	m_writer_idle.store(false);
+	m_writer_idle.notify_one();
+
+	// The writer drains the queue before it exits
+	m_writer.join();
 }
 
-void CWinBaseConsole::output(const std::string& fmt, Type type, bool fancy_timestamp, bool newline)
+bool CWinBaseConsole::enter_producer()
 {
-	m_output_lock.lock();
+	m_num_producers.fetch_add(1);
+
+	if (m_writer_running.load())
+		return true;
 
-	auto clock_now = std::chrono::system_clock::now();
+	leave_producer();
+	return false;
+}
+
+void CWinBaseConsole::push_entry(LogEntry&& entry)
+{
+	// Wait for free space rather than dropping the message
+	while (!m_queue.try_push(std::move(entry)))
+	{
+		m_writer_idle.store(false);
+		m_writer_idle.notify_one();
+		std::this_thread::yield();
+	}
 
-	time_t now = std::chrono::system_clock::to_time_t(clock_now);
+	// Pairs with the fence inside of the writer, either it sees the new entry or
+	// we see that it's going to sleep.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
 
-	// Duration in ms
-	auto msec = std::chrono::duration_cast<std::chrono::milliseconds>(clock_now.time_since_epoch()).count();
-	msec %= 1000;
+	if (m_writer_idle.load(std::memory_order_relaxed))
+	{
+		m_writer_idle.store(false, std::memory_order_relaxed);
+		m_writer_idle.notify_one();
+	}
+}
+
+void CWinBaseConsole::writer_thread()
+{
+	std::string batch;
+	Color batch_color = Color::White;
+
+	LogEntry entry;
+
+	for (;;)
+	{
+		// Read before draining, so that everything queued before stop_writer() is written.
+		bool stop = m_stop_writer.load(std::memory_order_acquire);
+		bool got_any = false;
+
+		while (m_queue.try_pop(entry))
+		{
+			got_any = true;
+
+			if (entry.m_flush_ticket)
+			{
+				write_out(batch, batch_color);
+
+				if (entry.m_flush_ticket > m_flushed_ticket.load(std::memory_order_relaxed))
+				{
+					m_flushed_ticket.store(entry.m_flush_ticket);
+					m_flushed_ticket.notify_all();
+				}
+
+				entry.m_flush_ticket = 0;
+				continue;
+			}
+
+			// Colors apply to whatever is written after they're set
+			auto color = color_by_type(entry.m_type);
+			if (color != batch_color)
+			{
+				write_out(batch, batch_color);
+				batch_color = color;
+			}
+
+			append_entry(batch, entry);
+		}
+
+		// One write and one flush per batch instead of one per line
+		write_out(batch, batch_color);
+
+		if (got_any)
+			continue;
+
+		if (stop)
+			break;
+
+		m_writer_idle.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (!m_queue.empty() || m_stop_writer.load(std::memory_order_relaxed))
+		{
+			m_writer_idle.store(false, std::memory_order_relaxed);
+			continue;
+		}
+
+		m_writer_idle.wait(true);
+	}
+}
 
-	push_color(color_by_type(type));
+void CWinBaseConsole::append_entry(std::string& out, const LogEntry& entry)
+{
+	if (entry.m_fancy_timestamp)
+	{
+		time_t now = std::chrono::system_clock::to_time_t(entry.m_time);
+
+		if (now != m_cached_second)
+		{
+			// localtime() shares its buffer with the gmtime() calls of the parsers
+			tm local;
+#ifdef _WIN32
+			localtime_s(&local, &now);
+#else
+			localtime_r(&now, &local);
+#endif
+
+			std::strftime(m_cached_time, sizeof(m_cached_time), "%T", &local);
+			m_cached_second = now;
+		}
+
+		// Duration in ms
+		auto msec = std::chrono::duration_cast<std::chrono::milliseconds>(entry.m_time.time_since_epoch()).count();
+		msec %= 1000;
+
+		out += std::format("[{}.{:03}] ", m_cached_time, msec);
+	}
 
-	if (fancy_timestamp)
-		std::cout << '[' << std::put_time(std::localtime(&now), "%T") << '.' << std::format("{:03}", msec) << ']' << ' ';
+	out += entry.m_text;
 
-	std::cout << fmt.c_str();
-	
-	if (newline)
-		std::cout << std::endl;
+	if (entry.m_newline)
+		out += '\n';
 
 	// Reached the end
-	if (++m_total_lines == m_max_lines)
-		m_total_lines--;
+	if (m_total_lines.fetch_add(1, std::memory_order_relaxed) + 1 == (uint32_t)m_max_lines)
+		m_total_lines.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void CWinBaseConsole::write_out(std::string& text, Color color)
+{
+	if (text.empty())
+		return;
+
+	auto& stream = m_headless ? std::cerr : std::cout;
+
+	push_color(color);
+
+	stream.write(text.data(), text.size());
+	stream.flush();
 
 	pop_color();
 
-	m_output_lock.unlock();
+	text.clear();
 }
 
+#ifdef _WIN32
 void CWinBaseConsole::change_title(const std::string& title)
 {
-	SetConsoleTitleA(title.c_str());
+	if (!m_headless)
+		SetConsoleTitleA(title.c_str());
 }
 
 void CWinBaseConsole::resize_con_buffer(int32_t x, int32_t y)
@@ -115,8 +352,17 @@ void CWinBaseConsole::resize_con_buffer(int32_t x, int32_t y)
 
 void CWinBaseConsole::change_color(Color color)
 {
-	SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), s_color_translation[(int)color]);
+	if (!m_headless)
+		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), s_color_translation[(int)color]);
 }
+#else
+// There's no console window to change without Windows
+void CWinBaseConsole::change_title(const std::string&) {}
+void CWinBaseConsole::resize_con_buffer(int32_t, int32_t) {}
+void CWinBaseConsole::change_color(Color) {}
+#endif
+
+#ifdef _WIN32
 
 // https://stackoverflow.com/questions/191842/how-do-i-get-console-output-in-c-with-a-windows-program
 bool CWinBaseConsole::redirect_con_io()
@@ -158,6 +404,7 @@ bool CWinBaseConsole::redirect_con_io()
 
 	return result;
 }
+#endif
 
 bool CDebugConsole::create(int32_t total_lines)
 {
@@ -169,6 +416,16 @@ bool CDebugConsole::create(int32_t total_lines)
 	return true;
 }
 
+bool CDebugConsole::create_headless(LogLevel min_level)
+{
+	if (!CWinBaseConsole::create_headless())
+		return false;
+
+	set_min_level(min_level);
+
+	return true;
+}
+
 void CDebugConsole::destroy()
 {
 	CWinBaseConsole::destroy();
@@ -182,33 +439,31 @@ void CDebugConsole::update()
 		return;
 
 	static const char animation[] = { '|', '/', '-', '\\' };
-	static int32_t animidx = 0;
+	static uint32_t animidx = 0;
 
 	// Title animation
 	change_title(std::format("{:c} Debug Console | {} lines", animation[animidx++], m_total_lines));
 
-	if (animidx >= ARRAYSIZE(animation))
+	if (animidx >= std::size(animation))
 		animidx = 0;
 
 	t = std::chrono::system_clock::now();
 }
 
-void CDebugConsole::output_message(const std::string& fmt, bool newline)
-{
-	output(fmt, CWinBaseConsole::Type::Message, !m_no_fancy_timestamp, newline);
-}
-
-void CDebugConsole::output_error(const std::string& fmt, bool newline)
+void CDebugConsole::output_message(std::string_view text)
 {
-	output(fmt, CWinBaseConsole::Type::Error, !m_no_fancy_timestamp, newline);
+	if (is_enabled<LogLevel::Message>())
+		output(std::string(text), CWinBaseConsole::Type::Message, true, true);
 }
 
-void CDebugConsole::output_info(const std::string& fmt, bool newline)
+void CDebugConsole::output_error(std::string_view text)
 {
-	output(fmt, CWinBaseConsole::Type::Info, !m_no_fancy_timestamp, newline);
+	if (is_enabled<LogLevel::Error>())
+		output(std::string(text), CWinBaseConsole::Type::Error, true, true);
 }
 
-void CDebugConsole::output_newline()
+void CDebugConsole::output_info(std::string_view text)
 {
-	output("", CWinBaseConsole::Type::NonPrint, !m_no_fancy_timestamp, true);
+	if (is_enabled<LogLevel::Info>())
+		output(std::string(text), CWinBaseConsole::Type::Info, true, true);
 }
@@ -50,11 +50,22 @@ public:
 	};
 
 protected:
+	~CWinBaseConsole();
+
 	virtual bool create(int32_t max_lines);
 	virtual void destroy();
 
-	// Use std::format with python-line replacement fields
-	virtual void output(const std::string& fmt, Type type, bool fancy_timestamp, bool newline);
+	// Used when running without a window. Messages go to stderr of the parent
+	// process, so that stdout stays free for machine-readable output.
+	virtual bool create_headless();
+
+	// Only queues the message, the writer thread timestamps it with the time of
+	// this call and writes it out later. Blocks only when the queue is full, nothing
+	// is ever dropped.
+	virtual void output(std::string text, Type type, bool fancy_timestamp, bool newline);
+
+	// Waits until everything that has been queued so far is written out.
+	void flush();
 
 	void change_title(const std::string& title);
 
@@ -62,7 +73,34 @@ protected:
 	void resize_con_buffer(int32_t x, int32_t y);
 
 private:
+	struct LogEntry
+	{
+		std::string m_text;
+		std::chrono::system_clock::time_point m_time;
+		Type m_type;
+		bool m_fancy_timestamp, m_newline;
+
+		// Non-zero when this is a flush request rather than a message
+		uint64_t m_flush_ticket = 0;
+	};
+
+	void start_writer();
+	void stop_writer();
+
+	void writer_thread();
+
+	// Producers register before pushing, so that stop_writer() can wait for them. False
+	// when there's no writer anymore, the entry has to be written synchronously then.
+	bool enter_producer();
+	inline void leave_producer() { m_num_producers.fetch_sub(1); }
+
+	void push_entry(LogEntry&& entry);
+	void append_entry(std::string& out, const LogEntry& entry);
+	void write_out(std::string& text, Color color);
+
+#ifdef _WIN32
 	bool redirect_con_io();
+#endif
 	void change_color(Color color);
 
 	inline void push_color(Color color)
@@ -104,10 +142,58 @@ private:
 
 	int32_t m_max_lines;
 
+	MpscRing<LogEntry, 4096> m_queue;
+
+	std::thread m_writer;
+	std::atomic<bool> m_writer_running = false, m_stop_writer = false;
+	std::atomic<bool> m_writer_idle = false; // Producers wake the writer up only when it sleeps
+	std::atomic<uint32_t> m_num_producers = 0;
+
+	// flush() waits until the writer has reached its ticket. These live here rather than
+	// on the stack of flush(), which may return before the writer is done notifying.
+	std::atomic<uint64_t> m_last_flush_ticket = 0, m_flushed_ticket = 0;
+
+	// Written synchronously when there's no writer thread (before create or after destroy)
 	std::mutex m_output_lock;
 
+	// localtime() is slow, it's called at most once per second
+	time_t m_cached_second = 0;
+	char m_cached_time[16] = {};
+
 protected:
-	uint32_t m_total_lines;
+	std::atomic<uint32_t> m_total_lines = 0;
+
+	bool m_headless = false;
+};
+
+// Messages below this level are compiled out, so their arguments are never formatted.
+// 0 = Verbose, 1 = Message, 2 = Info, 3 = Error
+#ifndef EXEIN_LOG_MIN_LEVEL
+#define EXEIN_LOG_MIN_LEVEL 0
+#endif
+
+// Bit mask of categories (1 << LogCategory) compiled out below the error level.
+#ifndef EXEIN_LOG_DISABLED_CATEGORIES
+#define EXEIN_LOG_DISABLED_CATEGORIES 0
+#endif
+
+enum class LogLevel
+{
+	Verbose,	// Per-item chatter, e.g. every section or data directory
+	Message,
+	Info,		// Warnings
+	Error,		// Errors ignore the category filter
+};
+
+enum class LogCategory
+{
+	General,
+	Gui,
+	Threading,
+	Io,			// Byte buffers and file mappings
+	Parser,
+	Strings,	// String search inside of the image
+	Batch,
 };
 
 class CDebugConsole : CWinBaseConsole
@@ -123,19 +209,111 @@ public:
 	bool create(int32_t max_lines);
 	void destroy();
 
+	// Doesn't create console window.
+	bool create_headless(LogLevel min_level);
+
 	// Ran every # ms (constant in function)
 	void update();
 
-	void output_message(const std::string& fmt, bool newline = true);
-	void output_error(const std::string& fmt, bool newline = true);
-	void output_info(const std::string& fmt, bool newline = true);
-	void output_newline();
+	// The message is formatted only if it passes both the compile-time and the runtime filter.
+	template<LogCategory C = LogCategory::General, typename... Args>
+	inline void output_verbose(std::format_string<Args...> fmt, Args&&... args)
+	{
+		output_filtered<LogLevel::Verbose, C>(fmt, std::forward<Args>(args)...);
+	}
+
+	template<LogCategory C = LogCategory::General, typename... Args>
+	inline void output_message(std::format_string<Args...> fmt, Args&&... args)
+	{
+		output_filtered<LogLevel::Message, C>(fmt, std::forward<Args>(args)...);
+	}
+
+	template<LogCategory C = LogCategory::General, typename... Args>
+	inline void output_info(std::format_string<Args...> fmt, Args&&... args)
+	{
+		output_filtered<LogLevel::Info, C>(fmt, std::forward<Args>(args)...);
+	}
+
+	template<LogCategory C = LogCategory::General, typename... Args>
+	inline void output_error(std::format_string<Args...> fmt, Args&&... args)
+	{
+		output_filtered<LogLevel::Error, C>(fmt, std::forward<Args>(args)...);
+	}
 
-	inline void push_no_timestamp() { m_no_fancy_timestamp = true; }
-	inline void pop_no_timestamp() { m_no_fancy_timestamp = false; }
+	// For text that isn't known at compile time, such as exception messages.
+	void output_message(std::string_view text);
+	void output_error(std::string_view text);
+	void output_info(std::string_view text);
+
+	template<LogLevel L, LogCategory C>
+	static consteval bool is_compiled_in()
+	{
+		if (static_cast<int>(L) < EXEIN_LOG_MIN_LEVEL)
+			return false;
+
+		return L == LogLevel::Error || !(EXEIN_LOG_DISABLED_CATEGORIES & (1u << static_cast<uint32_t>(C)));
+	}
+
+	inline bool is_enabled(LogLevel level, LogCategory category) const
+	{
+		if (level < m_min_level.load(std::memory_order_relaxed))
+			return false;
+
+		return level == LogLevel::Error || (m_enabled_categories.load(std::memory_order_relaxed) & (1u << static_cast<uint32_t>(category)));
+	}
+
+	// Use this before building anything expensive that is only going to be logged.
+	template<LogLevel L, LogCategory C = LogCategory::General>
+	inline bool is_enabled() const
+	{
+		if constexpr (is_compiled_in<L, C>())
+			return is_enabled(L, C);
+		else
+			return false;
+	}
+
+	inline void set_min_level(LogLevel level) { m_min_level.store(level, std::memory_order_relaxed); }
+
+	inline void set_category_enabled(LogCategory category, bool enabled)
+	{
+		if (enabled)
+			m_enabled_categories.fetch_or(1u << static_cast<uint32_t>(category), std::memory_order_relaxed);
+		else
+			m_enabled_categories.fetch_and(~(1u << static_cast<uint32_t>(category)), std::memory_order_relaxed);
+	}
+
+	// Waits until the writer thread has caught up
+	inline void flush() { CWinBaseConsole::flush(); }
+
+private:
+	template<LogLevel L, LogCategory C, typename... Args>
+	inline void output_filtered(std::format_string<Args...> fmt, Args&&... args)
+	{
+		if constexpr (is_compiled_in<L, C>())
+		{
+			if (is_enabled(L, C))
+				output(std::format(fmt, std::forward<Args>(args)...), type_by_level(L), true, true);
+		}
+	}
+
+	static constexpr CWinBaseConsole::Type type_by_level(LogLevel level)
+	{
+		switch (level)
+		{
+			case LogLevel::Error:
+				return CWinBaseConsole::Type::Error;
+
+			case LogLevel::Info:
+				return CWinBaseConsole::Type::Info;
+
+			default:
+				return CWinBaseConsole::Type::Message;
+		}
+	}
 
 private:
-	bool m_no_fancy_timestamp = false;
+	std::atomic<LogLevel> m_min_level = LogLevel::Verbose;
+	std::atomic<uint32_t> m_enabled_categories = ~0u;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,158 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#include "exein_pch.h"
+
+void CParseCacheEntry::close()
+{
+	m_reader.reset();
+
+	if (m_buffer.get_raw())
+		m_buffer.destroy();
+}
+
+bool CParseCache::set_directory(const std::filesystem::path& directory)
+{
+	m_directory.clear();
+
+	if (directory.empty())
+		return true;
+
+	std::error_code ec;
+	std::filesystem::create_directories(directory, ec);
+
+	if (ec)
+	{
+		CDebugConsole::get().output_error("Couldn't create parse cache directory {}: {}", directory.string(), ec.message());
+		return false;
+	}
+
+	m_directory = directory;
+
+	CDebugConsole::get().output_message<LogCategory::Io>("Using parse cache in {}", m_directory.string());
+
+	return true;
+}
+
+CParseCache::Key CParseCache::make_key(const uint8_t* data, uint64_t size)
+{
+	return { Xxh128::hash(data, (size_t)size), size };
+}
+
+bool CParseCache::load(const Key& key, uint32_t version, CParseCacheEntry& entry)
+{
+	auto path = entry_path(key, version);
+
+	// Not being there is the common case, don't let the mapping complain about it
+	std::error_code ec;
+	uint64_t size = std::filesystem::file_size(path, ec);
+
+	if (ec || size < sizeof(EntryHeader) || !entry.m_buffer.map(path, size))
+	{
+		m_num_misses++;
+		return false;
+	}
+
+	EntryHeader header;
+	std::memcpy(&header, entry.m_buffer.get_raw(), sizeof(header));
+
+	const uint8_t* payload = entry.m_buffer.get_raw() + sizeof(header);
+
+	if (header.m_magic != k_magic || header.m_version != version ||
+		header.m_key.m_hash != key.m_hash || header.m_key.m_file_size != key.m_file_size ||
+		header.m_payload_size != size - sizeof(header) ||
+		header.m_payload_hash != Xxh64::hash(payload, (size_t)header.m_payload_size))
+	{
+		CDebugConsole::get().output_info<LogCategory::Io>("Ignoring damaged parse cache entry {}", path.string());
+
+		entry.close();
+		m_num_misses++;
+		return false;
+	}
+
+	entry.m_reader.emplace(payload, (size_t)header.m_payload_size);
+
+	m_num_hits++;
+	return true;
+}
+
+bool CParseCache::store(const Key& key, uint32_t version, const BinaryWriter& payload)
+{
+	auto path = entry_path(key, version);
+
+	auto temp_path = path;
+	temp_path += std::format(".{:x}-{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()), m_num_temp_files++);
+
+	EntryHeader header = {};
+	header.m_magic = k_magic;
+	header.m_version = version;
+	header.m_key = key;
+	header.m_payload_size = payload.data().size();
+	header.m_payload_hash = Xxh64::hash(payload.data().data(), payload.data().size());
+
+	std::error_code ec;
+
+	{
+		std::ofstream ofs(temp_path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+
+		if (!ofs.is_open())
+		{
+			CDebugConsole::get().output_error("Couldn't create parse cache entry {}", temp_path.string());
+			return false;
+		}
+
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		ofs.write(reinterpret_cast<const char*>(payload.data().data()), payload.data().size());
+
+		if (!ofs.flush())
+		{
+			ofs.close();
+			std::filesystem::remove(temp_path, ec);
+
+			CDebugConsole::get().output_error("Couldn't write parse cache entry {}", temp_path.string());
+			return false;
+		}
+	}
+
+	std::filesystem::rename(temp_path, path, ec);
+
+	if (ec)
+	{
+		CDebugConsole::get().output_error("Couldn't rename parse cache entry {}: {}", path.string(), ec.message());
+
+		std::filesystem::remove(temp_path, ec);
+		return false;
+	}
+
+	return true;
+}
+
+std::filesystem::path CParseCache::entry_path(const Key& key, uint32_t version) const
+{
+	return m_directory / std::format("{}-{:x}.v{}.bin", Xxh128::to_string(key.m_hash), key.m_file_size, version);
+}
@@ -0,0 +1,118 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_C_PARSE_CACHE_H
+#define EXEIN_C_PARSE_CACHE_H
+
+#pragma once
+
+// Entry of the parse cache mapped for reading. The payload is read in the same
+// order as it has been written, the mapping is released by close() or once the
+// entry goes out of scope.
+class CParseCacheEntry
+{
+public:
+	~CParseCacheEntry() { close(); }
+
+	inline bool is_open() const { return m_reader.has_value(); }
+
+	inline BinaryReader& reader() { return *m_reader; }
+
+	void close();
+
+private:
+	friend class CParseCache;
+
+	ByteBuffer<uint64_t> m_buffer;
+	std::optional<BinaryReader> m_reader;
+};
+
+// Persistent cache of parsed images, addressed by the contents of the file rather
+// than by its path, so that renamed and duplicate files hit the same entry. Every
+// entry is a single file named after the key and the version of the parser that
+// wrote it, entries of other versions are simply never looked up. Disabled until
+// a directory has been set.
+class CParseCache
+{
+public:
+	static auto& get()
+	{
+		static CParseCache cache;
+		return cache;
+	}
+
+	// A hit restores the file's MD5, SHA-256 and Authenticode digests along with the rest,
+	// so a file colliding with a cached one would take over its identity. 128 bits keep that
+	// out of reach of brute force, though XXH128 isn't meant to resist a determined attacker
+	// the way a cryptographic hash is.
+	struct Key
+	{
+		Xxh128::Hash m_hash; // Of the whole file
+		uint64_t m_file_size = 0;
+	};
+
+public:
+	// Creates the directory if it doesn't exist yet. An empty path disables the cache.
+	bool set_directory(const std::filesystem::path& directory);
+
+	inline bool is_enabled() const { return !m_directory.empty(); }
+
+	static Key make_key(const uint8_t* data, uint64_t size);
+
+	// Maps the entry if there is one and it's intact.
+	bool load(const Key& key, uint32_t version, CParseCacheEntry& entry);
+
+	// Written into a temporary file first and then renamed, so that concurrent
+	// readers (and writers of the same file) never see a partial entry.
+	bool store(const Key& key, uint32_t version, const BinaryWriter& payload);
+
+	inline uint64_t get_num_hits() const { return m_num_hits.load(std::memory_order_relaxed); }
+	inline uint64_t get_num_misses() const { return m_num_misses.load(std::memory_order_relaxed); }
+
+private:
+	struct EntryHeader
+	{
+		uint32_t m_magic;
+		uint32_t m_version;
+		Key m_key;
+		uint64_t m_payload_size;
+		uint64_t m_payload_hash; // XXH64 of the payload
+	};
+
+	static inline constexpr uint32_t k_magic = 0x43505845; // "EXPC"
+
+	std::filesystem::path entry_path(const Key& key, uint32_t version) const;
+
+private:
+	std::filesystem::path m_directory;
+
+	std::atomic<uint64_t> m_num_hits = 0, m_num_misses = 0;
+	std::atomic<uint32_t> m_num_temp_files = 0;
+};
+
+#endif
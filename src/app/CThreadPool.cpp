@@ -0,0 +1,217 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#include "exein_pch.h"
+
+thread_local uint32_t CThreadPool::s_worker_index = CThreadPool::k_external_queue;
+
+bool CThreadPool::create(uint32_t num_workers)
+{
+	if (!m_workers.empty())
+	{
+		CDebugConsole::get().output_error("Thread pool has already been created");
+		return false;
+	}
+
+	if (num_workers == 0)
+		num_workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+	m_stop = false;
+
+	for (uint32_t i = 0; i < num_workers + 1; i++)
+		m_queues.emplace_back(std::make_unique<WorkQueue>());
+
+	for (uint32_t i = 0; i < num_workers; i++)
+		m_workers.emplace_back(&CThreadPool::worker_loop, this, i);
+
+	CDebugConsole::get().output_message<LogCategory::Threading>("Created thread pool with {} workers", num_workers);
+
+	return true;
+}
+
+void CThreadPool::destroy()
+{
+	{
+		std::lock_guard lock(m_wake_lock);
+		m_stop = true;
+	}
+
+	m_wake_cv.notify_all();
+
+	for (auto& worker : m_workers)
+		worker.join();
+
+	m_workers.clear();
+	m_queues.clear();
+}
+
+void CThreadPool::submit(CTaskGroup& group, Task_t task)
+{
+	group.m_pending.fetch_add(1, std::memory_order_relaxed);
+
+	Task t = { std::move(task), &group };
+
+	if (m_workers.empty())
+	{
+		execute(t);
+		return;
+	}
+
+	auto& queue = *m_queues[own_queue_index()];
+
+	{
+		std::lock_guard lock(queue.m_lock);
+		queue.m_tasks.emplace_back(std::move(t));
+	}
+
+	m_num_queued.fetch_add(1, std::memory_order_release);
+
+	// Taking the lock makes sure that a worker that is just about to sleep
+	// doesn't miss the notification.
+	{
+		std::lock_guard lock(m_wake_lock);
+	}
+
+	m_wake_cv.notify_one();
+}
+
+void CThreadPool::wait(CTaskGroup& group)
+{
+	uint32_t index = own_queue_index();
+
+	while (true)
+	{
+		// Read before the group (both sequentially consistent, as in execute()), so a group
+		// that finishes right after this still moves the counter past what we wait on.
+		uint32_t num_finished = m_num_finished_groups.load();
+
+		if (group.m_pending.load() == 0)
+			break;
+
+		Task task;
+		if (!m_workers.empty() && try_pop(index, task))
+		{
+			execute(task);
+			continue;
+		}
+
+		// Nothing left to help with, the rest is being executed by others.
+		m_num_finished_groups.wait(num_finished);
+	}
+
+	std::exception_ptr exception;
+	{
+		std::lock_guard lock(group.m_exception_lock);
+		exception = std::exchange(group.m_exception, nullptr);
+	}
+
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+void CThreadPool::worker_loop(uint32_t index)
+{
+	s_worker_index = index;
+
+	while (true)
+	{
+		Task task;
+		if (try_pop(index, task))
+		{
+			execute(task);
+			continue;
+		}
+
+		std::unique_lock lock(m_wake_lock);
+		m_wake_cv.wait(lock, [&]() { return m_stop || m_num_queued.load(std::memory_order_acquire) != 0; });
+
+		if (m_stop && m_num_queued.load(std::memory_order_acquire) == 0)
+			break;
+	}
+}
+
+bool CThreadPool::try_pop(uint32_t index, Task& task)
+{
+	uint32_t num_queues = (uint32_t)m_queues.size();
+
+	// Newest task from our own queue, its data is most likely still in the cache.
+	{
+		auto& own = *m_queues[index];
+
+		std::lock_guard lock(own.m_lock);
+		if (!own.m_tasks.empty())
+		{
+			task = std::move(own.m_tasks.back());
+			own.m_tasks.pop_back();
+			m_num_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// Oldest task from someone else. These tend to be the largest ones.
+	for (uint32_t i = 1; i < num_queues; i++)
+	{
+		auto& victim = *m_queues[(index + i) % num_queues];
+
+		std::lock_guard lock(victim.m_lock);
+		if (!victim.m_tasks.empty())
+		{
+			task = std::move(victim.m_tasks.front());
+			victim.m_tasks.pop_front();
+			m_num_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void CThreadPool::execute(Task& task)
+{
+	// An exception can't leave the thread that happens to execute the task, and the group
+	// has to be finished either way, or its waiters would never wake up.
+	try
+	{
+		task.m_fn();
+	}
+	catch (...)
+	{
+		std::lock_guard lock(task.m_group->m_exception_lock);
+
+		if (!task.m_group->m_exception)
+			task.m_group->m_exception = std::current_exception();
+	}
+
+	// The group may be gone as soon as its last task is done, waiters are woken up through
+	// the pool instead.
+	if (task.m_group->m_pending.fetch_sub(1) == 1)
+	{
+		m_num_finished_groups.fetch_add(1);
+		m_num_finished_groups.notify_all();
+	}
+}
@@ -0,0 +1,125 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_C_THREAD_POOL_H
+#define EXEIN_C_THREAD_POOL_H
+
+#pragma once
+
+// Set of tasks that can be waited on together. Tasks may submit more tasks
+// into the same group, wait() returns once all of them have finished.
+class CTaskGroup
+{
+public:
+	inline bool is_done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class CThreadPool;
+
+	std::atomic<uint32_t> m_pending = 0;
+
+	// First exception thrown by any of the tasks, rethrown by wait()
+	std::mutex m_exception_lock;
+	std::exception_ptr m_exception;
+};
+
+// Process-wide pool of worker threads. Every worker owns a queue of tasks. It pops
+// new work from the back of its own queue and when that's empty, steals from the
+// front of queues of the others, so that one large job split into many small
+// tasks keeps all of the cores busy. Threads that aren't part of the pool push
+// into a shared queue and help executing tasks while they wait for a group.
+class CThreadPool
+{
+public:
+	static auto& get()
+	{
+		static CThreadPool pool;
+		return pool;
+	}
+
+	using Task_t = std::function<void()>;
+
+public:
+	// Passing 0 creates one worker less than the amount of hardware threads,
+	// the thread that waits for the work is the last one.
+	bool create(uint32_t num_workers = 0);
+	void destroy();
+
+	// Schedules the task. If the pool hasn't been created, the task is executed
+	// right away on the calling thread.
+	void submit(CTaskGroup& group, Task_t task);
+
+	// Executes queued tasks until every task of the group has finished. If any of them
+	// has thrown, the first exception is rethrown here once all of them are done.
+	void wait(CTaskGroup& group);
+
+	// Including the waiting thread
+	inline uint32_t get_num_threads() const { return (uint32_t)m_workers.size() + 1; }
+
+private:
+	struct Task
+	{
+		Task_t m_fn;
+		CTaskGroup* m_group;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex m_lock;
+		std::deque<Task> m_tasks;
+	};
+
+	void worker_loop(uint32_t index);
+
+	// Own queue first, then steals from the others
+	bool try_pop(uint32_t index, Task& task);
+	void execute(Task& task);
+
+	// Index of the queue that belongs to the calling thread
+	inline uint32_t own_queue_index() const { return s_worker_index != k_external_queue ? s_worker_index : (uint32_t)m_workers.size(); }
+
+private:
+	static inline constexpr uint32_t k_external_queue = std::numeric_limits<uint32_t>::max();
+	static thread_local uint32_t s_worker_index;
+
+	std::vector<std::thread> m_workers;
+
+	// One for each worker and one shared by threads outside of the pool at the end
+	std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+	// Idle workers sleep here until anything gets queued
+	std::mutex m_wake_lock;
+	std::condition_variable m_wake_cv;
+	std::atomic<uint32_t> m_num_queued = 0;
+	std::atomic<bool> m_stop = false;
+
+	// Threads waiting for a group that has nothing left to steal sleep on this
+	std::atomic<uint32_t> m_num_finished_groups = 0;
+};
+
+#endif
@@ -28,7 +28,7 @@
 
 #include "exein_pch.h"
 
-std::string CUtil::make_filesize_nice(uint32_t number)
+std::string CUtil::make_filesize_nice(uint64_t number)
 {
 	if (!number)
 		return "NaN";
@@ -36,7 +36,7 @@ std::string CUtil::make_filesize_nice(uint32_t number)
 	std::string formatted;
 
 	uint32_t decade = 0;
-	for (uint32_t n = number; n; n /= 1000, decade++)
+	for (uint64_t n = number; n; n /= 1000, decade++)
 	{
 		uint32_t num = n % 1000;
 
@@ -64,21 +64,68 @@ std::string CUtil::make_filesize_nice(uint32_t number)
 	return formatted;
 }
 
-void CUtil::copy_to_clipboard(const std::string& str_to_copy)
+#ifdef _WIN32
+void CUtil::copy_to_clipboard(std::string_view str_to_copy)
 {
-	HANDLE hHandle = GlobalAlloc(GMEM_FIXED, str_to_copy.size() + 1);
-	memcpy(hHandle, str_to_copy.c_str(), str_to_copy.size() + 1);
+	// The view doesn't have to be NUL-terminated, terminate the copy ourselves.
+	auto hHandle = reinterpret_cast<char*>(GlobalAlloc(GMEM_FIXED, str_to_copy.size() + 1));
+	memcpy(hHandle, str_to_copy.data(), str_to_copy.size());
+	hHandle[str_to_copy.size()] = '\0';
 
 	OpenClipboard(NULL);
 	EmptyClipboard();
 	SetClipboardData(CF_TEXT, hHandle);
 	CloseClipboard();
 }
+#endif
 
-std::string CUtil::guid_to_string(const GUID& guid)
+std::string CUtil::guid_to_string(const pe::Guid& guid)
 {
 	return std::format("{{{:08X}-{:04X}-{:04X}-{:02X}{:02X}-{:02X}{:02X}{:02X}{:02X}{:02X}{:02X}}}",
 					   guid.Data1, guid.Data2, guid.Data3,
 					   guid.Data4[0], guid.Data4[1], guid.Data4[2], guid.Data4[3],
 					   guid.Data4[4], guid.Data4[5], guid.Data4[6], guid.Data4[7]);
 }
+
+std::string CUtil::utf16_to_utf8(const uint8_t* data, size_t num_chars)
+{
+	auto char_at = [data](size_t i) { return (uint16_t)(data[i * 2] | (data[i * 2 + 1] << 8)); };
+
+	std::string utf8;
+	utf8.reserve(num_chars);
+
+	for (size_t i = 0; i < num_chars; i++)
+	{
+		uint32_t cp = char_at(i);
+
+		if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < num_chars && char_at(i + 1) >= 0xDC00 && char_at(i + 1) <= 0xDFFF)
+			cp = 0x10000 + ((cp - 0xD800) << 10) + (char_at(++i) - 0xDC00);
+		else if (cp >= 0xD800 && cp <= 0xDFFF)
+			cp = 0xFFFD;
+
+		if (cp < 0x80)
+		{
+			utf8.push_back((char)cp);
+		}
+		else if (cp < 0x800)
+		{
+			utf8.push_back((char)(0xC0 | (cp >> 6)));
+			utf8.push_back((char)(0x80 | (cp & 0x3F)));
+		}
+		else if (cp < 0x10000)
+		{
+			utf8.push_back((char)(0xE0 | (cp >> 12)));
+			utf8.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+			utf8.push_back((char)(0x80 | (cp & 0x3F)));
+		}
+		else
+		{
+			utf8.push_back((char)(0xF0 | (cp >> 18)));
+			utf8.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+			utf8.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+			utf8.push_back((char)(0x80 | (cp & 0x3F)));
+		}
+	}
+
+	return utf8;
+}
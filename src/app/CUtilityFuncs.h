@@ -41,11 +41,17 @@ public:
 	}
 
 public:
-	static std::string make_filesize_nice(uint32_t number);
+	static std::string make_filesize_nice(uint64_t number);
 
-	static void copy_to_clipboard(const std::string& str_to_copy);
+#ifdef _WIN32
+	static void copy_to_clipboard(std::string_view str_to_copy);
+#endif
 
-	static std::string guid_to_string(const GUID& guid);
+	static std::string guid_to_string(const pe::Guid& guid);
+
+	// Converts little-endian UTF-16 read straight out of an image, which doesn't have to be
+	// aligned. Unpaired surrogates are replaced by U+FFFD.
+	static std::string utf16_to_utf8(const uint8_t* data, size_t num_chars);
 
 };
 
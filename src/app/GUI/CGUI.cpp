@@ -33,7 +33,7 @@ bool CGUI::startup(GLFWwindow* glfw_window)
 	// Setup Dear ImGui context
 	if (!ImGui::CreateContext())
 	{
-		CDebugConsole::get().output_message("Failed to create ImGui context");
+		CDebugConsole::get().output_message<LogCategory::Gui>("Failed to create ImGui context");
 		return false;
 	}
 
@@ -49,7 +49,7 @@ bool CGUI::startup(GLFWwindow* glfw_window)
 
 	ImGui_ImplOpenGL2_Init();
 
-	CDebugConsole::get().output_message("Initialized GUI");
+	CDebugConsole::get().output_message<LogCategory::Gui>("Initialized GUI");
 
 	return true;
 }
@@ -234,7 +234,7 @@ float CGUIWidgets::apply_imgui_window_y_padding(float to)
 	return to - style.WindowPadding.y * 2.f;
 }
 
-bool CGUIWidgets::add_copyable_selectable(const std::string& label, const std::string& what_to_copy)
+bool CGUIWidgets::add_copyable_selectable(const std::string& label, std::string_view what_to_copy)
 {
 	bool selected = ImGui::Selectable(label.c_str(), false, ImGuiSelectableFlags_SpanAllColumns);
 
@@ -243,7 +243,7 @@ bool CGUIWidgets::add_copyable_selectable(const std::string& label, const std::s
 		{
 			if (ImGui::Selectable("Copy"))
 			{
-				CUtil::copy_to_clipboard(what_to_copy.empty() ? label : what_to_copy);
+				CUtil::copy_to_clipboard(what_to_copy.empty() ? std::string_view(label) : what_to_copy);
 				ImGui::CloseCurrentPopup();
 			}
 		},
@@ -153,7 +153,8 @@ public:
 	float apply_imgui_window_y_padding(float to);
 
 	// The text can be copied to clickboard on right click.
-	bool add_copyable_selectable(const std::string& label, const std::string& what_to_copy = "");
+	// If what_to_copy is empty, the label is copied instead.
+	bool add_copyable_selectable(const std::string& label, std::string_view what_to_copy = {});
 
 private:
 	bool m_entry_text_wrappable = true;
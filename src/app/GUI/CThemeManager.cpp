@@ -69,7 +69,7 @@ void CThemeManager::refresh_colors()
 
 	current.fill_imgui_colors();
 
-	CDebugConsole::get().output_message(std::format("Changed theme to {}", current.get_name()));
+	CDebugConsole::get().output_message<LogCategory::Gui>("Changed theme to {}", current.get_name());
 }
 
 AppTheme& CThemeManager::get_theme_object(Theme theme)
@@ -81,7 +81,7 @@ AppTheme& CThemeManager::get_theme_object(Theme theme)
 	}
 	catch (...)
 	{
-		CDebugConsole::get().output_error(std::format("Tried to obtain invalid theme: {}", (int)theme));
+		CDebugConsole::get().output_error("Tried to obtain invalid theme: {}", (int)theme);
 		CDebugConsole::get().output_error("Returned default theme...");
 	}
 
@@ -31,6 +31,11 @@
 
 #pragma once
 
+// Only the batch scanner is built where there's no Windows GUI.
+#if !defined(_WIN32) && !defined(EXEIN_HEADLESS)
+#define EXEIN_HEADLESS
+#endif
+
 //===========================================================================
 // 
 // Public header files
@@ -47,13 +52,48 @@
 #include <filesystem>
 #include <bitset>
 #include <array>
+#include <algorithm>
+#include <bit>
+#include <string_view>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <semaphore>
+#include <iomanip>
+#include <memory>
+#include <exception>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <optional>
+#include <memory_resource>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // Keeps std::min/std::max usable
+#endif
 #include <Windows.h>
-#include <delayimp.h>
-#include <WinTrust.h> // For certificate data
+#else
+#include <sys/mman.h> // For file mappings
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <immintrin.h> // For vectorized kernels
+#endif
 
 // Needs to be included at the beginning
+#include "util/UtilMpscRing.h"
 #include "CDebugConsole.h"
+#include "processors/PEFormat.h"
 #include "CUtilityFuncs.h"
+#include "CThreadPool.h"
 
 //===========================================================================
 // 
@@ -61,6 +101,7 @@
 // 
 //===========================================================================
 
+#ifndef EXEIN_HEADLESS
 #include "portable_file_dialogs/portable-file-dialogs.h"
 
 //===========================================================================
@@ -88,6 +129,7 @@
 //===========================================================================
 
 #include <SOIL/SOIL.h>
+#endif
 
 //===========================================================================
 // 
@@ -99,6 +141,14 @@
 #include "util/UtilNamedConstant.h"
 #include "util/UtilSmartValue.h"
 #include "util/UtilVector.h"
+#include "util/UtilCpuFeatures.h"
+#include "util/UtilStringScanner.h"
+#include "util/UtilChecksum.h"
+#include "util/UtilHash.h"
+#include "util/UtilEntropy.h"
+#include "util/UtilJsonWriter.h"
+#include "util/UtilBinaryStream.h"
+#include "util/UtilArena.h"
 
 //===========================================================================
 // 
@@ -106,7 +156,9 @@
 // 
 //===========================================================================
 
+#ifndef EXEIN_HEADLESS
 #include "assets/assets.h"
+#endif
 
 //===========================================================================
 // 
@@ -114,17 +166,25 @@
 // 
 //===========================================================================
 
+// Parse cache, used by the processors
+#include "CParseCache.h"
+
 // Processors
 #include "processors/IBaseProcessor.h"
 #include "processors/CX86PEProcessor.h"
 
 // GUI code
+#ifndef EXEIN_HEADLESS
 #include "GUI/CThemeManager.h"
 #include "GUI/CImGUIInternalLayer.h"
 #include "GUI/CGUIWidgets.h"
 #include "GUI/CGUI.h"
+#endif
 
 // Others
+#ifndef EXEIN_HEADLESS
 #include "CApplication.h"
+#endif
+#include "CBatchScanner.h"
 
 #endif
\ No newline at end of file
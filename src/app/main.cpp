@@ -28,8 +28,13 @@
 
 #include "exein_pch.h"
 
+#ifndef EXEIN_HEADLESS
 BOOL WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nShowCmd)
 {
+	// Batch scan without any window, e.g. "x86executable_inspector.exe --scan C:\Windows\System32"
+	if (__argc > 1 && !strcmp(__argv[1], "--scan"))
+		return CBatchScanner::get().run(__argc - 2, __argv + 2);
+
 	if (!CApplication::get().run())
 	{
 		CApplication::get().halt();
@@ -37,4 +42,14 @@ BOOL WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLin
 	}
 
 	return 0;
-}
\ No newline at end of file
+}
+#else
+int main(int argc, char** argv)
+{
+	// There's nothing else to do without a window, so --scan is optional here
+	if (argc > 1 && !strcmp(argv[1], "--scan"))
+		return CBatchScanner::get().run(argc - 2, argv + 2);
+
+	return CBatchScanner::get().run(argc - 1, argv + 1);
+}
+#endif
\ No newline at end of file
@@ -28,30 +28,172 @@
 
 #include "exein_pch.h"
 
+CX86PEProcessor::~CX86PEProcessor()
+{
+	request_cancel();
+
+	// Whatever went wrong while decoding, the tasks must not outlive the processor
+	try
+	{
+		CThreadPool::get().wait(m_decode_group);
+	}
+	catch (const std::exception& e)
+	{
+		CDebugConsole::get().output_error("Decoding failed: {}", e.what());
+	}
+}
+
 bool CX86PEProcessor::process(const std::filesystem::path& filepath)
 {
+	begin_progress(k_num_progress_steps);
+
 	if (!on_processing_start(filepath))
 		return false;
 
+	// A file that has been parsed before is restored from the parse cache, only the cheap
+	// headers are parsed again. The key hashes the whole file, which is still far cheaper
+	// than decoding it.
+	if (CParseCache::get().is_enabled())
+	{
+		m_cache_key = CParseCache::make_key(m_byte_buffer.get_raw(), m_byte_buffer.get_size());
+
+		if (CParseCache::get().load(m_cache_key, k_parse_cache_version, m_cache_entry))
+			CDebugConsole::get().output_message<LogCategory::Parser>("Found the file in the parse cache");
+	}
+
+	enter_progress_stage("DOS header");
+
 	if (!process_dos())
 		return false;
 
+	mark_ready(Stage::Dos);
+	complete_progress_steps();
+
 	if (!process_nt_headers())
 		return false;
 
-	process_image_strings();
+	m_cache_entry.close();
+
+	if (is_cancel_requested())
+	{
+		CDebugConsole::get().output_info<LogCategory::Parser>("Processing has been cancelled.");
+		return false;
+	}
 
 	on_processing_end();
 
 	return true;
 }
 
+void CX86PEProcessor::write_summary(JsonLineWriter& record) const
+{
+	record.add("machine", m_nt_machine.name());
+	record.add("subsystem", m_nt_subsystem.name());
+	record.add("timestamp", m_nt_time_date_stamp.as_integer());
+	record.add("image_base", m_img_base.val());
+	record.add("entry_point", m_entry_point_va.val());
+	record.add("sections", m_sections.size());
+
+	if (is_data_dir_ready(pe::k_directory_entry_export))
+		record.add("exports", m_image_exports.size());
+
+	if (is_data_dir_ready(pe::k_directory_entry_import))
+	{
+		size_t num_imports = 0;
+		for (const auto& descriptor : m_image_import_descriptors)
+			num_imports += descriptor.m_import_thunks.size();
+
+		record.add("import_modules", m_image_import_descriptors.size());
+		record.add("imports", num_imports);
+	}
+
+	if (is_data_dir_ready(pe::k_directory_entry_delay_import))
+	{
+		size_t num_delayed_imports = 0;
+		for (const auto& descriptor : m_image_delayed_import_descriptors)
+			num_delayed_imports += descriptor.m_import_thunks.size();
+
+		record.add("delayed_import_modules", m_image_delayed_import_descriptors.size());
+		record.add("delayed_imports", num_delayed_imports);
+	}
+
+	if (is_data_dir_ready(pe::k_directory_entry_security))
+		record.add("certificates", m_image_certificates.size());
+
+	if (is_data_dir_ready(pe::k_directory_entry_resource))
+	{
+		record.add("resources", m_image_resources.size());
+
+		// The only resource that gets decoded here
+		ImageVersionInfo version_info;
+		auto version = find_resource(pe::k_rt_version);
+
+		if (version && decode_version_info(*version, version_info) && !version_info.m_file_version.empty())
+		{
+			record.add("file_version", version_info.m_file_version);
+			record.add("product_version", version_info.m_product_version);
+		}
+	}
+
+	if (is_ready(Stage::Strings))
+		record.add("strings", m_image_strings.size());
+
+	record.add("overlay_size", m_overlay_size);
+	record.add("checksum", m_image_checksum_real.val());
+
+	if (!is_ready(Stage::Hashes))
+		return;
+
+	record.add("checksum_calc", m_image_checksum_calc.val());
+	record.add("md5", m_file_md5);
+	record.add("sha256", m_file_sha256);
+	record.add("authenticode_sha1", m_authenticode_sha1);
+	record.add("authenticode_sha256", m_authenticode_sha256);
+	record.add("imphash", m_import_hash);
+
+	// In the order of the image rather than of the map
+	std::vector<const ImageSection*> sections;
+	for (const auto& [name, section] : m_sections)
+		sections.push_back(&section);
+
+	std::sort(sections.begin(), sections.end(), [](const auto* a, const auto* b) { return a->m_va_base < b->m_va_base; });
+
+	record.begin_array("section_details");
+	for (const auto* section : sections)
+	{
+		record.begin_object();
+		record.add("name", section->m_name);
+		record.add("md5", section->m_md5);
+		record.add("sha256", section->m_sha256);
+		record.add("entropy", section->m_entropy);
+		record.add("max_window_entropy", section->m_max_window_entropy);
+		record.end_object();
+	}
+	record.end_array();
+}
+
+#ifndef EXEIN_HEADLESS
 void CX86PEProcessor::render_gui()
 {
 	ImGui::Columns(2, NULL, false);
 
 	ImGui::SetColumnWidth(0, gui_leftmost_column_size());
 
+	render_headers();
+
+	ImGui::NextColumn();
+
+	render_tabs();
+
+	ImGui::Columns(1);
+}
+
+// Headers show up one by one while the image is being processed
+void CX86PEProcessor::render_headers()
+{
+	if (!is_ready(Stage::Dos))
+		return;
+
 	CGUIWidgets::get().add_centered_text("DOS Header", CGUIWidgets::get().apply_imgui_window_x_padding(gui_leftmost_column_size()));
 	ImGui::BeginChild("DOS_Header_child", { 0, 90 }, true);
 	{
@@ -68,6 +210,9 @@ void CX86PEProcessor::render_gui()
 		ImGui::EndChild();
 	}
 
+	if (!is_ready(Stage::NtHeaders))
+		return;
+
 	CGUIWidgets::get().add_centered_text("NT headers", CGUIWidgets::get().apply_imgui_window_x_padding(gui_leftmost_column_size()));
 	ImGui::BeginChild("NT_headers_child", { 0.f, 380.f }, true);
 	{
@@ -111,7 +256,8 @@ void CX86PEProcessor::render_gui()
 				CGUIWidgets::get().add_double_entry("Size of image", m_size_of_image);
 				CGUIWidgets::get().add_double_entry("Size of headers", m_size_of_hdrs);
 
-				if (m_image_checksum_real != m_image_checksum_calc)
+				// The calculated one is known once the hashes have been decoded
+				if (is_ready(Stage::Hashes) && m_image_checksum_real != m_image_checksum_calc)
 					CGUIWidgets::get().add_double_entry_colored("Checksum (calc.)", std::format("{} ({})", m_image_checksum_real.as_string(), m_image_checksum_calc.as_string()), ImColor(230, 0, 0, 200));
 				else
 					CGUIWidgets::get().add_double_entry("Checksum", m_image_checksum_real);
@@ -168,12 +314,6 @@ void CX86PEProcessor::render_gui()
 
 		ImGui::EndChild();
 	}
-
-	ImGui::NextColumn();
-
-	render_tabs();
-
-	ImGui::Columns(1);
 }
 
 void CX86PEProcessor::render_tabs()
@@ -187,7 +327,9 @@ void CX86PEProcessor::render_tabs()
 	render_tab_sections();
 	render_tab_exports();
 	render_tab_imports();
+	render_tab_resources();
 	render_tab_certificates();
+	render_tab_hashes();
 	render_tab_relocations();
 	render_tab_debug();
 	render_tab_load_cfg();
@@ -201,13 +343,16 @@ void CX86PEProcessor::render_tab_sections()
 {
 	render_content_tab(
 		"Sections",
-		true, // Assume that we have at least one section
+		is_ready(Stage::Sections),
 		[&]()
 		{
+			// Entropy is decoded together with the hashes, the columns fill in once it has been
+			bool has_entropy = request_stage(Stage::Hashes);
+
 			ImGui::BeginChild("Sections_child_low", { 0, 0 }, false, ImGuiWindowFlags_HorizontalScrollbar);
 			{
 				CGUIWidgets::get().add_table(
-					"Exports_child_up_table", 7,
+					"Exports_child_up_table", 9,
 					ImGuiTableFlags_BordersOuter | ImGuiTableFlags_SizingStretchSame,
 					[&]()
 					{
@@ -218,6 +363,8 @@ void CX86PEProcessor::render_tab_sections()
 						CGUIWidgets::get().table_setup_column("Raw data RVA");
 						CGUIWidgets::get().table_setup_column("Raw size");
 						CGUIWidgets::get().table_setup_column("Zero padding");
+						CGUIWidgets::get().table_setup_column("Entropy");
+						CGUIWidgets::get().table_setup_column("Max window entropy");
 
 						ImGui::TableHeadersRow();
 					},
@@ -232,6 +379,26 @@ void CX86PEProcessor::render_tab_sections()
 							ImGui::TableNextColumn(); ImGui::TextUnformatted(sec.m_raw_data_ptr.as_string().c_str());
 							ImGui::TableNextColumn(); ImGui::TextUnformatted(sec.m_raw_data_size.as_string().c_str());
 							ImGui::TableNextColumn(); ImGui::TextUnformatted(sec.m_zero_padding.as_string().c_str());
+
+							if (!has_entropy)
+							{
+								ImGui::TableNextColumn(); ImGui::TextUnformatted("...");
+								ImGui::TableNextColumn(); ImGui::TextUnformatted("...");
+								continue;
+							}
+
+							ImGui::TableNextColumn(); ImGui::TextUnformatted(std::format("{:.3f}", sec.m_entropy).c_str());
+							ImGui::TableNextColumn(); ImGui::TextUnformatted(std::format("{:.3f}", sec.m_max_window_entropy).c_str());
+
+							// Entropy along the section
+							if (ImGui::IsItemHovered() && !sec.m_window_entropies.empty())
+							{
+								ImGui::BeginTooltip();
+								ImGui::PlotLines("##window_entropy", sec.m_window_entropies.data(), (int)sec.m_window_entropies.size(),
+												 0, std::format("{} windows of {} bytes", sec.m_window_entropies.size(), EntropyMeter::k_window_size).c_str(),
+												 0.f, 8.f, { 400.f, 100.f });
+								ImGui::EndTooltip();
+							}
 						}
 					});
 			}
@@ -244,7 +411,8 @@ void CX86PEProcessor::render_tab_exports()
 {
 	render_content_tab(
 		"Exports",
-		m_data_dirs[IMAGE_DIRECTORY_ENTRY_EXPORT].is_present(),
+		data_dir_exists(pe::k_directory_entry_export),
+		[&]() { return request_data_dir(pe::k_directory_entry_export); },
 		[&]()
 		{
 			ImGui::BeginChild("Exports_child_up", { 0, 70.f });
@@ -294,7 +462,7 @@ void CX86PEProcessor::render_tab_exports()
 					if (colorize_function)
 						ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertU32ToFloat4(ImColor(230, 50, 50, 230)));
 
-					CGUIWidgets::get().add_copyable_selectable(exp.m_name.c_str());
+					CGUIWidgets::get().add_copyable_selectable(exp.m_name.data());
 
 					if (colorize_function)
 						ImGui::PopStyleColor();
@@ -325,7 +493,15 @@ void CX86PEProcessor::render_tab_imports()
 {
 	render_content_tab(
 		"Imports",
-		true,
+		data_dir_exists(pe::k_directory_entry_import) || data_dir_exists(pe::k_directory_entry_delay_import),
+		[&]()
+		{
+			// The IAT is named after both of the import directories, it's decoded last
+			bool imports = request_data_dir(pe::k_directory_entry_import);
+			bool delayed_imports = request_data_dir(pe::k_directory_entry_delay_import);
+
+			return request_data_dir(pe::k_directory_entry_iat) && imports && delayed_imports;
+		},
 		[&]()
 		{
 			auto render_imports_tab_contents = [&](bool delayed)
@@ -360,7 +536,7 @@ void CX86PEProcessor::render_tab_imports()
 
 							for (const auto& thunk : imp.m_import_thunks)
 							{
-								CGUIWidgets::get().add_copyable_selectable(thunk.imported_by_name() ? thunk.m_name.c_str() : std::format("{}", thunk.m_ordinal.val()).c_str());
+								CGUIWidgets::get().add_copyable_selectable(thunk.imported_by_name() ? thunk.m_name.data() : std::format("{}", thunk.m_ordinal.val()).c_str());
 
 								// Render tooltip on hover
 								if (!ImGui::IsItemHovered())
@@ -399,7 +575,7 @@ void CX86PEProcessor::render_tab_imports()
 
 							for (const auto& thunk : imp.m_import_thunks)
 							{
-								CGUIWidgets::get().add_copyable_selectable(thunk.imported_by_name() ? thunk.m_name.c_str() : thunk.m_ordinal.as_string().c_str());
+								CGUIWidgets::get().add_copyable_selectable(thunk.imported_by_name() ? thunk.m_name.data() : thunk.m_ordinal.as_string().c_str());
 
 								// Render tooltip on hover
 								if (!ImGui::IsItemHovered())
@@ -454,14 +630,14 @@ void CX86PEProcessor::render_tab_imports()
 
 			if (render_delayed_imports)
 			{
-				if (m_data_dirs[IMAGE_DIRECTORY_ENTRY_DELAY_IMPORT].is_present())
+				if (is_data_dir_present(pe::k_directory_entry_delay_import))
 					render_imports_tab_contents(true);
 				else
 					CGUIWidgets::get().add_window_centered_disabled_text("No data");
 			}
 			else
 			{
-				if (m_data_dirs[IMAGE_DIRECTORY_ENTRY_IMPORT].is_present())
+				if (is_data_dir_present(pe::k_directory_entry_import))
 					render_imports_tab_contents(false);
 				else
 					CGUIWidgets::get().add_window_centered_disabled_text("No data");
@@ -469,11 +645,136 @@ void CX86PEProcessor::render_tab_imports()
 		});
 }
 
+void CX86PEProcessor::render_tab_resources()
+{
+	render_content_tab(
+		"Resources",
+		data_dir_exists(pe::k_directory_entry_resource),
+		[&]() { return request_data_dir(pe::k_directory_entry_resource); },
+		[&]()
+		{
+			CGUIWidgets::get().add_undecorated_simple_table(
+				"Resources_summary_table", 2,
+				[&]()
+				{
+					CGUIWidgets::get().add_double_entry_dec("Resources", m_image_resources.size());
+					CGUIWidgets::get().add_double_entry_dec("Types", m_number_of_resource_types);
+				});
+
+			ImGui::Separator();
+
+			ImGui::BeginChild("Resources_child_list", { 0, ImGui::GetContentRegionAvail().y * 0.6f }, false, ImGuiWindowFlags_HorizontalScrollbar);
+			{
+				CGUIWidgets::get().add_table(
+					"Resources_table", 6,
+					ImGuiTableFlags_ScrollY | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_SizingFixedFit,
+					[&]()
+					{
+						CGUIWidgets::get().table_setup_column("Type");
+						CGUIWidgets::get().table_setup_column("Name");
+						CGUIWidgets::get().table_setup_column("Language");
+						CGUIWidgets::get().table_setup_column("RVA");
+						CGUIWidgets::get().table_setup_column("Size");
+						CGUIWidgets::get().table_setup_column("Codepage");
+						ImGui::TableSetupScrollFreeze(0, 1);
+
+						ImGui::TableHeadersRow();
+					},
+					[&]()
+					{
+						// Names are decoded only for the rows in the view
+						ImGuiListClipper clipper;
+						clipper.Begin(m_image_resources.size());
+						while (clipper.Step())
+						{
+							for (int32_t i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+							{
+								const auto& resource = m_image_resources[i];
+								auto type_name = resource.m_type <= 0xFFFF ? ImageResource::type_name(resource.m_type) : nullptr;
+
+								ImGui::TableNextColumn();
+								if (ImGui::Selectable(std::format("{}##resource_{}", type_name ? type_name : resource_entry_name(resource.m_type), i).c_str(),
+													  m_gui_selected_resource == (size_t)i, ImGuiSelectableFlags_SpanAllColumns))
+								{
+									m_gui_selected_resource = i;
+									m_gui_resource_preview = make_resource_preview(resource);
+								}
+
+								ImGui::TableNextColumn(); ImGui::TextUnformatted(resource_entry_name(resource.m_name).c_str());
+								ImGui::TableNextColumn(); ImGui::TextUnformatted(resource.m_language.as_string().c_str());
+								ImGui::TableNextColumn(); ImGui::TextUnformatted(resource.m_data_rva.as_string().c_str());
+								ImGui::TableNextColumn(); ImGui::TextUnformatted(resource.m_size.as_string().c_str());
+								ImGui::TableNextColumn(); ImGui::TextUnformatted(resource.m_codepage.as_string().c_str());
+							}
+						}
+					});
+			}
+			ImGui::EndChild();
+
+			ImGui::Separator();
+
+			ImGui::BeginChild("Resources_child_preview", { 0, 0 }, false, ImGuiWindowFlags_HorizontalScrollbar);
+			{
+				if (m_gui_selected_resource < m_image_resources.size())
+					ImGui::TextUnformatted(m_gui_resource_preview.c_str(), m_gui_resource_preview.c_str() + m_gui_resource_preview.size());
+				else
+					CGUIWidgets::get().add_window_centered_disabled_text("Pick a resource to see its contents");
+			}
+			ImGui::EndChild();
+		});
+}
+
+// Only ever called for the resource that has just been picked
+std::string CX86PEProcessor::make_resource_preview(const ImageResource& resource) const
+{
+	static constexpr size_t k_max_preview_size = 64 * 1024, k_max_hex_dump_size = 1024;
+
+	auto data = resource_data(resource);
+
+	if (data.empty())
+		return resource.m_size ? "Data of this resource isn't inside of the image." : "Empty resource.";
+
+	if (resource.is_type(pe::k_rt_version))
+	{
+		ImageVersionInfo info;
+		if (decode_version_info(resource, info))
+		{
+			std::string preview = std::format("File version: {}\nProduct version: {}\n\n", info.m_file_version, info.m_product_version);
+
+			for (const auto& [key, value] : info.m_strings)
+				preview.append(std::format("{}: {}\n", key, value));
+
+			return preview;
+		}
+	}
+
+	// Text as it is
+	if (resource.is_type(pe::k_rt_manifest) || resource.is_type(pe::k_rt_html))
+		return std::string(data.substr(0, k_max_preview_size));
+
+	std::string preview;
+	for (size_t off = 0; off < std::min(data.size(), k_max_hex_dump_size); off += 16)
+	{
+		preview.append(std::format("{:04X}: ", off));
+
+		for (size_t i = off; i < std::min(off + 16, data.size()); i++)
+			preview.append(std::format("{:02X} ", (uint8_t)data[i]));
+
+		preview.push_back('\n');
+	}
+
+	if (data.size() > k_max_hex_dump_size)
+		preview.append(std::format("... {} more bytes", data.size() - k_max_hex_dump_size));
+
+	return preview;
+}
+
 void CX86PEProcessor::render_tab_certificates()
 {
 	render_content_tab(
 		"Certificates",
-		m_data_dirs[IMAGE_DIRECTORY_ENTRY_SECURITY].is_present(),
+		data_dir_exists(pe::k_directory_entry_security),
+		[&]() { return request_data_dir(pe::k_directory_entry_security); },
 		[&]()
 		{
 			uint32_t n = 0;
@@ -499,14 +800,77 @@ void CX86PEProcessor::render_tab_certificates()
 		});
 }
 
+void CX86PEProcessor::render_tab_hashes()
+{
+	render_content_tab(
+		"Hashes",
+		is_ready(Stage::NtHeaders),
+		[&]() { return request_stage(Stage::Hashes); },
+		[&]()
+		{
+			CGUIWidgets::get().add_centered_text("File", CGUIWidgets::get().apply_imgui_window_x_padding(ImGui::GetColumnWidth(1)));
+
+			ImGui::BeginChild("Hashes_child_file", { 0, 75.f }, true);
+			{
+				CGUIWidgets::get().add_undecorated_simple_table(
+					"Hashes_child_file_table", 2,
+					[&]()
+					{
+						CGUIWidgets::get().add_double_entry("MD5", m_file_md5);
+						CGUIWidgets::get().add_double_entry("SHA-256", m_file_sha256);
+						CGUIWidgets::get().add_double_entry("Import hash", m_import_hash.empty() ? "none" : m_import_hash);
+					});
+			}
+			ImGui::EndChild();
+
+			CGUIWidgets::get().add_centered_text("Authenticode", CGUIWidgets::get().apply_imgui_window_x_padding(ImGui::GetColumnWidth(1)));
+
+			ImGui::BeginChild("Hashes_child_authenticode", { 0, 55.f }, true);
+			{
+				CGUIWidgets::get().add_undecorated_simple_table(
+					"Hashes_child_authenticode_table", 2,
+					[&]()
+					{
+						CGUIWidgets::get().add_double_entry("SHA-1", m_authenticode_sha1);
+						CGUIWidgets::get().add_double_entry("SHA-256", m_authenticode_sha256);
+					});
+			}
+			ImGui::EndChild();
+
+			CGUIWidgets::get().add_centered_text("Sections", CGUIWidgets::get().apply_imgui_window_x_padding(ImGui::GetColumnWidth(1)));
+
+			CGUIWidgets::get().add_table(
+				"Hashes_sections_table", 3,
+				ImGuiTableFlags_BordersOuter | ImGuiTableFlags_SizingFixedFit,
+				[&]()
+				{
+					CGUIWidgets::get().table_setup_column("Name");
+					CGUIWidgets::get().table_setup_column("MD5");
+					CGUIWidgets::get().table_setup_column("SHA-256");
+
+					ImGui::TableHeadersRow();
+				},
+				[&]()
+				{
+					for (const auto& [key, sec] : m_sections)
+					{
+						ImGui::TableNextColumn(); ImGui::TextUnformatted(sec.m_name.c_str());
+						ImGui::TableNextColumn(); ImGui::TextUnformatted(sec.m_md5.c_str());
+						ImGui::TableNextColumn(); ImGui::TextUnformatted(sec.m_sha256.c_str());
+					}
+				});
+		});
+}
+
 void CX86PEProcessor::render_tab_relocations()
 {
 	render_content_tab(
 		"Relocations",
-		m_data_dirs[IMAGE_DIRECTORY_ENTRY_BASERELOC].is_present(),
+		data_dir_exists(pe::k_directory_entry_basereloc),
+		[&]() { return request_data_dir(pe::k_directory_entry_basereloc); },
 		[&]()
 		{
-			uint32_t reloc_num = 0, blockinfo_num = 0;
+			uint32_t reloc_num = 0;
 			for (const auto& reloc : m_relocation_blocks)
 			{
 				CGUIWidgets::get().add_undecorated_simple_table(
@@ -517,25 +881,43 @@ void CX86PEProcessor::render_tab_relocations()
 						CGUIWidgets::get().add_double_entry("Size", reloc.m_size);
 					});
 
-				if (!reloc.m_block_info_entries.empty())
+				if (reloc.num_entries())
 				{
-					if (ImGui::TreeNodeEx(std::format("Block info entries ({})", reloc.m_block_info_entries.size()).c_str(),
+					if (ImGui::TreeNodeEx(std::format("Block info entries ({})##{}", reloc.num_entries(), reloc_num).c_str(),
 										  ImGuiTreeNodeFlags_SpanFullWidth))
 					{
-						for (const auto& info : reloc.m_block_info_entries)
-						{
-							CGUIWidgets::get().add_section_separator(std::format("Block info #{}", blockinfo_num));
+						CGUIWidgets::get().add_table(
+							"Relocations_entries_table", 3,
+							ImGuiTableFlags_BordersOuter | ImGuiTableFlags_SizingFixedFit,
+							[&]()
+							{
+								CGUIWidgets::get().table_setup_column("#");
+								CGUIWidgets::get().table_setup_column("Type");
+								CGUIWidgets::get().table_setup_column("Offset");
 
-							CGUIWidgets::get().add_undecorated_simple_table(
-								"Relocations_table1", 2,
-								[&]()
+								ImGui::TableHeadersRow();
+							},
+							[&]()
+							{
+								ImGuiListClipper clipper;
+								clipper.Begin(reloc.num_entries());
+								while (clipper.Step())
 								{
-									CGUIWidgets::get().add_double_entry("Type", info.m_type.name());
-									CGUIWidgets::get().add_double_entry("Offset", info.m_offset);
-								});
+									for (int32_t i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+									{
+										auto type_name = ImageRelocationBlock::type_name(reloc.m_types[i]);
 
-							blockinfo_num++;
-						}
+										ImGui::TableNextColumn(); ImGui::Text("%d", i);
+										ImGui::TableNextColumn();
+										if (type_name)
+											ImGui::TextUnformatted(type_name);
+										else
+											ImGui::Text("0x%X", reloc.m_types[i]);
+
+										ImGui::TableNextColumn(); ImGui::Text("0x%03X", reloc.m_offsets[i]);
+									}
+								}
+							});
 
 						ImGui::TreePop();
 					}
@@ -556,7 +938,8 @@ void CX86PEProcessor::render_tab_debug()
 {
 	render_content_tab(
 		"Debug",
-		m_data_dirs[IMAGE_DIRECTORY_ENTRY_DEBUG].is_present(),
+		data_dir_exists(pe::k_directory_entry_debug),
+		[&]() { return request_data_dir(pe::k_directory_entry_debug); },
 		[&]()
 		{
 			uint32_t num_debug_dirs = 0;
@@ -585,7 +968,7 @@ void CX86PEProcessor::render_tab_debug()
 						[&]()
 						{
 							// Now look for all possible debug directory types
-							if (debug.m_type.is(IMAGE_DEBUG_TYPE_CODEVIEW))
+							if (debug.m_type.is(pe::k_debug_type_codeview))
 							{
 								const auto& cv = debug.m_cv;
 								const auto& sig = cv.m_magic_signature;
@@ -629,7 +1012,8 @@ void CX86PEProcessor::render_tab_load_cfg()
 {
 	render_content_tab(
 		"Load CFG",
-		m_data_dirs[IMAGE_DIRECTORY_ENTRY_LOAD_CONFIG].is_present(),
+		data_dir_exists(pe::k_directory_entry_load_config),
+		[&]() { return request_data_dir(pe::k_directory_entry_load_config); },
 		[&]()
 		{
 			CGUIWidgets::get().add_undecorated_simple_table(
@@ -731,7 +1115,8 @@ void CX86PEProcessor::render_tab_strings()
 {
 	render_content_tab(
 		"Strings",
-		!m_image_strings.empty(),
+		is_ready(Stage::NtHeaders),
+		[&]() { return request_stage(Stage::Strings); },
 		[&]()
 		{
 			// We use clipping in order to just process what is in the view however, 
@@ -778,8 +1163,8 @@ void CX86PEProcessor::render_tab_strings()
 						const auto render_string_column = [](const ImageString& str)
 						{
 							ImGui::TableNextColumn(); CGUIWidgets::get().add_copyable_selectable(str.m_va.as_string().c_str(), str.m_string);
-							ImGui::TableNextColumn(); ImGui::TextUnformatted(str.m_parent_sec_name.c_str());
-							ImGui::TableNextColumn(); ImGui::TextUnformatted(str.m_string.c_str());
+							ImGui::TableNextColumn(); ImGui::TextUnformatted(str.m_parent_sec_name.data());
+							ImGui::TableNextColumn(); ImGui::TextUnformatted(str.m_string.data(), str.m_string.data() + str.m_string.size());
 						};
 
 						// If the user wants to search through the list of strings, we have to disable
@@ -788,7 +1173,7 @@ void CX86PEProcessor::render_tab_strings()
 						{
 							for (const auto& str : m_image_strings)
 							{
-								if (!filter.PassFilter(str.m_string.c_str()))
+								if (!filter.PassFilter(str.m_string.data(), str.m_string.data() + str.m_string.size()))
 									continue;
 
 								render_string_column(str);
@@ -818,7 +1203,12 @@ void CX86PEProcessor::render_tab_misc()
 {
 	render_content_tab(
 		"Misc",
-		true, // Always exist
+		is_ready(Stage::NtHeaders), // Always exists
+		[&]()
+		{
+			bool tls = request_data_dir(pe::k_directory_entry_tls);
+			return request_data_dir(pe::k_directory_entry_globalptr) && tls;
+		},
 		[&]()
 		{
 			CGUIWidgets::get().add_centered_text("TLS data", CGUIWidgets::get().apply_imgui_window_x_padding(ImGui::GetColumnWidth(1)));
@@ -884,6 +1274,26 @@ void CX86PEProcessor::render_tab_misc()
 				}
 			}
 			ImGui::EndChild();
+
+			CGUIWidgets::get().add_centered_text("Overlay", CGUIWidgets::get().apply_imgui_window_x_padding(ImGui::GetColumnWidth(1)));
+			ImGui::BeginChild("Misc_child_overlay", { 0, 60 }, true, ImGuiWindowFlags_HorizontalScrollbar);
+			{
+				if (m_overlay_size)
+				{
+					CGUIWidgets::get().add_undecorated_simple_table(
+						"Misc_child_overlay_table", 2,
+						[&]()
+						{
+							CGUIWidgets::get().add_double_entry("File offset", std::format("0x{:X}", m_overlay_offset));
+							CGUIWidgets::get().add_double_entry("Size", CUtil::make_filesize_nice(m_overlay_size));
+						});
+				}
+				else
+				{
+					CGUIWidgets::get().add_window_centered_disabled_text("No data");
+				}
+			}
+			ImGui::EndChild();
 		});
 }
 
@@ -903,6 +1313,20 @@ void CX86PEProcessor::render_content_tab(const std::string& label, bool does_exi
 	}
 }
 
+void CX86PEProcessor::render_content_tab(const std::string& label, bool does_exist, const std::function<bool()>& pfn_request, const std::function<void()>& pfn_contents)
+{
+	render_content_tab(
+		label,
+		does_exist,
+		[&]()
+		{
+			if (pfn_request())
+				pfn_contents();
+			else
+				CGUIWidgets::get().add_window_centered_disabled_text("Decoding...");
+		});
+}
+
 template<typename T>
 void CX86PEProcessor::render_named_bitfield_constant_generic(const T& flags, const std::string& label, const char* child, uint32_t& active_flags_static)
 {
@@ -929,9 +1353,17 @@ void CX86PEProcessor::render_named_bitfield_constant_generic(const T& flags, con
 		});
 }
 
+#endif // EXEIN_HEADLESS
+
 bool CX86PEProcessor::process_dos()
 {
-	auto pdos_hdr = m_byte_buffer.get_at<IMAGE_DOS_HEADER>(0);
+	auto pdos_hdr = m_byte_buffer.get_at<pe::ImageDosHeader>(0);
+
+	if (!pdos_hdr)
+	{
+		CDebugConsole::get().output_error("File is too small to hold a DOS header.");
+		return false;
+	}
 
 	if (!process_dos_magic(pdos_hdr->e_magic))
 		return false;
@@ -941,22 +1373,22 @@ bool CX86PEProcessor::process_dos()
 	// Size of DOS header including the stub
 	m_dos_headers_size = pdos_hdr->e_lfanew;
 
-	if (!m_dos_headers_size || m_dos_headers_size < sizeof(IMAGE_DOS_HEADER))
+	if (!m_dos_headers_size || m_dos_headers_size < (int32_t)sizeof(pe::ImageDosHeader))
 	{
-		CDebugConsole::get().output_message(std::format("Invalid PE header offset: {}", m_dos_headers_size.val()));
+		CDebugConsole::get().output_message<LogCategory::Parser>("Invalid PE header offset: {}", m_dos_headers_size.val());
 		return false;
 	}
 
 	// Offset of dos stub is right after the header
-	uint32_t dos_hdr_size = sizeof(IMAGE_DOS_HEADER);
-	CDebugConsole::get().output_message(std::format("Sizeof DOS header: {} bytes", dos_hdr_size));
+	uint32_t dos_hdr_size = sizeof(pe::ImageDosHeader);
+	CDebugConsole::get().output_message<LogCategory::Parser>("Sizeof DOS header: {} bytes", dos_hdr_size);
 
-	uint32_t dos_stub_size = m_dos_headers_size - sizeof(IMAGE_DOS_HEADER);
-	CDebugConsole::get().output_message(std::format("Sizeof DOS stub: {} bytes", dos_stub_size));
+	uint32_t dos_stub_size = m_dos_headers_size - sizeof(pe::ImageDosHeader);
+	CDebugConsole::get().output_message<LogCategory::Parser>("Sizeof DOS stub: {} bytes", dos_stub_size);
 
 	process_dos_stub(dos_hdr_size, dos_stub_size);
 
-	CDebugConsole::get().output_message("DOS header processed");
+	CDebugConsole::get().output_message<LogCategory::Parser>("DOS header processed");
 
 	return true;
 }
@@ -967,67 +1399,106 @@ bool CX86PEProcessor::process_dos_magic(uint16_t magic)
 
 	switch (magic)
 	{
-		case IMAGE_DOS_SIGNATURE:
-			m_dos_magic = { IMAGE_DOS_SIGNATURE, "MZ" };
+		case pe::k_dos_signature:
+			m_dos_magic = { pe::k_dos_signature, "MZ" };
 			break;
-		case IMAGE_OS2_SIGNATURE:
-			m_dos_magic = { IMAGE_OS2_SIGNATURE, "NE" };
+		case pe::k_os2_signature:
+			m_dos_magic = { pe::k_os2_signature, "NE" };
 			break;
-		case IMAGE_OS2_SIGNATURE_LE:
-			m_dos_magic = { IMAGE_OS2_SIGNATURE_LE, "LE" };
+		case pe::k_os2_signature_le:
+			m_dos_magic = { pe::k_os2_signature_le, "LE" };
 			break;
 		default:
 			m_dos_magic = { magic, std::format("0x{:04X}", magic) };
-			CDebugConsole::get().output_error(std::format("Unknown DOS magic: {}", m_dos_magic.name()));
+			CDebugConsole::get().output_error("Unknown DOS magic: {}", m_dos_magic.name());
 			return false;
 	}
 
-	CDebugConsole::get().output_message(std::format("DOS header: {}", m_dos_magic.name()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("DOS header: {}", m_dos_magic.name());
 	return true;
 }
 
 void CX86PEProcessor::process_dos_stub(uint32_t off, uint32_t size)
 {
-	if (!m_dos_stub_byte_buffer.create(m_byte_buffer.get_raw() + off, size))
+	auto stub = m_byte_buffer.get_array_at<uint8_t>(off, size);
+
+	if (!stub || !m_dos_stub_byte_buffer.create(stub, size))
 		return;
 
 	m_dos_stub_size = m_dos_stub_byte_buffer.get_size();
 
-	CDebugConsole::get().output_message("DOS stub bytes: ");
-	CDebugConsole::get().output_message("", false);
-	CDebugConsole::get().push_no_timestamp();
+	// The dump is only built when somebody is going to read it
+	if (!CDebugConsole::get().is_enabled<LogLevel::Verbose, LogCategory::Parser>())
+		return;
+
+	std::string stub_bytes;
+	stub_bytes.reserve(m_dos_stub_size * 3);
 
 	for (uint32_t i = 0; i < m_dos_stub_size; i++)
 	{
 		uint8_t byte = *m_dos_stub_byte_buffer.get_at<uint8_t>(i);
 
-		CDebugConsole::get().output_message(std::format("{:02X} ", byte), false);
+		std::format_to(std::back_inserter(stub_bytes), "{:02X} ", byte);
 	}
 
-	CDebugConsole::get().output_newline();
-	CDebugConsole::get().pop_no_timestamp();
+	CDebugConsole::get().output_verbose<LogCategory::Parser>("DOS stub bytes: {}", stub_bytes);
 }
 
 bool CX86PEProcessor::process_nt_headers()
 {
-	auto pnt_hdrs = m_byte_buffer.get_at<IMAGE_NT_HEADERS>(m_dos_headers_size);
+	// Up to the magic, both of the layouts are the same
+	auto pnt_hdrs = m_byte_buffer.get_at<pe::ImageNtHeaders32>(m_dos_headers_size);
+
+	if (!pnt_hdrs)
+	{
+		CDebugConsole::get().output_error("NT headers don't fit into the file.");
+		return false;
+	}
 
 	if (!process_nt_sig(pnt_hdrs->Signature))
 		return false;
 
-	// File header
-	if (!process_nt_file_hdr(&pnt_hdrs->FileHeader))
+	if (!process_nt_magic(pnt_hdrs->OptionalHeader.Magic))
 		return false;
 
-	// Optional header
-	if (!process_nt_opt_hdr(&pnt_hdrs->OptionalHeader))
+	bool processed;
+
+	if (is_pe32_plus())
+	{
+		auto pnt_hdrs64 = m_byte_buffer.get_at<pe::ImageNtHeaders64>(m_dos_headers_size);
+
+		if (!pnt_hdrs64)
+		{
+			CDebugConsole::get().output_error("NT headers don't fit into the file.");
+			return false;
+		}
+
+		processed = process_nt_headers<pe::Pe64Traits>(pnt_hdrs64);
+	}
+	else
+	{
+		processed = process_nt_headers<pe::Pe32Traits>(pnt_hdrs);
+	}
+
+	if (!processed)
 		return false;
 
-	CDebugConsole::get().output_message("NT headers processed");
+	CDebugConsole::get().output_message<LogCategory::Parser>("NT headers processed");
 
 	return true;
 }
 
+template<typename Traits>
+bool CX86PEProcessor::process_nt_headers(const typename Traits::NtHeaders* pnt_hdrs)
+{
+	// File header
+	if (!process_nt_file_hdr<Traits>(&pnt_hdrs->FileHeader))
+		return false;
+
+	// Optional header
+	return process_nt_opt_hdr<Traits>(&pnt_hdrs->OptionalHeader);
+}
+
 bool CX86PEProcessor::process_nt_sig(uint32_t sig)
 {
 	// AFAIK, all signatures we are aware of are 16-bit wide.
@@ -1035,39 +1506,40 @@ bool CX86PEProcessor::process_nt_sig(uint32_t sig)
 
 	switch (realsig)
 	{
-		case IMAGE_DOS_SIGNATURE: // TODO
+		case pe::k_dos_signature: // TODO
 			CDebugConsole::get().output_error("Unable to process IMAGE_DOS_SIGNATURE-type images YET.");
 			return false;
-		case IMAGE_OS2_SIGNATURE: // TODO
+		case pe::k_os2_signature: // TODO
 			CDebugConsole::get().output_error("Unable to process IMAGE_OS2_SIGNATURE-type images YET.");
 			return false;
-		case IMAGE_OS2_SIGNATURE_LE: // Or IMAGE_VXD_SIGNATURE, TODO
+		case pe::k_os2_signature_le: // Or IMAGE_VXD_SIGNATURE, TODO
 			CDebugConsole::get().output_error("Unable to process IMAGE_OS2_SIGNATURE_LE-type images YET.");
 			return false;
-		case IMAGE_NT_SIGNATURE:
-			m_nt_sig = { IMAGE_NT_SIGNATURE, "PE00" };
+		case pe::k_nt_signature:
+			m_nt_sig = { pe::k_nt_signature, "PE00" };
 			break;
 		default:
 			m_nt_sig = { realsig, std::format("0x{:04X}", realsig) };
-			CDebugConsole::get().output_message(std::format("Invalid NT signature: 0x{:08X}", realsig));
+			CDebugConsole::get().output_message<LogCategory::Parser>("Invalid NT signature: 0x{:08X}", realsig);
 			return false;
 	}
 
-	m_nt_sig = { IMAGE_NT_SIGNATURE, "PE00" };
-	CDebugConsole::get().output_message(std::format("NT signature: {}", m_nt_sig.name()));
+	m_nt_sig = { pe::k_nt_signature, "PE00" };
+	CDebugConsole::get().output_message<LogCategory::Parser>("NT signature: {}", m_nt_sig.name());
 
 	return true;
 }
 
 // https://docs.microsoft.com/en-us/windows/win32/debug/pe-format#coff-file-header-object-and-image
-bool CX86PEProcessor::process_nt_file_hdr(const IMAGE_FILE_HEADER* pfile_hdr)
+template<typename Traits>
+bool CX86PEProcessor::process_nt_file_hdr(const pe::ImageFileHeader* pfile_hdr)
 {
 	// We won't fail on this if it's unrecognized
 	process_nt_machine(pfile_hdr->Machine);
 
-	if (!m_nt_machine.is(IMAGE_FILE_MACHINE_I386))
+	if (!m_nt_machine.is(Traits::k_machine))
 	{
-		CDebugConsole::get().output_error("We can process only 32-bit images.");
+		CDebugConsole::get().output_error("We can process only I386 PE32 and AMD64 PE32+ images. machine={} magic={}", m_nt_machine.name(), m_nt_magic.name());
 		return false;
 	}
 
@@ -1075,67 +1547,67 @@ bool CX86PEProcessor::process_nt_file_hdr(const IMAGE_FILE_HEADER* pfile_hdr)
 
 	if (m_num_sections >= max_number_of_sections())
 	{
-		CDebugConsole::get().output_error(std::format("Number of sections exceeds the limit! sec={} limit{}", m_num_sections, max_number_of_sections()));
+		CDebugConsole::get().output_error("Number of sections exceeds the limit! sec={} limit{}", m_num_sections, max_number_of_sections());
 		return false;
 	}
 
 	m_nt_time_date_stamp = pfile_hdr->TimeDateStamp;
 
 	if (!m_nt_time_date_stamp.is_valid())
-		CDebugConsole::get().output_info("Got null NT file header creation timestamp");
+		CDebugConsole::get().output_info<LogCategory::Parser>("Got null NT file header creation timestamp");
 
 	// These should be zero according to msdn
 	if (pfile_hdr->NumberOfSymbols != NULL || pfile_hdr->PointerToSymbolTable != NULL)
-		CDebugConsole::get().output_info("Warning, symbol fields inside file header aren't NULL.");
+		CDebugConsole::get().output_info<LogCategory::Parser>("Warning, symbol fields inside file header aren't NULL.");
 
 	// This is critical and must match with our version
-	if (pfile_hdr->SizeOfOptionalHeader != sizeof(IMAGE_OPTIONAL_HEADER))
+	if (pfile_hdr->SizeOfOptionalHeader != sizeof(typename Traits::OptionalHeader))
 	{
-		CDebugConsole::get().output_error(std::format("Mismatch in size of optional header: our={} img={}", sizeof(IMAGE_OPTIONAL_HEADER), pfile_hdr->SizeOfOptionalHeader));
+		CDebugConsole::get().output_error("Mismatch in size of optional header: our={} img={}", sizeof(typename Traits::OptionalHeader), pfile_hdr->SizeOfOptionalHeader);
 		return false;
 	}
 
 	process_nt_characteristics(pfile_hdr->Characteristics);
 
-	CDebugConsole::get().output_message("NT file header processed");
+	CDebugConsole::get().output_message<LogCategory::Parser>("NT file header processed");
 
 	return true;
 }
 
 // https://docs.microsoft.com/en-us/windows/win32/debug/pe-format#optional-header-windows-specific-fields-image-only
-bool CX86PEProcessor::process_nt_opt_hdr(const IMAGE_OPTIONAL_HEADER* popt_hdr)
+template<typename Traits>
+bool CX86PEProcessor::process_nt_opt_hdr(const typename Traits::OptionalHeader* popt_hdr)
 {
-	if (!process_nt_magic(popt_hdr->Magic))
-		return false;
-
 	m_img_base = popt_hdr->ImageBase;
 
 	// Image base must be 64K aligned
 	if (!m_img_base.is_aligned(0x10000))
 	{
-		CDebugConsole::get().output_error(std::format("Image base address isn't 64K aligned: {}", m_img_base.as_string()));
+		CDebugConsole::get().output_error("Image base address isn't 64K aligned: {}", m_img_base.as_string());
 		return false;
 	}
 
-	CDebugConsole::get().output_message(std::format("Image base address: {}", m_img_base.as_string()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Image base address: {}", m_img_base.as_string());
 
 	// code
 	m_code_base_va = rva_as_va(popt_hdr->BaseOfCode);
 	m_code_size = popt_hdr->SizeOfCode;
 
-	CDebugConsole::get().output_message(std::format("Size of code: {} bytes", m_code_size.val()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Size of code: {} bytes", m_code_size.val());
+
+	// data, PE32+ images don't have a base of data
+	if constexpr (requires { popt_hdr->BaseOfData; })
+		m_data_base_va = rva_as_va(popt_hdr->BaseOfData);
 
-	// data
-	m_data_base_va = rva_as_va(popt_hdr->BaseOfData);
 	m_uninitialized_data_size = popt_hdr->SizeOfUninitializedData;
 	m_initialized_data_size = popt_hdr->SizeOfInitializedData;
 
-	CDebugConsole::get().output_message(std::format("Size of data (init/uninit): {}/{} bytes", m_initialized_data_size.val(), m_uninitialized_data_size.val()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Size of data (init/uninit): {}/{} bytes", m_initialized_data_size.val(), m_uninitialized_data_size.val());
 
 	// entry point
 	m_entry_point_va = rva_as_va(popt_hdr->AddressOfEntryPoint);
 
-	CDebugConsole::get().output_message(std::format("Entry point VA: {}", m_entry_point_va.as_string()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Entry point VA: {}", m_entry_point_va.as_string());
 
 	m_section_alignment = popt_hdr->SectionAlignment;
 	m_file_alignment = popt_hdr->FileAlignment;
@@ -1144,180 +1616,364 @@ bool CX86PEProcessor::process_nt_opt_hdr(const IMAGE_OPTIONAL_HEADER* popt_hdr)
 	if (!m_file_alignment.is_power_of_two() ||
 		(m_file_alignment < 0x200 && m_file_alignment > 0x10000))
 	{
-		CDebugConsole::get().output_error(std::format("File alignment must be power of two and between 512 and 64K inclusively. file align={}", m_file_alignment.as_string()));
+		CDebugConsole::get().output_error("File alignment must be power of two and between 512 and 64K inclusively. file align={}", m_file_alignment.as_string());
 		return false;
 	}
 
 	// Section alignment must be greater or equal to file alignment.
 	if (m_section_alignment < m_file_alignment)
 	{
-		CDebugConsole::get().output_error(std::format("Section alignment must be greater than or equal to file alignment! sec align={} file align={}",
-													  m_section_alignment.as_string(), m_file_alignment.as_string()));
+		CDebugConsole::get().output_error("Section alignment must be greater than or equal to file alignment! sec align={} file align={}",
+										  m_section_alignment.as_string(), m_file_alignment.as_string());
 		return false;
 	}
 
-	CDebugConsole::get().output_message(std::format("Section alignment: {} bytes", m_section_alignment.val()));
-	CDebugConsole::get().output_message(std::format("File alignment: {} bytes", m_file_alignment.val()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Section alignment: {} bytes", m_section_alignment.val());
+	CDebugConsole::get().output_message<LogCategory::Parser>("File alignment: {} bytes", m_file_alignment.val());
 
 	m_size_of_image = popt_hdr->SizeOfImage;
 
 	// Must be aligned to section alignment
 	if (!m_size_of_image.is_aligned(m_section_alignment))
 	{
-		CDebugConsole::get().output_error(std::format("Size of the image must be section-alignment aligned. sizeof image={}", m_size_of_image.as_string()));
+		CDebugConsole::get().output_error("Size of the image must be section-alignment aligned. sizeof image={}", m_size_of_image.as_string());
 		return false;
 	}
 
-	CDebugConsole::get().output_message(std::format("Size of image: {}", m_size_of_image.as_string()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Size of image: {}", m_size_of_image.as_string());
 
 	m_size_of_hdrs = popt_hdr->SizeOfHeaders;
 
 	// Must be aligned to file alignment
 	if (!m_size_of_hdrs.is_aligned(m_file_alignment))
 	{
-		CDebugConsole::get().output_error(std::format("Size of headers must be file-alignment aligned. sizeof image={}", m_size_of_hdrs.as_string()));
+		CDebugConsole::get().output_error("Size of headers must be file-alignment aligned. sizeof image={}", m_size_of_hdrs.as_string());
 		return false;
 	}
 
-	CDebugConsole::get().output_message(std::format("Size of headers: {}", m_size_of_hdrs.as_string()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Size of headers: {}", m_size_of_hdrs.as_string());
 
+	// Calculated along with the hashes, it reads the whole file
 	m_image_checksum_real = popt_hdr->CheckSum;
-	m_image_checksum_calc = calculate_image_checksum();
-
-	if (m_image_checksum_real != m_image_checksum_calc)
-	{
-		CDebugConsole::get().output_error(std::format("Calculated checksum doesn't match the real one. real={} calc={}", m_image_checksum_real.as_string(), m_image_checksum_calc.as_string()));
-		// This isn't critical, we don't have to return from this.
-	}
 
-	CDebugConsole::get().output_message(std::format("Image CheckSum: {}", m_image_checksum_real.as_string()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Image CheckSum: {}", m_image_checksum_real.as_string());
 
 	process_nt_subsystem(popt_hdr->Subsystem);
 
 	process_nt_dll_characteristics(popt_hdr->DllCharacteristics);
 
+	enter_progress_stage("Sections");
+
 	if (!process_sections())
 		return false;
 
-	if (!process_nt_data_dir_entries(popt_hdr))
-		return false;
+	process_overlay();
 
-	process_nt_data_directories();
+	mark_ready(Stage::Sections);
+	complete_progress_steps();
 
-	return true;
-}
+	enter_progress_stage("NT headers");
+
+	if (!process_nt_data_dir_entries<Traits>(popt_hdr))
+		return false;
+
+	// Needs the sections and the data directories, so it can't be done any sooner. Restored
+	// parts are ready before anyone could ask for them to be decoded.
+	if (m_cache_entry.is_open())
+	{
+		m_restored_from_cache = restore_from_cache(m_cache_entry.reader());
+
+		if (m_restored_from_cache)
+		{
+			for (uint32_t i = 0; i < pe::k_numberof_directory_entries; i++)
+			{
+				if (is_data_dir_cached(i))
+					mark_data_dir_ready(i);
+			}
+
+			mark_ready(Stage::Strings);
+			mark_ready(Stage::Hashes);
+		}
+		else
+		{
+			CDebugConsole::get().output_error("Couldn't restore {} from the parse cache, decoding it instead.", m_input_file.string());
+			discard_restored_data();
+		}
+	}
+
+	mark_ready(Stage::NtHeaders);
+	complete_progress_steps();
+
+	return true;
+}
 
 void CX86PEProcessor::process_nt_characteristics(uint16_t characs)
 {
-	m_nt_characteristics =
-	{
-		characs,
-		{
-			{ NULL, "None" },
-			{ IMAGE_FILE_RELOCS_STRIPPED,			"No reloc" },
-			{ IMAGE_FILE_EXECUTABLE_IMAGE,			"Executable" },
-			{ IMAGE_FILE_LINE_NUMS_STRIPPED,		"No line numbers" },
-			{ IMAGE_FILE_LOCAL_SYMS_STRIPPED,		"No symbols" },
-			{ IMAGE_FILE_AGGRESIVE_WS_TRIM,			"Aggressively trim working set" },
-			{ IMAGE_FILE_LARGE_ADDRESS_AWARE,		">2gb addrs" },
-			{ IMAGE_FILE_BYTES_REVERSED_LO,			"Machine word bytes reversed low" },
-			{ IMAGE_FILE_32BIT_MACHINE,				"32-bit word machine" },
-			{ IMAGE_FILE_DEBUG_STRIPPED,			"No debug (inside .DBG file instead)" },
-			{ IMAGE_FILE_REMOVABLE_RUN_FROM_SWAP,	"If on removable media, copy & run from the swap file" },
-			{ IMAGE_FILE_NET_RUN_FROM_SWAP,			"If on Net, copy & run from the swap file" },
-			{ IMAGE_FILE_SYSTEM,					"System File" },
-			{ IMAGE_FILE_DLL,						"DLL" },
-			{ IMAGE_FILE_UP_SYSTEM_ONLY,			"Should only be run on a UP machine" },
-			{ IMAGE_FILE_BYTES_REVERSED_HI,			"Machine word bytes are reversed high" },
-		}
-	};
+	m_nt_characteristics = characs;
 
-	CDebugConsole::get().output_message(std::format("NT characteristics: {}", m_nt_characteristics.as_continuous_string()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("NT characteristics: {}", m_nt_characteristics.as_continuous_string());
 }
 
-bool CX86PEProcessor::process_nt_data_dir_entries(const IMAGE_OPTIONAL_HEADER* popt_hdr)
+template<typename Traits>
+bool CX86PEProcessor::process_nt_data_dir_entries(const typename Traits::OptionalHeader* popt_hdr)
 {
 	m_number_of_data_directories = popt_hdr->NumberOfRvaAndSizes;
 
 	if (!m_number_of_data_directories)
 	{
-		CDebugConsole::get().output_error(std::format("Image without data directories!"));
+		CDebugConsole::get().output_error("Image without data directories!");
 		return false;
 	}
 
-	if (m_number_of_data_directories > IMAGE_NUMBEROF_DIRECTORY_ENTRIES)
+	if (m_number_of_data_directories > pe::k_numberof_directory_entries)
 	{
-		CDebugConsole::get().output_error(std::format("Image has more data directories than expected. got={} max={}", m_number_of_data_directories, IMAGE_NUMBEROF_DIRECTORY_ENTRIES));
+		CDebugConsole::get().output_error("Image has more data directories than expected. got={} max={}", m_number_of_data_directories, pe::k_numberof_directory_entries);
 		return false;
 	}
 
 	for (uint32_t i = 0; i < m_number_of_data_directories; i++)
 	{
 		ImageDataDir datadir;
-		auto pdir_entry = const_cast<IMAGE_DATA_DIRECTORY*>(&popt_hdr->DataDirectory[i]);
+		auto pdir_entry = const_cast<pe::ImageDataDirectory*>(&popt_hdr->DataDirectory[i]);
 
 		datadir.m_name = data_dir_name_by_idx(i);
 		datadir.m_address = pdir_entry->VirtualAddress;
 		datadir.m_size = pdir_entry->Size;
 
-		CDebugConsole::get().output_message(std::format("#{:02d} {:<24} present={}", i, datadir.m_name, datadir.is_present() ? "yes" : "no"));
+		CDebugConsole::get().output_verbose<LogCategory::Parser>("#{:02d} {:<24} present={}", i, datadir.m_name, datadir.is_present() ? "yes" : "no");
 		m_data_dirs[i] = datadir;
 	}
 
-	CDebugConsole::get().output_message("Processed all data directory entries");
+	CDebugConsole::get().output_message<LogCategory::Parser>("Processed all data directory entries");
 
 	return true;
 }
 
-void CX86PEProcessor::process_nt_data_directories()
+void CX86PEProcessor::decode_all()
+{
+	// Directories are independent reads of the image, so they're all decoded concurrently.
+	// The few that depend on others wait for them inside of decode_data_dir().
+	for (uint32_t i = 0; i < pe::k_numberof_directory_entries; i++)
+		request_data_dir(i);
+
+	request_stage(Stage::Strings);
+	request_stage(Stage::Hashes);
+
+	CThreadPool::get().wait(m_decode_group);
+}
+
+bool CX86PEProcessor::request_data_dir(uint32_t i)
 {
-	auto process_data_dir = [&](CX86PEProcessor* pobj, void(CX86PEProcessor::*process_func)(const ImageDataDir&), uint32_t i)
+	if (is_data_dir_ready(i))
+		return true;
+
+	// The GUI may ask while the headers are still being processed (and parts are being
+	// restored from the parse cache), nothing can be decoded before they're done.
+	if (!is_ready(Stage::NtHeaders))
+		return false;
+
+	// Every part is submitted only once. A thread that waits for the pool while decoding
+	// one part could otherwise pick up the same part again.
+	if (!(m_requested_data_dirs.fetch_or(1u << i, std::memory_order_relaxed) & (1u << i)))
 	{
-		const auto& ddir = m_data_dirs[i];
+		add_progress_steps(1);
+		CThreadPool::get().submit(m_decode_group,
+								  [this, i]()
+								  {
+									  decode_data_dir(i);
+									  complete_progress_steps();
+								  });
+	}
 
-		if (!ddir.is_present())
-			return;
+	return false;
+}
+
+bool CX86PEProcessor::request_stage(Stage stage)
+{
+	if (is_ready(stage))
+		return true;
 
-		CDebugConsole::get().output_message(std::format("Processing '{}'", ddir.m_name));
+	if (!is_ready(Stage::NtHeaders))
+		return false;
 
-		(pobj->*process_func)(ddir);
+	uint32_t bit = 1u << (uint32_t)stage;
+	if (m_requested_stages.fetch_or(bit, std::memory_order_relaxed) & bit)
+		return false;
 
-		CDebugConsole::get().output_message(std::format("Processed '{}' data directory", ddir.m_name));
-	};
+	switch (stage)
+	{
+		// The string scan adds a step for each of its chunks once it knows how many there are
+		case Stage::Strings:
+			add_progress_steps(1);
+			CThreadPool::get().submit(m_decode_group,
+									  [this]()
+									  {
+										  decode_strings();
+										  complete_progress_steps();
+									  });
+			break;
+
+		case Stage::Hashes:
+			add_progress_steps(1);
+			CThreadPool::get().submit(m_decode_group,
+									  [this]()
+									  {
+										  decode_hashes();
+										  complete_progress_steps();
+									  });
+			break;
+
+		default:
+			CDebugConsole::get().output_error("Stage {} isn't decoded on demand", (uint32_t)stage);
+			break;
+	}
+
+	return false;
+}
+
+template<typename Traits>
+auto CX86PEProcessor::data_dir_decoder(uint32_t i) -> void(CX86PEProcessor::*)(const ImageDataDir&)
+{
+	switch (i)
+	{
+		case pe::k_directory_entry_export: return &CX86PEProcessor::process_nt_data_dir_exports;
+		case pe::k_directory_entry_import: return &CX86PEProcessor::process_nt_data_dir_imports<Traits>;
+		case pe::k_directory_entry_resource: return &CX86PEProcessor::process_nt_data_dir_resources;
+		case pe::k_directory_entry_exception: return &CX86PEProcessor::process_nt_data_dir_exceptions;
+		case pe::k_directory_entry_security: return &CX86PEProcessor::process_nt_data_dir_certificates;
+		case pe::k_directory_entry_basereloc: return &CX86PEProcessor::process_nt_data_dir_relocs;
+		case pe::k_directory_entry_debug: return &CX86PEProcessor::process_nt_data_dir_debug;
+		case pe::k_directory_entry_architecture: return &CX86PEProcessor::process_nt_data_dir_arch;
+		case pe::k_directory_entry_globalptr: return &CX86PEProcessor::process_nt_data_dir_global_ptr;
+		case pe::k_directory_entry_tls: return &CX86PEProcessor::process_nt_data_dir_tls<Traits>;
+		case pe::k_directory_entry_load_config: return &CX86PEProcessor::process_nt_data_dir_load_cfg<Traits>;
+		case pe::k_directory_entry_bound_import: return &CX86PEProcessor::process_nt_data_dir_bound_import;
+		case pe::k_directory_entry_iat: return &CX86PEProcessor::process_nt_data_dir_iat<Traits>;
+		case pe::k_directory_entry_delay_import: return &CX86PEProcessor::process_nt_data_dir_delay_import<Traits>;
+		case pe::k_directory_entry_com_descriptor: return &CX86PEProcessor::process_nt_data_dir_clr_runtime;
+	}
+
+	return nullptr; // Reserved
+}
+
+void CX86PEProcessor::decode_data_dir(uint32_t i)
+{
+	if (is_data_dir_ready(i))
+		return;
+
+	std::call_once(m_data_dirs_decoded[i],
+				   [this, i]()
+				   {
+					   // The IAT is named by the thunks of both import directories.
+					   if (i == pe::k_directory_entry_iat)
+					   {
+						   decode_data_dir(pe::k_directory_entry_import);
+						   decode_data_dir(pe::k_directory_entry_delay_import);
+					   }
+
+					   // Lookup only, other directories may be decoded at the same time.
+					   auto iter = m_data_dirs.find(i);
+					   auto process_func = is_pe32_plus() ? data_dir_decoder<pe::Pe64Traits>(i) : data_dir_decoder<pe::Pe32Traits>(i);
+
+					   if (iter != m_data_dirs.end() && iter->second.is_present() && process_func && !is_cancel_requested())
+					   {
+						   const auto& ddir = iter->second;
+
+						   enter_progress_stage(ddir.m_name.c_str());
+						   CDebugConsole::get().output_verbose<LogCategory::Parser>("Processing '{}'", ddir.m_name);
+
+						   auto start = std::chrono::high_resolution_clock::now();
+
+						   (this->*process_func)(ddir);
+
+						   CDebugConsole::get().output_verbose<LogCategory::Parser>("Processed '{}' data directory in {:.3f} ms", ddir.m_name,
+																					std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+					   }
+
+					   // Never marked, the processor is going away
+					   if (is_cancel_requested())
+						   return;
 
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_exports, IMAGE_DIRECTORY_ENTRY_EXPORT);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_imports, IMAGE_DIRECTORY_ENTRY_IMPORT);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_resources, IMAGE_DIRECTORY_ENTRY_RESOURCE);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_exceptions, IMAGE_DIRECTORY_ENTRY_EXCEPTION);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_certificates, IMAGE_DIRECTORY_ENTRY_SECURITY);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_relocs, IMAGE_DIRECTORY_ENTRY_BASERELOC);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_debug, IMAGE_DIRECTORY_ENTRY_DEBUG);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_arch, IMAGE_DIRECTORY_ENTRY_ARCHITECTURE);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_global_ptr, IMAGE_DIRECTORY_ENTRY_GLOBALPTR);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_tls, IMAGE_DIRECTORY_ENTRY_TLS);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_load_cfg, IMAGE_DIRECTORY_ENTRY_LOAD_CONFIG);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_bound_import, IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_iat, IMAGE_DIRECTORY_ENTRY_IAT);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_delay_import, IMAGE_DIRECTORY_ENTRY_DELAY_IMPORT);
-	process_data_dir(this, &CX86PEProcessor::process_nt_data_dir_clr_runtime, IMAGE_DIRECTORY_ENTRY_COM_DESCRIPTOR);
-
-	// We get the function names/ordinals from the directory import entry however, 
-	// addresses of individual imports are from the iat directory entry. Thus, we 
-	// have to post-assign each import a corresponding address.
-	//assign_addresses_to_imports();
-
-	CDebugConsole::get().output_message("Processed all data directories");
+					   // Directories that aren't present are decoded too, there's just nothing inside of them
+					   mark_data_dir_ready(i);
+
+					   if (is_data_dir_cached(i))
+						   store_in_cache_if_decoded();
+				   });
+}
+
+void CX86PEProcessor::decode_strings()
+{
+	if (is_ready(Stage::Strings))
+		return;
+
+	std::call_once(m_strings_decoded,
+				   [this]()
+				   {
+					   enter_progress_stage("Strings");
+					   process_image_strings();
+
+					   if (is_cancel_requested())
+						   return;
+
+					   mark_ready(Stage::Strings);
+					   store_in_cache_if_decoded();
+				   });
+}
+
+void CX86PEProcessor::decode_hashes()
+{
+	if (is_ready(Stage::Hashes))
+		return;
+
+	std::call_once(m_hashes_decoded,
+				   [this]()
+				   {
+					   enter_progress_stage("Hashes");
+
+					   // Each of them reads the whole file or all of the sections, so they run alongside each other
+					   CTaskGroup hash_group;
+					   CThreadPool::get().submit(hash_group, [this]() { m_image_checksum_calc = calculate_image_checksum(); });
+					   CThreadPool::get().submit(hash_group, [this]() { process_file_digests(); });
+					   CThreadPool::get().submit(hash_group, [this]() { process_section_data(); });
+					   CThreadPool::get().submit(hash_group,
+												 [this]()
+												 {
+													 decode_data_dir(pe::k_directory_entry_import);
+													 process_import_hash();
+												 });
+
+					   CThreadPool::get().wait(hash_group);
+
+					   if (is_cancel_requested())
+						   return;
+
+					   if (m_image_checksum_real != m_image_checksum_calc)
+					   {
+						   CDebugConsole::get().output_error("Calculated checksum doesn't match the real one. real={} calc={}", m_image_checksum_real.as_string(), m_image_checksum_calc.as_string());
+						   // This isn't critical
+					   }
+
+					   mark_ready(Stage::Hashes);
+					   store_in_cache_if_decoded();
+				   });
 }
 
 // https://docs.microsoft.com/en-us/windows/win32/debug/pe-format#export-directory-table
 void CX86PEProcessor::process_nt_data_dir_exports(const ImageDataDir& dir_entry)
 {
-	auto ied = m_byte_buffer.get_at<IMAGE_EXPORT_DIRECTORY>(offset_relative_to_a_section(dir_entry.m_address));
+	auto ied = m_byte_buffer.get_at<pe::ImageExportDirectory>(offset_relative_to_a_section(dir_entry.m_address));
+
+	if (!ied)
+	{
+		report_malformed("Export directory");
+		return;
+	}
 
 	// Must be zero, this is reserved
 	if (ied->Characteristics != 0)
 	{
-		CDebugConsole::get().output_error(std::format("Characteristics must be zero ({})", ied->Characteristics));
+		CDebugConsole::get().output_error("Characteristics must be zero ({})", ied->Characteristics);
 		return;
 	}
 
@@ -1332,63 +1988,81 @@ void CX86PEProcessor::process_nt_data_dir_exports(const ImageDataDir& dir_entry)
 
 	// These two should be the same afaik. We're using the number of names further below.
 	if (m_number_of_exported_names != m_number_of_exported_functions)
-		CDebugConsole::get().output_info(std::format("Number of exported names & functions doesn't match. names={} functions={}", m_number_of_exported_names, m_number_of_exported_functions));
+		CDebugConsole::get().output_info<LogCategory::Parser>("Number of exported names & functions doesn't match. names={} functions={}", m_number_of_exported_names, m_number_of_exported_functions);
 
 	m_export_starting_ordinal_num = ied->Base;
 
 	// This is the base ordinal used inside the export address table. Should be 1 by default.
 	if (m_export_starting_ordinal_num != 1)
 	{
-		CDebugConsole::get().output_info(std::format("Starting ordinal base should be 1, however it is: {}", m_export_starting_ordinal_num.val()));
+		CDebugConsole::get().output_info<LogCategory::Parser>("Starting ordinal base should be 1, however it is: {}", m_export_starting_ordinal_num.val());
 	}
 
-	m_export_dll_name = reinterpret_cast<const char*>(m_byte_buffer.get_at<uint32_t>(offset_relative_to_a_section(ied->Name)));
+	m_export_dll_name = m_byte_buffer.get_cstring_at(offset_relative_to_a_section(ied->Name));
 
 	// This is the name of the dll (should be the name of processed file)
 	if (m_export_dll_name.empty())
 	{
-		CDebugConsole::get().output_info("Export directory has no DLL name.");
+		CDebugConsole::get().output_info<LogCategory::Parser>("Export directory has no DLL name.");
 	}
 
-	CDebugConsole::get().output_message(std::format("Image has {} exports", m_number_of_exported_names));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Image has {} exports", m_number_of_exported_names);
 
 	m_export_creation_timestamp = ied->TimeDateStamp;
 
-	auto function_table_base = m_byte_buffer.get_at<uint32_t>(offset_relative_to_a_section(ied->AddressOfFunctions));
-	auto name_table_base = m_byte_buffer.get_at<uint32_t>(offset_relative_to_a_section(ied->AddressOfNames));
-	auto ordinal_table_base = m_byte_buffer.get_at<uint16_t>(offset_relative_to_a_section(ied->AddressOfNameOrdinals));
+	// The tables are read entry by entry, any of them may run past the end of a truncated file.
+	uint64_t function_table_off = offset_relative_to_a_section(ied->AddressOfFunctions);
+	uint64_t name_table_off = offset_relative_to_a_section(ied->AddressOfNames);
+	uint64_t ordinal_table_off = offset_relative_to_a_section(ied->AddressOfNameOrdinals);
 
-	CDebugConsole::get().output_message("Processing all exported functions");
+	CDebugConsole::get().output_message<LogCategory::Parser>("Processing all exported functions");
 
 	for (uint32_t i = 0; i < m_number_of_exported_names; i++)
 	{
 		ImageExport ex;
 
-		auto name_entry_addr = m_byte_buffer.get_at<uint32_t>(offset_relative_to_a_section(name_table_base[i]));
+		auto name_rva = m_byte_buffer.get_at<uint32_t>(name_table_off + i * sizeof(uint32_t));
+		auto ordinal = m_byte_buffer.get_at<uint16_t>(ordinal_table_off + i * sizeof(uint16_t));
+
+		if (!name_rva || !ordinal)
+		{
+			report_malformed("Export name table");
+			break;
+		}
 
-		ex.m_name = reinterpret_cast<const char*>(name_entry_addr);
+		ex.m_name = m_byte_buffer.get_cstring_at(offset_relative_to_a_section(*name_rva));
 
 		if (ex.m_name.empty())
-			CDebugConsole::get().output_info(std::format("Warning, got export without name: #{}", i));
+			CDebugConsole::get().output_info<LogCategory::Parser>("Warning, got export without name: #{}", i);
 
 		// Note: the ordinal is plus the base however, when actually accessing an entry, you don't use it? WTF Microsoft??! Gave me a headache
-		ex.m_ordinal = ordinal_table_base[i] + m_export_starting_ordinal_num;
-		ex.m_address = rva_as_va(function_table_base[ex.m_ordinal]);
-		ex.is_forwarded = (function_table_base[ex.m_ordinal] >= dir_entry.m_address) && (function_table_base[ordinal_table_base[i]] < dir_entry.m_address + dir_entry.m_size);
+		ex.m_ordinal = *ordinal + m_export_starting_ordinal_num;
+
+		auto function_rva = m_byte_buffer.get_at<uint32_t>(function_table_off + (uint16_t)ex.m_ordinal * sizeof(uint32_t));
+		auto function_rva_unbiased = m_byte_buffer.get_at<uint32_t>(function_table_off + *ordinal * sizeof(uint32_t));
+
+		if (!function_rva || !function_rva_unbiased)
+		{
+			report_malformed("Export address table");
+			break;
+		}
+
+		ex.m_address = rva_as_va(*function_rva);
+		ex.is_forwarded = (*function_rva >= dir_entry.m_address) && (*function_rva_unbiased < dir_entry.m_address + dir_entry.m_size);
 
 		//if (!is_forwarded)
 		//{
 		//	ex.m_address = rva_as_va(function_table_base[ordinal_table_base[i]]);
 		//	ex.m_forward_name.clear();
-		//	CDebugConsole::get().output_message(std::format("[{}] (forwarded: no) {} ({})", 
-		//													ex.m_ordinal.as_string(), ex.m_address.as_string(), ex.m_name));
+		//	CDebugConsole::get().output_message<LogCategory::Parser>("[{}] (forwarded: no) {} ({})", 
+		//													ex.m_ordinal.as_string(), ex.m_address.as_string(), ex.m_name);
 		//}
 		//else
 		//{
 		//	ex.m_address = rva_as_va(function_table_base[ordinal_table_base[i]]);
 		//	ex.m_forward_name = m_byte_buffer.get_at<const char>(offset_relative_to_a_section(function_table_base[ordinal_table_base[i]]));
-		//	CDebugConsole::get().output_message(std::format("[{}] (forwarded: yes) {} ({}/{})",
-		//													ex.m_ordinal.as_string(), ex.m_address.as_string(), ex.m_name, ex.m_forward_name));
+		//	CDebugConsole::get().output_message<LogCategory::Parser>("[{}] (forwarded: yes) {} ({}/{})",
+		//													ex.m_ordinal.as_string(), ex.m_address.as_string(), ex.m_name, ex.m_forward_name);
 		//}
 
 		//SmartHexValue address = function_table_base[ordinal_table_base[i]];
@@ -1396,42 +2070,63 @@ void CX86PEProcessor::process_nt_data_dir_exports(const ImageDataDir& dir_entry)
 		m_image_exports.emplace_back(ex);
 	}
 
-	CDebugConsole::get().output_message("Done!");
+	CDebugConsole::get().output_message<LogCategory::Parser>("Done!");
 }
 
 // https://docs.microsoft.com/en-us/windows/win32/debug/pe-format#the-idata-section
+template<typename Traits>
 void CX86PEProcessor::process_nt_data_dir_imports(const ImageDataDir& dir_entry)
 {
-	auto iid = m_byte_buffer.get_at<IMAGE_IMPORT_DESCRIPTOR>(offset_relative_to_a_section(dir_entry.m_address));
+	uint64_t iid_off = offset_relative_to_a_section(dir_entry.m_address);
 
 	// Look through all import descriptors, each having many 'import thunks'.
 	// Single import descriptor represents a single image from where the imports are imported.
 	// We know that we're at the end when we come across the final descriptor, which has all
 	// of its fields set to zero.
-	while (iid->OriginalFirstThunk != NULL)
+	for (;; iid_off += sizeof(pe::ImageImportDescriptor))
 	{
-		ImageImportDescriptor import_descriptor;
+		auto iid = m_byte_buffer.get_at<pe::ImageImportDescriptor>(iid_off);
+
+		if (!iid)
+		{
+			report_malformed("Import descriptor");
+			break;
+		}
+
+		if (iid->OriginalFirstThunk == NULL)
+			break;
 
-		auto descriptor_name_addr = m_byte_buffer.get_at<uint32_t>(offset_relative_to_a_section(iid->Name));
+		ImageImportDescriptor import_descriptor(&m_arena);
 
-		import_descriptor.m_image_name = reinterpret_cast<const char*>(descriptor_name_addr);
+		import_descriptor.m_image_name = m_byte_buffer.get_cstring_at(offset_relative_to_a_section(iid->Name));
 
 		// Original first thunk is rva for the first that contains IMAGE_IMPORT_BY_NAME.
-		auto thunk_data = m_byte_buffer.get_at<IMAGE_THUNK_DATA>(offset_relative_to_a_section(iid->OriginalFirstThunk));
+		uint64_t thunk_data_off = offset_relative_to_a_section(iid->OriginalFirstThunk);
 
 		// First thunk contains the file pointer to import addresses for this descriptor. (inside IAT)
-		uint32_t descriptor_import_addrs_base_va = rva_as_va(iid->FirstThunk);
+		uint64_t descriptor_import_addrs_base_va = rva_as_va(iid->FirstThunk);
 
 		// Loop through all descriptor thunks (imported functions) and process them
-		while (thunk_data->u1.AddressOfData != NULL)
+		for (;; thunk_data_off += sizeof(typename Traits::ThunkData))
 		{
+			auto thunk_data = m_byte_buffer.get_at<typename Traits::ThunkData>(thunk_data_off);
+
+			if (!thunk_data)
+			{
+				report_malformed("Import thunk");
+				break;
+			}
+
+			if (thunk_data->u1.AddressOfData == NULL)
+				break;
+
 			ImageImportThunk import_thunk;
 
 			// Check if the most-significant ordinal bit is set, if yes, we're importing
 			// by an ordinal, not by a function name. We have to handle this..
-			if (IMAGE_SNAP_BY_ORDINAL(thunk_data->u1.Ordinal))
+			if (Traits::snap_by_ordinal(thunk_data->u1.Ordinal))
 			{
-				import_thunk.m_ordinal = IMAGE_ORDINAL(thunk_data->u1.Ordinal);
+				import_thunk.m_ordinal = pe::ordinal(thunk_data->u1.Ordinal);
 				import_thunk.m_name = "";
 				import_thunk.m_hint = 0;
 				m_number_of_import_thunk_ordinals++;
@@ -1439,11 +2134,15 @@ void CX86PEProcessor::process_nt_data_dir_imports(const ImageDataDir& dir_entry)
 			else
 			{
 				// We can get the name only when not snapped by an ordinal
-				auto import_name = m_byte_buffer.get_at<IMAGE_IMPORT_BY_NAME>(offset_relative_to_a_section(thunk_data->u1.AddressOfData));
+				auto import_name_off = offset_relative_to_a_section(thunk_data->u1.AddressOfData);
+				auto import_name = m_byte_buffer.get_at<pe::ImageImportByName>(import_name_off);
+
+				if (!import_name)
+					report_malformed("Import name");
 
 				import_thunk.m_ordinal = 0;
-				import_thunk.m_name = import_name->Name;
-				import_thunk.m_hint = import_name->Hint;
+				import_thunk.m_name = m_byte_buffer.get_cstring_at(import_name_off + offsetof(pe::ImageImportByName, Name));
+				import_thunk.m_hint = import_name ? import_name->Hint : 0;
 				m_number_of_import_thunk_names++;
 			}
 
@@ -1451,92 +2150,294 @@ void CX86PEProcessor::process_nt_data_dir_imports(const ImageDataDir& dir_entry)
 
 			import_descriptor.m_import_thunks.emplace_back(import_thunk);
 
-			thunk_data++;
-			descriptor_import_addrs_base_va += sizeof(uint32_t);
+			descriptor_import_addrs_base_va += sizeof(typename Traits::Address);
 		}
 
 		// At the end of thunk data, the virtual address corresponds not to
 		// an import va but to descriptor va.
 		import_descriptor.m_descriptor_va = descriptor_import_addrs_base_va;
 
-		m_image_import_descriptors.emplace_back(import_descriptor);
+		m_image_import_descriptors.emplace_back(std::move(import_descriptor));
 
 		m_number_of_import_descriptors++;
-		iid++;
 	}
 
-	CDebugConsole::get().output_message(std::format("Found {} thunks inside {} import descriptors.",
-													m_number_of_import_thunk_ordinals + m_number_of_import_thunk_names, m_number_of_import_descriptors));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Found {} thunks inside {} import descriptors.",
+										m_number_of_import_thunk_ordinals + m_number_of_import_thunk_names, m_number_of_import_descriptors);
 }
 
 // https://docs.microsoft.com/en-us/windows/win32/debug/pe-format#the-rsrc-section
 void CX86PEProcessor::process_nt_data_dir_resources(const ImageDataDir& dir_entry)
 {
-	return; // TODO
-	uint32_t rsc_base = offset_relative_to_a_section(dir_entry.m_address);
+	m_resources_off = offset_relative_to_a_section(dir_entry.m_address);
+
+	if (!m_resources_off)
+	{
+		CDebugConsole::get().output_error("Resource directory isn't inside of any section.");
+		return;
+	}
+
+	uint64_t file_size = m_byte_buffer.get_size();
+	auto fits = [file_size](uint64_t off, uint64_t size) { return off <= file_size && size <= file_size - off; };
+
+	// Every entry of a well-formed tree is visited once, so there can't be more of them than
+	// what fits into the directory. Directories that point back at each other run out of these.
+	uint64_t entries_left = dir_entry.m_size / sizeof(pe::ImageResourceDirectoryEntry);
+
+	// Calls on_entry for every entry of the directory at dir_off (relative to the root),
+	// false if the directory doesn't fit into the file or holds more entries than are left.
+	auto for_each_entry = [&](uint32_t dir_off, const auto& on_entry)
+	{
+		uint64_t off = m_resources_off + dir_off;
+
+		if (!fits(off, sizeof(pe::ImageResourceDirectory)))
+			return false;
+
+		auto ird = m_byte_buffer.get_at<pe::ImageResourceDirectory>(off);
+		uint32_t num_entries = ird->NumberOfNamedEntries + ird->NumberOfIdEntries;
+
+		if (!fits(off + sizeof(pe::ImageResourceDirectory), (uint64_t)num_entries * sizeof(pe::ImageResourceDirectoryEntry)) || num_entries > entries_left)
+			return false;
+
+		entries_left -= num_entries;
+
+		auto irde = reinterpret_cast<const pe::ImageResourceDirectoryEntry*>(ird + 1);
+		for (uint32_t i = 0; i < num_entries; i++)
+			on_entry(irde[i]);
+
+		return true;
+	};
 
-	auto ird_type = m_byte_buffer.get_at<IMAGE_RESOURCE_DIRECTORY>(rsc_base);
-	auto irde_type = m_byte_buffer.get_at<IMAGE_RESOURCE_DIRECTORY_ENTRY>(rsc_base + sizeof(IMAGE_RESOURCE_DIRECTORY));
+	uint32_t num_malformed = 0;
 
-	// First level - type id
-	for (uint16_t i = 0; i < ird_type->NumberOfIdEntries + ird_type->NumberOfNamedEntries; i++)
+	auto add_leaf = [&](uint32_t type, uint32_t name, uint16_t language, uint32_t data_entry_off)
 	{
-		if (irde_type->DataIsDirectory)
+		uint64_t off = m_resources_off + data_entry_off;
+
+		if (!fits(off, sizeof(pe::ImageResourceDataEntry)))
 		{
-			CDebugConsole::get().output_message(std::format("  Directory type"));
+			num_malformed++;
+			return;
+		}
 
-			auto ird_name = m_byte_buffer.get_at<IMAGE_RESOURCE_DIRECTORY>(rsc_base + irde_type->OffsetToDirectory);
-			auto irde_name = m_byte_buffer.get_at<IMAGE_RESOURCE_DIRECTORY_ENTRY>(rsc_base + irde_type->OffsetToDirectory + sizeof(IMAGE_RESOURCE_DIRECTORY));
+		auto irdae = m_byte_buffer.get_at<pe::ImageResourceDataEntry>(off);
 
-			// Second level - name id
-			for (uint16_t k = 0; k < ird_name->NumberOfIdEntries + ird_name->NumberOfNamedEntries; k++)
-			{
-				if (irde_name->DataIsDirectory)
-				{
-					CDebugConsole::get().output_message(std::format("    Directory name"));
+		ImageResource resource;
 
-					auto ird_lang = m_byte_buffer.get_at<IMAGE_RESOURCE_DIRECTORY>(rsc_base + irde_name->OffsetToDirectory);
-					auto irde_lang = m_byte_buffer.get_at<IMAGE_RESOURCE_DIRECTORY_ENTRY>(rsc_base + irde_name->OffsetToDirectory + sizeof(IMAGE_RESOURCE_DIRECTORY));
+		resource.m_type = type;
+		resource.m_name = name;
+		resource.m_language = language;
+		resource.m_data_rva = irdae->OffsetToData;
+		resource.m_size = irdae->Size;
+		resource.m_codepage = irdae->CodePage;
 
-					// Third level - lang id
-					for (uint16_t j = 0; j < ird_lang->NumberOfIdEntries + ird_lang->NumberOfNamedEntries; j++)
-					{
-						if (irde_lang->DataIsDirectory)
-						{
-							CDebugConsole::get().output_message(std::format("      Directory lang"));
-						}
-						else
-						{
-							CDebugConsole::get().output_message(std::format("      Data lang 0x{:08X}", irde_lang->OffsetToData));
-						}
+		// Nothing but where the data is gets looked at
+		resource.m_data_off = offset_relative_to_a_section(irdae->OffsetToData);
+		if (resource.m_data_off && !fits(resource.m_data_off, resource.m_size))
+			resource.m_data_off = 0;
 
-						irde_lang++;
-					}
-				}
-				else
+		m_image_resources.emplace_back(resource);
+	};
+
+	// Type, name and language. Directories can point anywhere, even at themselves, so
+	// nothing deeper than that is followed.
+	bool root_fits = for_each_entry(0, [&](const pe::ImageResourceDirectoryEntry& type_entry)
+	{
+		if (!type_entry.data_is_directory())
+		{
+			num_malformed++;
+			return;
+		}
+
+		m_number_of_resource_types++;
+
+		bool fits_type = for_each_entry(type_entry.offset_to_directory(), [&](const pe::ImageResourceDirectoryEntry& name_entry)
+		{
+			// Without a language level
+			if (!name_entry.data_is_directory())
+			{
+				add_leaf(type_entry.Name, name_entry.Name, 0, name_entry.OffsetToData);
+				return;
+			}
+
+			bool fits_name = for_each_entry(name_entry.offset_to_directory(), [&](const pe::ImageResourceDirectoryEntry& lang_entry)
+			{
+				if (lang_entry.data_is_directory())
 				{
-					CDebugConsole::get().output_message(std::format("    Data name 0x{:08X}", irde_name->OffsetToData));
+					num_malformed++;
+					return;
 				}
 
-				irde_name++;
-			}
-		}
-		else
+				add_leaf(type_entry.Name, name_entry.Name, lang_entry.id(), lang_entry.OffsetToData);
+			});
+
+			if (!fits_name)
+				num_malformed++;
+		});
+
+		if (!fits_type)
+			num_malformed++;
+	});
+
+	if (!root_fits)
+	{
+		report_malformed("Resource directory");
+		return;
+	}
+
+	if (num_malformed)
+		CDebugConsole::get().output_info<LogCategory::Parser>("Skipped {} malformed resource directory entries", num_malformed);
+
+	CDebugConsole::get().output_message<LogCategory::Parser>("Indexed {} resources of {} types", m_image_resources.size(), m_number_of_resource_types);
+}
+
+const char* ImageResource::type_name(uint16_t type)
+{
+	static constexpr const char* k_type_names[] =
+	{
+		nullptr, "CURSOR", "BITMAP", "ICON", "MENU", "DIALOG", "STRING", "FONTDIR", "FONT", "ACCELERATOR", "RCDATA",
+		"MESSAGETABLE", "GROUP_CURSOR", nullptr, "GROUP_ICON", nullptr, "VERSION", "DLGINCLUDE", nullptr, "PLUGPLAY",
+		"VXD", "ANICURSOR", "ANIICON", "HTML", "MANIFEST",
+	};
+
+	static_assert(std::size(k_type_names) == pe::k_rt_manifest + 1);
+
+	return type < std::size(k_type_names) ? k_type_names[type] : nullptr;
+}
+
+std::string_view CX86PEProcessor::resource_data(const ImageResource& resource) const
+{
+	if (!resource.has_data())
+		return {};
+
+	auto data = m_byte_buffer.get_array_at<const char>(resource.m_data_off, resource.m_size);
+
+	return data ? std::string_view(data, resource.m_size) : std::string_view();
+}
+
+std::string CX86PEProcessor::resource_entry_name(uint32_t name) const
+{
+	pe::ImageResourceDirectoryEntry entry = { name, 0 };
+
+	if (!entry.name_is_string())
+		return std::format("#{}", entry.id());
+
+	uint64_t off = m_resources_off + entry.name_offset();
+
+	auto length = m_byte_buffer.get_at<uint16_t>(off);
+
+	if (!length)
+		return "<invalid>";
+
+	// The name may be cut short by the end of the file
+	uint64_t string_off = off + offsetof(pe::ImageResourceDirStringU, NameString);
+	uint64_t num_chars = std::min<uint64_t>(*length, (m_byte_buffer.get_size() - string_off) / sizeof(uint16_t));
+
+	if (!num_chars)
+		return "";
+
+	return CUtil::utf16_to_utf8(m_byte_buffer.get_array_at<const uint8_t>(string_off, num_chars * sizeof(uint16_t)), num_chars);
+}
+
+const ImageResource* CX86PEProcessor::find_resource(uint16_t type) const
+{
+	auto iter = std::find_if(m_image_resources.begin(), m_image_resources.end(), [type](const ImageResource& resource) { return resource.is_type(type); });
+
+	return iter != m_image_resources.end() ? &*iter : nullptr;
+}
+
+// https://learn.microsoft.com/en-us/windows/win32/menurc/vs-versioninfo
+bool CX86PEProcessor::decode_version_info(const ImageResource& resource, ImageVersionInfo& info) const
+{
+	auto data = resource_data(resource);
+	auto base = reinterpret_cast<const uint8_t*>(data.data());
+
+	auto read_word = [base](size_t off) { return (uint16_t)(base[off] | (base[off + 1] << 8)); };
+	auto align = [](size_t off) { return (off + 3) & ~(size_t)3; };
+
+	// Every block is wLength, wValueLength, wType, a NUL-terminated UTF-16 key and the
+	// value, followed by its children. Offsets are aligned relative to the resource.
+	struct Block
+	{
+		std::string key;
+		size_t value_off, value_length, children_off, end;
+		bool is_text;
+	};
+
+	auto read_block = [&](size_t off, size_t parent_end, Block& block)
+	{
+		if (off + 6 > parent_end)
+			return false;
+
+		uint16_t length = read_word(off);
+		if (length < 6 || off + length > parent_end)
+			return false;
+
+		block.end = off + length;
+
+		size_t key_off = off + 6, key_end = key_off;
+		while (key_end + 2 <= block.end && read_word(key_end) != 0)
+			key_end += 2;
+
+		block.key = CUtil::utf16_to_utf8(base + key_off, (key_end - key_off) / 2);
+		block.is_text = read_word(off + 4) == 1;
+		block.value_off = std::min(align(key_end + 2), block.end);
+
+		// Text values are counted in characters, binary ones in bytes
+		block.value_length = std::min<size_t>(read_word(off + 2) * (block.is_text ? 2 : 1), block.end - block.value_off);
+		block.children_off = std::min(align(block.value_off + block.value_length), block.end);
+
+		return true;
+	};
+
+	Block root;
+	if (!read_block(0, data.size(), root) || root.key != "VS_VERSION_INFO")
+		return false;
+
+	if (root.value_length >= sizeof(pe::VsFixedFileInfo))
+	{
+		auto ffi = reinterpret_cast<const pe::VsFixedFileInfo*>(base + root.value_off);
+
+		if (ffi->dwSignature == pe::k_vs_ffi_signature)
 		{
-			CDebugConsole::get().output_message(std::format("  Data type 0x{:08X}", irde_type->OffsetToData));
+			auto version = [](uint32_t ms, uint32_t ls) { return std::format("{}.{}.{}.{}", ms >> 16, ms & 0xFFFF, ls >> 16, ls & 0xFFFF); };
+
+			info.m_file_version = version(ffi->dwFileVersionMS, ffi->dwFileVersionLS);
+			info.m_product_version = version(ffi->dwProductVersionMS, ffi->dwProductVersionLS);
 		}
+	}
+
+	// StringFileInfo -> string tables, one per language and codepage -> strings
+	Block file_info;
+	for (size_t off = root.children_off; read_block(off, root.end, file_info); off = align(file_info.end))
+	{
+		if (file_info.key != "StringFileInfo")
+			continue;
+
+		Block table;
+		for (size_t table_off = file_info.children_off; read_block(table_off, file_info.end, table); table_off = align(table.end))
+		{
+			Block string;
+			for (size_t string_off = table.children_off; read_block(string_off, table.end, string); string_off = align(string.end))
+			{
+				// The value is NUL-terminated as well
+				size_t num_chars = string.value_length / 2;
+				while (num_chars && read_word(string.value_off + (num_chars - 1) * 2) == 0)
+					num_chars--;
 
-		irde_type++;
+				info.m_strings.emplace_back(string.key, CUtil::utf16_to_utf8(base + string.value_off, num_chars));
+			}
+		}
 	}
+
+	return true;
 }
 
 void CX86PEProcessor::process_nt_data_dir_exceptions(const ImageDataDir& dir_entry)
 {
-	auto irfe = m_byte_buffer.get_at<IMAGE_RUNTIME_FUNCTION_ENTRY>(offset_relative_to_a_section(dir_entry.m_address));
-
 	// TODO: Couldn't find an executable that has this.
 
-	DebugBreak();
+	CDebugConsole::get().output_info<LogCategory::Parser>("Exception directory isn't supported yet.");
 }
 
 // https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#the-attribute-certificate-table-image-only
@@ -1544,9 +2445,9 @@ void CX86PEProcessor::process_nt_data_dir_certificates(const ImageDataDir& dir_e
 {
 	if (!dir_entry.m_size.is_aligned(8))
 	{
-		CDebugConsole::get().output_error(std::format("Cannot process image certificates because the size of data directory isn't"
-													  "aligned on the 8-byte boundary. The list seems to be corrupted. "
-													  "Missed by {} bytes", dir_entry.m_size % 8));
+		CDebugConsole::get().output_error("Cannot process image certificates because the size of data directory isn't"
+										  "aligned on the 8-byte boundary. The list seems to be corrupted. "
+										  "Missed by {} bytes", dir_entry.m_size % 8);
 		return;
 	}
 
@@ -1555,7 +2456,13 @@ void CX86PEProcessor::process_nt_data_dir_certificates(const ImageDataDir& dir_e
 	while (dir_entry.m_size > cert_total_size)
 	{
 		// The relative virtual addr is a file offset.
-		auto iwce = m_byte_buffer.get_at<WIN_CERTIFICATE>(dir_entry.m_address + cert_total_size);
+		auto iwce = m_byte_buffer.get_at<pe::WinCertificate>(dir_entry.m_address + cert_total_size);
+
+		if (!iwce)
+		{
+			report_malformed("Certificate entry");
+			break;
+		}
 
 		// Offset to next entry, aligned on a 8-byte boundary
 		uint32_t next_cert_aligned = iwce->dwLength;
@@ -1563,12 +2470,12 @@ void CX86PEProcessor::process_nt_data_dir_certificates(const ImageDataDir& dir_e
 		ImageWinCertificate win_cert;
 
 		win_cert.m_entry_length = iwce->dwLength;
-		win_cert.m_cert_raw_data_va = rva_as_va(dir_entry.m_address + offsetof(WIN_CERTIFICATE, bCertificate));
+		win_cert.m_cert_raw_data_va = rva_as_va(dir_entry.m_address + offsetof(pe::WinCertificate, bCertificate));
 
 		if (!win_cert.m_entry_length.is_aligned(8))
 		{
 			next_cert_aligned = (next_cert_aligned + 7) & ~7; // align to a 8-byte boundary
-			CDebugConsole::get().output_info("Warning, the windows certificate entry length wasn't aligned to an 8-byte boundary. "
+			CDebugConsole::get().output_info<LogCategory::Parser>("Warning, the windows certificate entry length wasn't aligned to an 8-byte boundary. "
 											 "Rounding up to that boundary.");
 		}
 
@@ -1581,77 +2488,96 @@ void CX86PEProcessor::process_nt_data_dir_certificates(const ImageDataDir& dir_e
 		num_certs++;
 	}
 
-	CDebugConsole::get().output_message(std::format("Processed {} image certificate{}", num_certs, num_certs > 1 ? "s" : ""));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Processed {} image certificate{}", num_certs, num_certs > 1 ? "s" : "");
 }
 
 // https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#the-reloc-section-image-only
 void CX86PEProcessor::process_nt_data_dir_relocs(const ImageDataDir& dir_entry)
 {
-	// Extended structure that also contains the word at the end.
-	struct IMAGE_BASE_RELOCATION_EXTENDED
+	uint32_t m_num_reloc_blocks = 0, read_bytes = 0;
+	bool invalid_type_reported = false;
+	while (read_bytes + sizeof(pe::ImageBaseRelocation) <= dir_entry.m_size)
 	{
-		IMAGE_BASE_RELOCATION	base_reloc;
-		WORD					type[1];
-	};
+		auto offset = offset_relative_to_a_section(dir_entry.m_address + read_bytes);
+		auto base_reloc = m_byte_buffer.get_at<pe::ImageBaseRelocation>(offset);
 
-	auto offset = offset_relative_to_a_section(dir_entry.m_address);
-	auto ibre = m_byte_buffer.get_at<IMAGE_BASE_RELOCATION_EXTENDED>(offset);
+		if (!base_reloc)
+			break;
 
-	if (!ibre->base_reloc.SizeOfBlock)
-	{
-		CDebugConsole::get().output_error("Base relocation block without size!");
-		return;
-	}
+		if (!base_reloc->SizeOfBlock)
+		{
+			if (!m_num_reloc_blocks)
+				CDebugConsole::get().output_error("Base relocation block without size!");
+			break;
+		}
 
-	uint32_t m_num_reloc_blocks = 0, read_bytes = 0;
-	while (read_bytes < dir_entry.m_size)
-	{
-		ImageRelocationBlock block;
+		if (!base_reloc->VirtualAddress)
+			break;
+
+		if (base_reloc->SizeOfBlock < sizeof(pe::ImageBaseRelocation) || offset + base_reloc->SizeOfBlock > m_byte_buffer.get_size())
+		{
+			CDebugConsole::get().output_error("Base relocation block at 0x{:08X} is out of bounds", offset);
+			break;
+		}
+
+		ImageRelocationBlock block(&m_arena);
 
-		block.m_page_rva = ibre->base_reloc.VirtualAddress;
-		block.m_size = ibre->base_reloc.SizeOfBlock;
+		block.m_page_rva = base_reloc->VirtualAddress;
+		block.m_size = base_reloc->SizeOfBlock;
 
-		if (!block.m_size || !block.m_page_rva)
+		// The type list follows the header up to the end of the block, every word
+		// holds the type in the upper 4 bits and the offset in the rest.
+		uint32_t num_words = (base_reloc->SizeOfBlock - sizeof(pe::ImageBaseRelocation)) / sizeof(uint16_t);
+		auto words = m_byte_buffer.get_array_at<const uint8_t>(offset + sizeof(pe::ImageBaseRelocation), num_words * sizeof(uint16_t));
+
+		if (num_words && !words)
 			break;
 
-		uint16_t* type = &ibre->type[0];
+		block.m_types.resize(num_words);
+		block.m_offsets.resize(num_words);
 
-		// Start here and walk the whole type list.
-		uint32_t off = sizeof(IMAGE_BASE_RELOCATION);
-		while (off <= block.m_size)
+		for (uint32_t i = 0; i < num_words; i++)
 		{
-			ImageRelocationBlock::BlockInfo info;
-
-			info.process_block_info_type(((*type) >> 12) && 0xF);
-			info.m_offset = (*type) & 0x0FFF;
+			uint16_t word;
+			std::memcpy(&word, words + i * sizeof(uint16_t), sizeof(uint16_t));
 
-			block.m_block_info_entries.emplace_back(info);
+			block.m_types[i] = word >> 12;
+			block.m_offsets[i] = word & 0x0FFF;
 
-			type++;
-			off += sizeof(uint16_t);
+			if (!invalid_type_reported && !ImageRelocationBlock::type_name(block.m_types[i]))
+			{
+				CDebugConsole::get().output_error("Invalid relocation block info type: 0x{:X}", block.m_types[i]);
+				invalid_type_reported = true;
+			}
 		}
 
-		m_relocation_blocks.emplace_back(block);
+		m_relocation_blocks.emplace_back(std::move(block));
 
-		read_bytes += ibre->base_reloc.SizeOfBlock;
-		ibre = m_byte_buffer.get_at<IMAGE_BASE_RELOCATION_EXTENDED>(offset_relative_to_a_section(dir_entry.m_address + read_bytes));
+		read_bytes += base_reloc->SizeOfBlock;
 
 		m_num_reloc_blocks++;
 	}
 
-	CDebugConsole::get().output_message(std::format("Found {} relocation block{}", m_num_reloc_blocks, m_num_reloc_blocks > 1 ? "s" : ""));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Found {} relocation block{}", m_num_reloc_blocks, m_num_reloc_blocks > 1 ? "s" : "");
 }
 
 // https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#the-debug-section
 void CX86PEProcessor::process_nt_data_dir_debug(const ImageDataDir& dir_entry)
 {
-	auto idd = m_byte_buffer.get_at<IMAGE_DEBUG_DIRECTORY>(offset_relative_to_a_section(dir_entry.m_address));
+	uint64_t idd_off = offset_relative_to_a_section(dir_entry.m_address);
+	uint32_t num_debug_dirs = dir_entry.m_size / sizeof(pe::ImageDebugDirectory);
 
+	// The whole array has to be there, it's tiny anyway
+	auto idd = m_byte_buffer.get_array_at<pe::ImageDebugDirectory>(idd_off, num_debug_dirs);
 
-	if (idd->Characteristics != NULL)
-		CDebugConsole::get().output_info(std::format("Warning, characteristics field inside debug directory should be null: 0x{:08X}", idd->Characteristics));
+	if (num_debug_dirs && !idd)
+	{
+		report_malformed("Debug directory");
+		return;
+	}
 
-	uint32_t num_debug_dirs = dir_entry.m_size / sizeof(IMAGE_DEBUG_DIRECTORY);
+	if (num_debug_dirs && idd->Characteristics != NULL)
+		CDebugConsole::get().output_info<LogCategory::Parser>("Warning, characteristics field inside debug directory should be null: 0x{:08X}", idd->Characteristics);
 
 	for (uint32_t i = 0; i < num_debug_dirs; i++)
 	{
@@ -1669,20 +2595,24 @@ void CX86PEProcessor::process_nt_data_dir_debug(const ImageDataDir& dir_entry)
 
 		// Process each debug directory type..
 
-		auto process_type_data = [&](ImageDebugDirectory* pobj, void(ImageDebugDirectory::*process_func)(const ByteBuffer<uint32_t>&),
+		auto process_type_data = [&](ImageDebugDirectory* pobj, bool(ImageDebugDirectory::*process_func)(const ByteBuffer<uint64_t>&),
 									 const std::string& name, uint32_t supposed_type)
 		{
 			if (supposed_type != idd->Type)
 				return;
 
-			CDebugConsole::get().output_message(std::format("Processing '{}' debug directory type data", name));
+			CDebugConsole::get().output_verbose<LogCategory::Parser>("Processing '{}' debug directory type data", name);
 
-			(pobj->*process_func)(m_byte_buffer);
+			if (!(pobj->*process_func)(m_byte_buffer))
+			{
+				report_malformed("Debug directory data");
+				return;
+			}
 
-			CDebugConsole::get().output_message(std::format("Processed '{}' debug directory type data", name));
+			CDebugConsole::get().output_verbose<LogCategory::Parser>("Processed '{}' debug directory type data", name);
 		};
 
-		process_type_data(&debug, &ImageDebugDirectory::process_type_cv, "CodeView", IMAGE_DEBUG_TYPE_CODEVIEW);
+		process_type_data(&debug, &ImageDebugDirectory::process_type_cv, "CodeView", pe::k_debug_type_codeview);
 
 		// Note: Idk if there's actually point in processing more types. As I've looked through the 
 		//		 NT 5.1 source code, a majority of these types aren't process anywhere. The codeView
@@ -1695,80 +2625,99 @@ void CX86PEProcessor::process_nt_data_dir_debug(const ImageDataDir& dir_entry)
 		idd++;
 	}
 
-	CDebugConsole::get().output_message(std::format("Found {} data director{}", num_debug_dirs, num_debug_dirs > 1 ? "ies" : "y"));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Found {} data director{}", num_debug_dirs, num_debug_dirs > 1 ? "ies" : "y");
 }
 
 void CX86PEProcessor::process_nt_data_dir_arch(const ImageDataDir& dir_entry)
 {
 	if (dir_entry.m_size != 0 || dir_entry.m_address != 0)
-		CDebugConsole::get().output_info("Warning, architecture data directory fields should be zero!");
+		CDebugConsole::get().output_info<LogCategory::Parser>("Warning, architecture data directory fields should be zero!");
 }
 
 void CX86PEProcessor::process_nt_data_dir_global_ptr(const ImageDataDir& dir_entry)
 {
 	auto gptr_addr = m_byte_buffer.get_at<uint32_t>(offset_relative_to_a_section(dir_entry.m_address));
 
-	m_global_ptr_register = reinterpret_cast<uint32_t>(gptr_addr);
-
-	// TODO: Test on an executable
+	if (!gptr_addr)
+	{
+		report_malformed("Global pointer");
+		return;
+	}
+
+	m_global_ptr_register = *gptr_addr;
+
+	// TODO: Test on an executable
 
-	CDebugConsole::get().output_message(std::format("The global pointer register value is {}", m_global_ptr_register.as_string()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("The global pointer register value is {}", m_global_ptr_register.as_string());
 }
 
 // https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#the-tls-section
 // Tested on C:\\Windows\\SysWOW64\\aadtb.dll
+template<typename Traits>
 void CX86PEProcessor::process_nt_data_dir_tls(const ImageDataDir& dir_entry)
 {
-	auto itd = m_byte_buffer.get_at<IMAGE_TLS_DIRECTORY>(offset_relative_to_a_section(dir_entry.m_address));
+	auto itd = m_byte_buffer.get_at<typename Traits::TlsDirectory>(offset_relative_to_a_section(dir_entry.m_address));
+
+	if (!itd)
+	{
+		report_malformed("TLS directory");
+		return;
+	}
 
 	m_tls_raw_data_start_va = itd->StartAddressOfRawData;
 	m_tls_raw_data_end_va = itd->EndAddressOfRawData;
-	m_tls_raw_data_size = m_tls_raw_data_end_va - m_tls_raw_data_start_va;
+	m_tls_raw_data_size = (uint32_t)(m_tls_raw_data_end_va - m_tls_raw_data_start_va);
 	m_tls_index_va = itd->AddressOfIndex;
 	m_tls_size_of_zero_fill = itd->SizeOfZeroFill;
 	m_tls_base_of_callbacks_va = itd->AddressOfCallBacks;
 
 	uint32_t num_callbacks = 0;
 
-	auto callback_pfn = m_byte_buffer.get_at<uint32_t>(offset_relative_to_a_section(va_as_rva(m_tls_base_of_callbacks_va)));
-
-	// The first entry is nulled. We have to offset to the second entry 
-	// in order to find rvas.
-	callback_pfn = reinterpret_cast<uint32_t*>((uint8_t*)callback_pfn + sizeof(uint32_t));
+	// The callbacks are a null-terminated array of VAs, as wide as any other address
+	// inside of the image. Nothing keeps the array aligned.
+	uint64_t callback_off = m_tls_base_of_callbacks_va ? offset_relative_to_a_section(va_as_rva(m_tls_base_of_callbacks_va)) : 0;
 
-	while (true)
+	while (callback_off)
 	{
-		// So at the memory location there's a RVA. This RVA is
-		// relative to the base address of an image, so adding
-		// the base address to it locates the start of the callback
-		// function.
-		auto callback_rva = *(uint32_t*)callback_pfn;
-		auto callback_va = rva_as_va(callback_rva);
+		auto callback_bytes = m_byte_buffer.get_array_at<const uint8_t>(callback_off, sizeof(typename Traits::Address));
+
+		if (!callback_bytes)
+		{
+			report_malformed("TLS callback");
+			break;
+		}
 
-		if (callback_rva == NULL)
+		typename Traits::Address callback_va;
+		std::memcpy(&callback_va, callback_bytes, sizeof(callback_va));
+
+		if (callback_va == NULL)
 			break; // End of the list right here.
 
 		m_tls_callbacks_va.emplace_back(callback_va);
 
-		//CDebugConsole::get().output_message(std::format("Got callback at 0x{:08X} (rva=0x{:08X})", callback_va, callback_rva));
-
-		// There's a one byte gap between each entry. 
-		callback_pfn = reinterpret_cast<uint32_t*>((uint8_t*)callback_pfn + sizeof(uint32_t) + sizeof(uint8_t));
+		callback_off += sizeof(typename Traits::Address);
 		num_callbacks++;
 	}
 
-	CDebugConsole::get().output_message(std::format("Processed {} callback{}", num_callbacks, num_callbacks > 1 ? "s" : ""));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Processed {} callback{}", num_callbacks, num_callbacks > 1 ? "s" : "");
 }
 
 // Tested on C:\Windows\SysWOW64\bcd.dll
+template<typename Traits>
 void CX86PEProcessor::process_nt_data_dir_load_cfg(const ImageDataDir& dir_entry)
 {
-	auto ilcd = m_byte_buffer.get_at<IMAGE_LOAD_CONFIG_DIRECTORY>(offset_relative_to_a_section(dir_entry.m_address));
+	auto ilcd = m_byte_buffer.get_at<typename Traits::LoadConfigDirectory>(offset_relative_to_a_section(dir_entry.m_address));
+
+	if (!ilcd)
+	{
+		report_malformed("Load config directory");
+		return;
+	}
 
-	if (ilcd->Size != sizeof(IMAGE_LOAD_CONFIG_DIRECTORY))
+	if (ilcd->Size != sizeof(typename Traits::LoadConfigDirectory))
 	{
-		CDebugConsole::get().output_error(std::format("Size of load config directory isn't the same as ours. (ours 0x{:08X} but got 0x{:08X})", 
-			sizeof(IMAGE_LOAD_CONFIG_DIRECTORY), ilcd->Size));
+		CDebugConsole::get().output_error("Size of load config directory isn't the same as ours. (ours 0x{:08X} but got 0x{:08X})", 
+			sizeof(typename Traits::LoadConfigDirectory), ilcd->Size);
 		return;
 	}
 
@@ -1818,8 +2767,8 @@ void CX86PEProcessor::process_nt_data_dir_load_cfg(const ImageDataDir& dir_entry
 
 	if (ilcd->Reserved2 != 0)
 	{
-		CDebugConsole::get().output_info(std::format("Warning, 0x{:08X} field inside IMAGE_LOAD_CONFIG_DIRECTORY (Reserved2) should be zero. (val=0x{:08X})",
-			offsetof(IMAGE_LOAD_CONFIG_DIRECTORY, Reserved2), ilcd->Reserved2));
+		CDebugConsole::get().output_info<LogCategory::Parser>("Warning, 0x{:08X} field inside IMAGE_LOAD_CONFIG_DIRECTORY (Reserved2) should be zero. (val=0x{:08X})",
+			offsetof(typename Traits::LoadConfigDirectory, Reserved2), ilcd->Reserved2);
 	}
 
 	m_load_cfg_guard_rf_verify_stack_ptr_func_ptr_va = ilcd->GuardRFVerifyStackPointerFunctionPointer;
@@ -1827,8 +2776,8 @@ void CX86PEProcessor::process_nt_data_dir_load_cfg(const ImageDataDir& dir_entry
 
 	if (ilcd->Reserved3 != 0)
 	{
-		CDebugConsole::get().output_info(std::format("Warning, 0x{:08X} field inside IMAGE_LOAD_CONFIG_DIRECTORY (Reserved3) should be zero. (val=0x{:08X})",
-			offsetof(IMAGE_LOAD_CONFIG_DIRECTORY, Reserved3), ilcd->Reserved3));
+		CDebugConsole::get().output_info<LogCategory::Parser>("Warning, 0x{:08X} field inside IMAGE_LOAD_CONFIG_DIRECTORY (Reserved3) should be zero. (val=0x{:08X})",
+			offsetof(typename Traits::LoadConfigDirectory, Reserved3), ilcd->Reserved3);
 	}
 
 	m_load_cfg_enclave_config_ptr_va = ilcd->EnclaveConfigurationPointer;
@@ -1842,10 +2791,11 @@ void CX86PEProcessor::process_nt_data_dir_bound_import(const ImageDataDir& dir_e
 	// Unused in almost all images on the newer versions of the OS.. Probably no
 	// need to process at all.
 
-	DebugBreak();
+	CDebugConsole::get().output_info<LogCategory::Parser>("Bound import directory isn't supported yet.");
 }
 
 // https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#import-address-table
+template<typename Traits>
 void CX86PEProcessor::process_nt_data_dir_iat(const ImageDataDir& dir_entry)
 {
 	// Note: Theoretically, from our perspective, processing this is useless. 
@@ -1855,129 +2805,159 @@ void CX86PEProcessor::process_nt_data_dir_iat(const ImageDataDir& dir_entry)
 	// in this particular case..
 	m_imports_iat_base = rva_as_va(dir_entry.m_address);
 
-	uint32_t num_of_entries = dir_entry.m_size / sizeof(uint32_t);
+	uint32_t num_of_entries = dir_entry.m_size / sizeof(typename Traits::Address);
+
+	build_iat_slot_owners();
+
+	if (m_iat_slot_owners.empty())
+		CDebugConsole::get().output_error("Can't assign iat entries to import thunks because there aren't any import descriptors!");
+
+	m_iat_entries.reserve(num_of_entries);
 
 	for (uint32_t i = 0; i < num_of_entries; i++)
 	{
 		ImageIATEntry iat_entry;
 
-		iat_entry.m_va = m_imports_iat_base + (i * sizeof(uint32_t));
+		iat_entry.m_va = m_imports_iat_base + (i * sizeof(typename Traits::Address));
 
 		if (!iat_entry.m_va)
 			continue; // If the address is null, then it's most likely a descriptor entry.
 
 		// Inside IAT, there are some regions between thunks and another descriptors where there aren't
 		// any addresses. Basically sort of a padding or something. Ignore these.
-		auto data_at_address = *m_byte_buffer.get_at<uint32_t>(offset_relative_to_a_section(dir_entry.m_address + (i * sizeof(uint32_t))));
-		if (data_at_address == 0)
+		auto data_at_address = m_byte_buffer.get_at<typename Traits::Address>(offset_relative_to_a_section(dir_entry.m_address + (i * sizeof(typename Traits::Address))));
+
+		if (!data_at_address)
+		{
+			report_malformed("IAT entry");
+			break;
+		}
+
+		if (*data_at_address == 0)
 			continue;
 
-		// set to true if we have found match inside the descriptor-thunk list.
-		bool found_match = false;
+		// Find the right import thunk or descriptor by the va.
+		auto owner = m_iat_slot_owners.find(iat_entry.m_va);
 
-		// Find the right import thunk by the rva.
-		if (!m_image_import_descriptors.empty())
+		if (owner != m_iat_slot_owners.end())
 		{
-			for (auto& descriptor : m_image_import_descriptors)
-			{
-				if (descriptor.has_thunks())
-				{
-					for (auto& thunk : descriptor.m_import_thunks)
-					{
-						if (thunk.m_import_va == iat_entry.m_va)
-						{
-							found_match = true;
-							iat_entry.m_refered_thunk_or_descriptor_name = thunk.m_name;
-						}
-					}
-
-					// If we still haven't found one, there's a possibility that
-					// this va belongs to a descriptor, not to a thunk.
-					if (!found_match)
-					{
-						if (iat_entry.m_va == descriptor.m_descriptor_va)
-						{
-							found_match = true;
-							iat_entry.m_refered_thunk_or_descriptor_name = descriptor.m_image_name;
-						}
-					}
-				}
-				else
-				{
-					CDebugConsole::get().output_error(std::format("Can't assign iat entries to import thunks for {} because it has no thunks!", descriptor.m_image_name));
-				}
-			}
+			iat_entry.m_refered_thunk_or_descriptor_name = owner->second;
 		}
 		else
-		{
-			CDebugConsole::get().output_error("Can't assign iat entries to import thunks because there aren't any import descriptors!");
-		}
-
-		if (!found_match)
 		{
 			iat_entry.m_refered_thunk_or_descriptor_name = "unknown";
-			CDebugConsole::get().output_error(std::format("Couldn't find a thunk for iat entry {}", iat_entry.m_va.as_string()));
+			CDebugConsole::get().output_error("Couldn't find a thunk for iat entry {}", iat_entry.m_va.as_string());
 		}
 
 		m_iat_entries.emplace_back(iat_entry);
 	}
 
-	CDebugConsole::get().output_message(std::format("Processed {} IAT entries", num_of_entries));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Processed {} IAT entries", num_of_entries);
+}
+
+// Runs after both of the import directories have been processed. Regular imports
+// take precedence when both of them claim the same slot.
+void CX86PEProcessor::build_iat_slot_owners()
+{
+	auto add_slot_owners = [&](const auto& descriptors)
+	{
+		for (const auto& descriptor : descriptors)
+		{
+			for (const auto& thunk : descriptor.m_import_thunks)
+			{
+				m_iat_slot_owners.try_emplace(thunk.m_import_va, thunk.m_name);
+			}
+
+			// At the end of thunk data, the virtual address corresponds to the descriptor.
+			m_iat_slot_owners.try_emplace(descriptor.m_descriptor_va, descriptor.m_image_name);
+		}
+	};
+
+	add_slot_owners(m_image_import_descriptors);
+	add_slot_owners(m_image_delayed_import_descriptors);
 }
 
 // https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#delay-load-import-tables-image-only
+template<typename Traits>
 void CX86PEProcessor::process_nt_data_dir_delay_import(const ImageDataDir& dir_entry)
 {
-	auto idd = m_byte_buffer.get_at<ImgDelayDescr>(offset_relative_to_a_section(dir_entry.m_address));
+	uint64_t idd_off = offset_relative_to_a_section(dir_entry.m_address);
 
-	while (idd->rvaINT != NULL)
+	for (;; idd_off += sizeof(pe::ImageDelayLoadDescriptor))
 	{
-		ImageDelayedImportDescriptor import_descriptor;
+		auto idd = m_byte_buffer.get_at<pe::ImageDelayLoadDescriptor>(idd_off);
+
+		if (!idd)
+		{
+			report_malformed("Delayed import descriptor");
+			break;
+		}
+
+		if (idd->rvaINT == NULL)
+			break;
+
+		ImageDelayedImportDescriptor import_descriptor(&m_arena);
 
-		if (idd->grAttrs & dlattrRva)
-			import_descriptor.m_image_name = m_byte_buffer.get_at<const char>(offset_relative_to_a_section(idd->rvaDLLName));
+		if (idd->grAttrs & pe::k_dlattr_rva)
+			import_descriptor.m_image_name = m_byte_buffer.get_cstring_at(offset_relative_to_a_section(idd->rvaDLLName));
 		else
-			import_descriptor.m_image_name = m_byte_buffer.get_at<const char>(offset_relative_to_a_section(va_as_rva(idd->rvaDLLName)));
+			import_descriptor.m_image_name = m_byte_buffer.get_cstring_at(offset_relative_to_a_section(va_as_rva(idd->rvaDLLName)));
 
-		PIMAGE_THUNK_DATA thunk_data;
+		uint64_t thunk_data_off;
 
-		if (idd->grAttrs & dlattrRva)
-			thunk_data = m_byte_buffer.get_at<IMAGE_THUNK_DATA>(offset_relative_to_a_section(idd->rvaINT));
+		if (idd->grAttrs & pe::k_dlattr_rva)
+			thunk_data_off = offset_relative_to_a_section(idd->rvaINT);
 		else
-			thunk_data = m_byte_buffer.get_at<IMAGE_THUNK_DATA>(offset_relative_to_a_section(va_as_rva(idd->rvaINT)));
+			thunk_data_off = offset_relative_to_a_section(va_as_rva(idd->rvaINT));
 
 		import_descriptor.m_timestamp = idd->dwTimeStamp;
 
 		// Base address of the iat for this delayed import descriptor.
-		uint32_t descriptor_import_addrs_base_va = rva_as_va(idd->rvaIAT);
+		uint64_t descriptor_import_addrs_base_va = rva_as_va(idd->rvaIAT);
 
 		// Loop through all descriptor thunks (imported functions) and process them
-		while (thunk_data->u1.AddressOfData != NULL)
+		for (;; thunk_data_off += sizeof(typename Traits::ThunkData))
 		{
+			auto thunk_data = m_byte_buffer.get_at<typename Traits::ThunkData>(thunk_data_off);
+
+			if (!thunk_data)
+			{
+				report_malformed("Delayed import thunk");
+				break;
+			}
+
+			if (thunk_data->u1.AddressOfData == NULL)
+				break;
+
 			ImageImportThunk import_thunk;
 
 			// Check if the most-significant ordinal bit is set, if yes, we're importing
 			// by an ordinal, not by a function name. We have to handle this..
-			if (IMAGE_SNAP_BY_ORDINAL(thunk_data->u1.Ordinal))
+			if (Traits::snap_by_ordinal(thunk_data->u1.Ordinal))
 			{
-				import_thunk.m_ordinal = IMAGE_ORDINAL(thunk_data->u1.Ordinal);
+				import_thunk.m_ordinal = pe::ordinal(thunk_data->u1.Ordinal);
 				import_thunk.m_name = "";
 				import_thunk.m_hint = 0;
 				m_number_of_delayed_import_thunk_ordinals++;
 			}
 			else
 			{
-				PIMAGE_IMPORT_BY_NAME import_name;
+				uint64_t import_name_off;
 
 				// We search for name only when thunk isn't snapped by an ordinal.
-				if (idd->grAttrs & dlattrRva)
-					import_name = m_byte_buffer.get_at<IMAGE_IMPORT_BY_NAME>(offset_relative_to_a_section(thunk_data->u1.AddressOfData));
+				if (idd->grAttrs & pe::k_dlattr_rva)
+					import_name_off = offset_relative_to_a_section(thunk_data->u1.AddressOfData);
 				else
-					import_name = m_byte_buffer.get_at<IMAGE_IMPORT_BY_NAME>(offset_relative_to_a_section(va_as_rva(thunk_data->u1.AddressOfData)));
+					import_name_off = offset_relative_to_a_section(va_as_rva(thunk_data->u1.AddressOfData));
+
+				auto import_name = m_byte_buffer.get_at<pe::ImageImportByName>(import_name_off);
+
+				if (!import_name)
+					report_malformed("Delayed import name");
 
 				import_thunk.m_ordinal = 0;
-				import_thunk.m_name = import_name->Name;
-				import_thunk.m_hint = import_name->Hint;
+				import_thunk.m_name = m_byte_buffer.get_cstring_at(import_name_off + offsetof(pe::ImageImportByName, Name));
+				import_thunk.m_hint = import_name ? import_name->Hint : 0;
 				m_number_of_delayed_import_thunk_names++;
 			}
 
@@ -1986,61 +2966,58 @@ void CX86PEProcessor::process_nt_data_dir_delay_import(const ImageDataDir& dir_e
 
 			import_descriptor.m_import_thunks.emplace_back(import_thunk);
 
-			thunk_data++;
-			descriptor_import_addrs_base_va += sizeof(uint32_t);
+			descriptor_import_addrs_base_va += sizeof(typename Traits::Address);
 		}
 
 		// At the end of thunk data, the virtual address corresponds not to
 		// an import va but to descriptor va.
 		import_descriptor.m_descriptor_va = descriptor_import_addrs_base_va;
 
-		m_image_delayed_import_descriptors.emplace_back(import_descriptor);
+		m_image_delayed_import_descriptors.emplace_back(std::move(import_descriptor));
 		m_number_of_delayed_import_descriptors++;
-
-		idd++;
 	}
 
-	CDebugConsole::get().output_message(std::format("Found {} thunks inside {} delayed import descriptors.",
-													m_number_of_delayed_import_thunk_ordinals + m_number_of_delayed_import_thunk_names,
-													m_number_of_delayed_import_descriptors));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Found {} thunks inside {} delayed import descriptors.",
+										m_number_of_delayed_import_thunk_ordinals + m_number_of_delayed_import_thunk_names,
+										m_number_of_delayed_import_descriptors);
 }
 
 void CX86PEProcessor::process_nt_data_dir_clr_runtime(const ImageDataDir& dir_entry)
 {
-	DebugBreak();
+	CDebugConsole::get().output_info<LogCategory::Parser>("CLR runtime directory isn't supported yet.");
 }
 
 void CX86PEProcessor::process_nt_machine(uint16_t machine)
 {
 	switch (machine)
 	{
-		case IMAGE_FILE_MACHINE_UNKNOWN: m_nt_machine = { IMAGE_FILE_MACHINE_UNKNOWN, "Unknown" }; break;
-		case IMAGE_FILE_MACHINE_AM33: m_nt_machine = { IMAGE_FILE_MACHINE_AM33, "AM33" }; break;
-		case IMAGE_FILE_MACHINE_AMD64: m_nt_machine = { IMAGE_FILE_MACHINE_AMD64, "AM64" }; break;
-		case IMAGE_FILE_MACHINE_ARM: m_nt_machine = { IMAGE_FILE_MACHINE_ARM, "ARM" }; break;
-		case IMAGE_FILE_MACHINE_ARM64: m_nt_machine = { IMAGE_FILE_MACHINE_ARM64, "ARM64" }; break;
-		case IMAGE_FILE_MACHINE_ARMNT: m_nt_machine = { IMAGE_FILE_MACHINE_ARMNT, "ARMNT" }; break;
-		case IMAGE_FILE_MACHINE_EBC: m_nt_machine = { IMAGE_FILE_MACHINE_EBC, "EBC" }; break;
-		case IMAGE_FILE_MACHINE_I386: m_nt_machine = { IMAGE_FILE_MACHINE_I386, "I386" }; break;
-		case IMAGE_FILE_MACHINE_IA64: m_nt_machine = { IMAGE_FILE_MACHINE_IA64, "IA64" }; break;
-		case IMAGE_FILE_MACHINE_M32R: m_nt_machine = { IMAGE_FILE_MACHINE_M32R, "M32R" }; break;
-		case IMAGE_FILE_MACHINE_MIPS16: m_nt_machine = { IMAGE_FILE_MACHINE_MIPS16, "MIPS16" }; break;
-		case IMAGE_FILE_MACHINE_MIPSFPU: m_nt_machine = { IMAGE_FILE_MACHINE_MIPSFPU, "MIPSFPU" }; break;
-		case IMAGE_FILE_MACHINE_MIPSFPU16: m_nt_machine = { IMAGE_FILE_MACHINE_MIPSFPU16, "MIPSFPU16" }; break;
-		case IMAGE_FILE_MACHINE_POWERPC: m_nt_machine = { IMAGE_FILE_MACHINE_POWERPC, "POWERPC" }; break;
-		case IMAGE_FILE_MACHINE_POWERPCFP: m_nt_machine = { IMAGE_FILE_MACHINE_POWERPCFP, "POWERPCFP" }; break;
-		case IMAGE_FILE_MACHINE_R4000: m_nt_machine = { IMAGE_FILE_MACHINE_R4000, "R4000" }; break;
-		case IMAGE_FILE_MACHINE_SH3: m_nt_machine = { IMAGE_FILE_MACHINE_SH3, "SH3" }; break;
-		case IMAGE_FILE_MACHINE_SH3DSP: m_nt_machine = { IMAGE_FILE_MACHINE_SH3DSP, "SH3DSP" }; break;
-		case IMAGE_FILE_MACHINE_SH5: m_nt_machine = { IMAGE_FILE_MACHINE_SH5, "SH5" }; break;
-		case IMAGE_FILE_MACHINE_SH4: m_nt_machine = { IMAGE_FILE_MACHINE_SH4, "SH4" }; break;
-		case IMAGE_FILE_MACHINE_THUMB: m_nt_machine = { IMAGE_FILE_MACHINE_THUMB, "THUMB" }; break;
-		case IMAGE_FILE_MACHINE_WCEMIPSV2: m_nt_machine = { IMAGE_FILE_MACHINE_WCEMIPSV2, "WCEMIPSV2" }; break;
-		case IMAGE_FILE_MACHINE_TARGET_HOST: m_nt_machine = { IMAGE_FILE_MACHINE_TARGET_HOST, "TARGET_HOST" }; break;
-		case IMAGE_FILE_MACHINE_ALPHA: m_nt_machine = { IMAGE_FILE_MACHINE_ALPHA, "ALPHA" }; break;
-		case IMAGE_FILE_MACHINE_TRICORE: m_nt_machine = { IMAGE_FILE_MACHINE_TRICORE, "TRICORE" }; break;
-		case IMAGE_FILE_MACHINE_CEF: m_nt_machine = { IMAGE_FILE_MACHINE_CEF, "CEF" }; break;
-		case IMAGE_FILE_MACHINE_CEE: m_nt_machine = { IMAGE_FILE_MACHINE_CEE, "CEE" }; break;
+		case pe::k_file_machine_unknown: m_nt_machine = { pe::k_file_machine_unknown, "Unknown" }; break;
+		case pe::k_file_machine_am33: m_nt_machine = { pe::k_file_machine_am33, "AM33" }; break;
+		case pe::k_file_machine_amd64: m_nt_machine = { pe::k_file_machine_amd64, "AMD64" }; break;
+		case pe::k_file_machine_arm: m_nt_machine = { pe::k_file_machine_arm, "ARM" }; break;
+		case pe::k_file_machine_arm64: m_nt_machine = { pe::k_file_machine_arm64, "ARM64" }; break;
+		case pe::k_file_machine_armnt: m_nt_machine = { pe::k_file_machine_armnt, "ARMNT" }; break;
+		case pe::k_file_machine_ebc: m_nt_machine = { pe::k_file_machine_ebc, "EBC" }; break;
+		case pe::k_file_machine_i386: m_nt_machine = { pe::k_file_machine_i386, "I386" }; break;
+		case pe::k_file_machine_ia64: m_nt_machine = { pe::k_file_machine_ia64, "IA64" }; break;
+		case pe::k_file_machine_m32r: m_nt_machine = { pe::k_file_machine_m32r, "M32R" }; break;
+		case pe::k_file_machine_mips16: m_nt_machine = { pe::k_file_machine_mips16, "MIPS16" }; break;
+		case pe::k_file_machine_mipsfpu: m_nt_machine = { pe::k_file_machine_mipsfpu, "MIPSFPU" }; break;
+		case pe::k_file_machine_mipsfpu16: m_nt_machine = { pe::k_file_machine_mipsfpu16, "MIPSFPU16" }; break;
+		case pe::k_file_machine_powerpc: m_nt_machine = { pe::k_file_machine_powerpc, "POWERPC" }; break;
+		case pe::k_file_machine_powerpcfp: m_nt_machine = { pe::k_file_machine_powerpcfp, "POWERPCFP" }; break;
+		case pe::k_file_machine_r4000: m_nt_machine = { pe::k_file_machine_r4000, "R4000" }; break;
+		case pe::k_file_machine_sh3: m_nt_machine = { pe::k_file_machine_sh3, "SH3" }; break;
+		case pe::k_file_machine_sh3dsp: m_nt_machine = { pe::k_file_machine_sh3dsp, "SH3DSP" }; break;
+		case pe::k_file_machine_sh5: m_nt_machine = { pe::k_file_machine_sh5, "SH5" }; break;
+		case pe::k_file_machine_sh4: m_nt_machine = { pe::k_file_machine_sh4, "SH4" }; break;
+		case pe::k_file_machine_thumb: m_nt_machine = { pe::k_file_machine_thumb, "THUMB" }; break;
+		case pe::k_file_machine_wcemipsv2: m_nt_machine = { pe::k_file_machine_wcemipsv2, "WCEMIPSV2" }; break;
+		case pe::k_file_machine_target_host: m_nt_machine = { pe::k_file_machine_target_host, "TARGET_HOST" }; break;
+		case pe::k_file_machine_alpha: m_nt_machine = { pe::k_file_machine_alpha, "ALPHA" }; break;
+		case pe::k_file_machine_tricore: m_nt_machine = { pe::k_file_machine_tricore, "TRICORE" }; break;
+		case pe::k_file_machine_cef: m_nt_machine = { pe::k_file_machine_cef, "CEF" }; break;
+		case pe::k_file_machine_cee: m_nt_machine = { pe::k_file_machine_cee, "CEE" }; break;
 
 		default:
 			m_nt_machine = { machine, std::format("0x{:04X}", machine) };
@@ -2048,24 +3025,27 @@ void CX86PEProcessor::process_nt_machine(uint16_t machine)
 			break;
 	}
 
-	CDebugConsole::get().output_message(std::format("Machine type: {}", m_nt_machine.name()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Machine type: {}", m_nt_machine.name());
 }
 
 bool CX86PEProcessor::process_nt_magic(uint16_t magic)
 {
 	switch (magic)
 	{
-		case IMAGE_NT_OPTIONAL_HDR32_MAGIC: m_nt_magic = { IMAGE_NT_OPTIONAL_HDR32_MAGIC, "PE32" }; break;
-		case IMAGE_NT_OPTIONAL_HDR64_MAGIC: m_nt_magic = { IMAGE_NT_OPTIONAL_HDR64_MAGIC, "PE32+" }; break;
-		case IMAGE_ROM_OPTIONAL_HDR_MAGIC: m_nt_magic = { IMAGE_ROM_OPTIONAL_HDR_MAGIC, "ROM" }; break;
+		case pe::k_nt_optional_hdr32_magic: m_nt_magic = { pe::k_nt_optional_hdr32_magic, "PE32" }; break;
+		case pe::k_nt_optional_hdr64_magic: m_nt_magic = { pe::k_nt_optional_hdr64_magic, "PE32+" }; break;
+		case pe::k_rom_optional_hdr_magic: // Has a header of its own that we don't describe
+			m_nt_magic = { pe::k_rom_optional_hdr_magic, "ROM" };
+			CDebugConsole::get().output_error("Unable to process ROM images.");
+			return false;
 
 		default: // This is critical, we have to fail
 			m_nt_magic = { magic, std::format("0x{:04X}", magic) };
-			CDebugConsole::get().output_error(std::format("Invalid NT optional hdr magic: {}", m_nt_magic.name()));
+			CDebugConsole::get().output_error("Invalid NT optional hdr magic: {}", m_nt_magic.name());
 			return false;
 	}
 
-	CDebugConsole::get().output_message(std::format("NT optional header magic: {}", m_nt_magic.name()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("NT optional header magic: {}", m_nt_magic.name());
 	return true;
 }
 
@@ -2073,20 +3053,20 @@ void CX86PEProcessor::process_nt_subsystem(uint32_t subsystem)
 {
 	switch (subsystem)
 	{
-		case IMAGE_SUBSYSTEM_UNKNOWN: m_nt_subsystem = { IMAGE_SUBSYSTEM_UNKNOWN, "Unknown" }; break;
-		case IMAGE_SUBSYSTEM_NATIVE: m_nt_subsystem = { IMAGE_SUBSYSTEM_NATIVE, "NATIVE" }; break;
-		case IMAGE_SUBSYSTEM_WINDOWS_GUI: m_nt_subsystem = { IMAGE_SUBSYSTEM_NATIVE, "GUI" }; break;
-		case IMAGE_SUBSYSTEM_WINDOWS_CUI: m_nt_subsystem = { IMAGE_SUBSYSTEM_WINDOWS_CUI, "CUI" }; break;
-		case IMAGE_SUBSYSTEM_OS2_CUI: m_nt_subsystem = { IMAGE_SUBSYSTEM_OS2_CUI, "OS2 CUI" }; break;
-		case IMAGE_SUBSYSTEM_POSIX_CUI: m_nt_subsystem = { IMAGE_SUBSYSTEM_POSIX_CUI, "POSIX CUI" }; break;
-		case IMAGE_SUBSYSTEM_NATIVE_WINDOWS: m_nt_subsystem = { IMAGE_SUBSYSTEM_NATIVE_WINDOWS, "NATIVE WINDOWS" }; break;
-		case IMAGE_SUBSYSTEM_WINDOWS_CE_GUI: m_nt_subsystem = { IMAGE_SUBSYSTEM_WINDOWS_CE_GUI, "CE GUI" }; break;
-		case IMAGE_SUBSYSTEM_EFI_APPLICATION: m_nt_subsystem = { IMAGE_SUBSYSTEM_EFI_APPLICATION, "EFI APPLICATION" }; break;
-		case IMAGE_SUBSYSTEM_EFI_BOOT_SERVICE_DRIVER: m_nt_subsystem = { IMAGE_SUBSYSTEM_EFI_BOOT_SERVICE_DRIVER, "BOOT SERVICE DRIVER" }; break;
-		case IMAGE_SUBSYSTEM_EFI_RUNTIME_DRIVER: m_nt_subsystem = { IMAGE_SUBSYSTEM_EFI_RUNTIME_DRIVER, "EFI RUNTIME DRIVER" }; break;
-		case IMAGE_SUBSYSTEM_EFI_ROM: m_nt_subsystem = { IMAGE_SUBSYSTEM_EFI_ROM, "EFI ROM" }; break;
-		case IMAGE_SUBSYSTEM_XBOX: m_nt_subsystem = { IMAGE_SUBSYSTEM_XBOX, "XBOX" }; break;
-		case IMAGE_SUBSYSTEM_WINDOWS_BOOT_APPLICATION: m_nt_subsystem = { IMAGE_SUBSYSTEM_WINDOWS_BOOT_APPLICATION, "BOOT APP" }; break;
+		case pe::k_subsystem_unknown: m_nt_subsystem = { pe::k_subsystem_unknown, "Unknown" }; break;
+		case pe::k_subsystem_native: m_nt_subsystem = { pe::k_subsystem_native, "NATIVE" }; break;
+		case pe::k_subsystem_windows_gui: m_nt_subsystem = { pe::k_subsystem_native, "GUI" }; break;
+		case pe::k_subsystem_windows_cui: m_nt_subsystem = { pe::k_subsystem_windows_cui, "CUI" }; break;
+		case pe::k_subsystem_os2_cui: m_nt_subsystem = { pe::k_subsystem_os2_cui, "OS2 CUI" }; break;
+		case pe::k_subsystem_posix_cui: m_nt_subsystem = { pe::k_subsystem_posix_cui, "POSIX CUI" }; break;
+		case pe::k_subsystem_native_windows: m_nt_subsystem = { pe::k_subsystem_native_windows, "NATIVE WINDOWS" }; break;
+		case pe::k_subsystem_windows_ce_gui: m_nt_subsystem = { pe::k_subsystem_windows_ce_gui, "CE GUI" }; break;
+		case pe::k_subsystem_efi_application: m_nt_subsystem = { pe::k_subsystem_efi_application, "EFI APPLICATION" }; break;
+		case pe::k_subsystem_efi_boot_service_driver: m_nt_subsystem = { pe::k_subsystem_efi_boot_service_driver, "BOOT SERVICE DRIVER" }; break;
+		case pe::k_subsystem_efi_runtime_driver: m_nt_subsystem = { pe::k_subsystem_efi_runtime_driver, "EFI RUNTIME DRIVER" }; break;
+		case pe::k_subsystem_efi_rom: m_nt_subsystem = { pe::k_subsystem_efi_rom, "EFI ROM" }; break;
+		case pe::k_subsystem_xbox: m_nt_subsystem = { pe::k_subsystem_xbox, "XBOX" }; break;
+		case pe::k_subsystem_windows_boot_application: m_nt_subsystem = { pe::k_subsystem_windows_boot_application, "BOOT APP" }; break;
 
 		default:
 			m_nt_subsystem = { subsystem, std::format("0x{:08X}", subsystem) };
@@ -2094,57 +3074,50 @@ void CX86PEProcessor::process_nt_subsystem(uint32_t subsystem)
 			break;
 	}
 
-	CDebugConsole::get().output_message(std::format("Subsystem is: {}", m_nt_subsystem.name()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("Subsystem is: {}", m_nt_subsystem.name());
 }
 
 // https://docs.microsoft.com/en-us/windows/win32/debug/pe-format#dll-characteristics
 void CX86PEProcessor::process_nt_dll_characteristics(uint16_t dll_characteristics)
 {
-	m_nt_dll_characteristics =
-	{
-		dll_characteristics,
-		{
-			{ IMAGE_DLLCHARACTERISTICS_HIGH_ENTROPY_VA,			"High entropy 64-bit VA space" },
-			{ IMAGE_DLLCHARACTERISTICS_DYNAMIC_BASE,			"DLL with dynamic base" },
-			{ IMAGE_DLLCHARACTERISTICS_FORCE_INTEGRITY,			"Code integrity" },
-			{ IMAGE_DLLCHARACTERISTICS_NX_COMPAT,				"NX compatible" },
-			{ IMAGE_DLLCHARACTERISTICS_NO_ISOLATION,			"Image can't afford isolation" },
-			{ IMAGE_DLLCHARACTERISTICS_NO_SEH,					"No SE handler" },
-			{ IMAGE_DLLCHARACTERISTICS_NO_BIND,					"Not bindable" },
-			{ IMAGE_DLLCHARACTERISTICS_APPCONTAINER,			"App container executable" },
-			{ IMAGE_DLLCHARACTERISTICS_WDM_DRIVER,				"WDM driver model" },
-			{ IMAGE_DLLCHARACTERISTICS_GUARD_CF,				"Control Flow Guard support" },
-			{ IMAGE_DLLCHARACTERISTICS_TERMINAL_SERVER_AWARE,	"Terminal server aware" },
-		}
-	};
+	m_nt_dll_characteristics = dll_characteristics;
 
 	// First four must be zero, they're reserved.
 	if (m_nt_dll_characteristics.are_any_bits_present(0, 3))
 	{
-		CDebugConsole::get().output_info(std::format("Warning, reserved bits inside DLL characteristics are set. They should be zero."));
+		CDebugConsole::get().output_info<LogCategory::Parser>("Warning, reserved bits inside DLL characteristics are set. They should be zero.");
 	}
 
-	CDebugConsole::get().output_message(std::format("DLL characteristics: {}", m_nt_dll_characteristics.as_continuous_string()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("DLL characteristics: {}", m_nt_dll_characteristics.as_continuous_string());
 }
 
 // https://docs.microsoft.com/en-us/windows/win32/debug/pe-format#section-table-section-headers
 bool CX86PEProcessor::process_sections()
 {
-	if (sizeof(IMAGE_SECTION_HEADER) != IMAGE_SIZEOF_SECTION_HEADER)
+	if (sizeof(pe::ImageSectionHeader) != pe::k_sizeof_section_header)
 	{
-		CDebugConsole::get().output_error(std::format("Section header size missmatch. our={} should be={}", sizeof(IMAGE_SECTION_HEADER), IMAGE_SIZEOF_SECTION_HEADER));
+		CDebugConsole::get().output_error("Section header size missmatch. our={} should be={}", sizeof(pe::ImageSectionHeader), pe::k_sizeof_section_header);
 		return false;
 	}
 
-	auto pnt_hdrs = m_byte_buffer.get_at<IMAGE_NT_HEADERS>(m_dos_headers_size);
+	auto pnt_hdrs = m_byte_buffer.get_at<pe::ImageNtHeaders32>(m_dos_headers_size);
 
-	auto img_sec_hdr = IMAGE_FIRST_SECTION(pnt_hdrs);
+	// Section table follows right after the optional header, whatever its size is.
+	auto img_sec_hdr = m_byte_buffer.get_array_at<pe::ImageSectionHeader>(
+		m_dos_headers_size + offsetof(pe::ImageNtHeaders32, OptionalHeader) + pnt_hdrs->FileHeader.SizeOfOptionalHeader, m_num_sections);
+
+	if (!img_sec_hdr)
+	{
+		CDebugConsole::get().output_error("Section table doesn't fit into the file.");
+		return false;
+	}
 
 	for (uint32_t i = 0; i < m_num_sections; i++)
 	{
 		ImageSection sec;
 
-		sec.m_name = (const char*)img_sec_hdr->Name;
+		// Names that take all 8 bytes aren't null-terminated
+		sec.m_name = std::string((const char*)img_sec_hdr->Name, strnlen((const char*)img_sec_hdr->Name, pe::k_sizeof_short_name));
 
 		if (sec.m_name.empty())
 		{
@@ -2162,14 +3135,14 @@ bool CX86PEProcessor::process_sections()
 			// Raw data size must be a multiple of file aligment
 			if (!sec.m_raw_data_size.is_aligned(m_file_alignment))
 			{
-				CDebugConsole::get().output_error(std::format("Raw data size isn't {}-byte aligned. ({})", m_file_alignment.val(), sec.m_raw_data_size.val()));
+				CDebugConsole::get().output_error("Raw data size isn't {}-byte aligned. ({})", m_file_alignment.val(), sec.m_raw_data_size.val());
 				return false;
 			}
 
 			// pointer to raw size should be a multiple of file aligment
 			if (!sec.m_raw_data_ptr.is_aligned(0x4))
 			{
-				CDebugConsole::get().output_info(std::format("Pointer to raw data should be 4-byte aligned. ({})", sec.m_raw_data_ptr.val()));
+				CDebugConsole::get().output_info<LogCategory::Parser>("Pointer to raw data should be 4-byte aligned. ({})", sec.m_raw_data_ptr.val());
 				return false;
 			}
 
@@ -2183,17 +3156,17 @@ bool CX86PEProcessor::process_sections()
 
 				if (sec.m_zero_padding > 0)
 				{
-					CDebugConsole::get().output_message(std::format("Section's VA size is greater than raw data size. "
+					CDebugConsole::get().output_message<LogCategory::Parser>("Section's VA size is greater than raw data size. "
 						"There's {}-byte zero padding at end. ({} > {})",
 						sec.m_zero_padding.val(),
-						sec.m_va_size.val(), sec.m_raw_data_size.val()));
+						sec.m_va_size.val(), sec.m_raw_data_size.val());
 				}
 			}
 		}
 		else
 		{
 			// Can happen that these are NULL.
-			CDebugConsole::get().output_info("Warning, null raw data.");
+			CDebugConsole::get().output_info<LogCategory::Parser>("Warning, null raw data.");
 		}
 
 		sec.m_line_numbers_ptr = img_sec_hdr->PointerToLinenumbers;
@@ -2202,10 +3175,10 @@ bool CX86PEProcessor::process_sections()
 		// These should be zero for the executable image
 		if (sec.m_line_numbers_ptr != 0 || sec.m_line_numbers_num != 0)
 		{
-			CDebugConsole::get().output_info(std::format("Line numbers pointer and number of line numbers should be both 0 for an executable image. "
-														 "(ptr={} num={})",
-														 sec.m_line_numbers_ptr.as_string(),
-														 sec.m_line_numbers_num.val()));
+			CDebugConsole::get().output_info<LogCategory::Parser>("Line numbers pointer and number of line numbers should be both 0 for an executable image. "
+											 "(ptr={} num={})",
+											 sec.m_line_numbers_ptr.as_string(),
+											 sec.m_line_numbers_num.val());
 		}
 
 		sec.m_relocs_ptr = img_sec_hdr->PointerToRelocations;
@@ -2213,27 +3186,75 @@ bool CX86PEProcessor::process_sections()
 
 		sec.process_characteristics(img_sec_hdr->Characteristics);
 
-		CDebugConsole::get().output_message(std::format("section #{}: {:<{}}", i, sec.m_name, IMAGE_SIZEOF_SHORT_NAME));
+		CDebugConsole::get().output_verbose<LogCategory::Parser>("section #{}: {:<{}}", i, sec.m_name, pe::k_sizeof_short_name);
 
 		m_sections[sec.m_name] = sec;
 
 		img_sec_hdr++;
 	}
 
+	build_section_intervals();
+
 	return true;
 }
 
-void CX86PEProcessor::process_image_strings()
+void CX86PEProcessor::build_section_intervals()
 {
-	auto is_ascii_fine = [](char c)
+	m_section_intervals.clear();
+	m_section_intervals.reserve(m_sections.size());
+
+	for (const auto& [key, sec] : m_sections)
 	{
-		return c >= ' ' && c <= '~';
-	};
+		ImageSectionInterval interval;
+
+		interval.m_rva_begin = va_as_rva(sec.m_va_base);
+		interval.m_rva_end = interval.m_rva_begin + sec.m_va_size;
+		interval.m_raw_data_ptr = sec.m_raw_data_ptr;
+
+		m_section_intervals.emplace_back(interval);
+	}
+
+	std::sort(m_section_intervals.begin(), m_section_intervals.end(),
+			  [](const ImageSectionInterval& a, const ImageSectionInterval& b)
+			  {
+				  return a.m_rva_begin < b.m_rva_begin;
+			  });
+
+	m_last_section_hit = 0;
+}
+
+// Everything past the raw data of the last section isn't mapped by the loader. This
+// is where installers keep their payloads and where the certificate table lives.
+void CX86PEProcessor::process_overlay()
+{
+	uint64_t end_of_image = m_size_of_hdrs;
 
+	for (const auto& [key, sec] : m_sections)
+	{
+		uint64_t sec_end = (uint64_t)sec.m_raw_data_ptr + sec.m_raw_data_size;
+
+		if (sec_end > end_of_image)
+			end_of_image = sec_end;
+	}
+
+	if (end_of_image >= m_byte_buffer.get_size())
+	{
+		CDebugConsole::get().output_message<LogCategory::Parser>("Image has no overlay");
+		return;
+	}
+
+	m_overlay_offset = end_of_image;
+	m_overlay_size = m_byte_buffer.get_size() - end_of_image;
+
+	CDebugConsole::get().output_message<LogCategory::Parser>("Image has overlay at 0x{:X} of size {}", m_overlay_offset, CUtil::make_filesize_nice(m_overlay_size));
+}
+
+void CX86PEProcessor::process_image_strings()
+{
 	// Each section has it's policy of searching for strings in it.
 	struct SectionSearchPolicy
 	{
-		char		m_section_name[IMAGE_SIZEOF_SHORT_NAME];
+		char		m_section_name[pe::k_sizeof_short_name];
 		uint32_t	min_len_tolerance; // Minimal string length that we will save for this section.
 	};
 
@@ -2250,268 +3271,798 @@ void CX86PEProcessor::process_image_strings()
 		}
 	};
 
-	// Since vector insertion ins't thread-safe, we have to create a vector for each section and
-	// then merge them into the global vector.
-	std::array<std::vector<ImageString>, allowed_sections.size()> concurrent_string_containers;
+	// Sections are split into chunks of this size and scanned on the thread pool, so that
+	// a large .text doesn't end up on a single thread. A string crossing a chunk border
+	// belongs to the chunk it starts in.
+	constexpr static uint64_t k_chunk_size = 1024 * 1024;
+
+	struct SectionRegion
+	{
+		const uint8_t* m_data = nullptr; // nullptr if the section isn't searched
+		uint64_t m_size = 0;
+		uint32_t m_base_rva = 0;
+	};
+
+	struct ScanChunk
+	{
+		uint32_t m_which; // Index into allowed_sections
+		uint64_t m_begin, m_end; // Relative to the section
+		std::vector<ImageString> m_strings = {};
+	};
+
+	std::array<SectionRegion, allowed_sections.size()> regions;
 
-	const auto process_section = [&](const auto& allowed_sec, uint32_t which) -> void
+	// In section and offset order, so that concatenating them keeps the strings sorted.
+	std::vector<ScanChunk> chunks;
+
+	for (uint32_t which = 0; which < allowed_sections.size(); which++)
 	{
-		CDebugConsole::get().output_message(std::format("Searching in {}...", allowed_sec.m_section_name));
+		const auto& allowed_sec = allowed_sections[which];
+
+		CDebugConsole::get().output_verbose<LogCategory::Strings>("Searching in {}...", allowed_sec.m_section_name);
 
 		const auto& section = get_section_by_name(allowed_sec.m_section_name);
 
 		if (!section.is_valid())
 		{
-			CDebugConsole::get().output_info(std::format("Couldn't search for strings inside {} because the section is invalid or non-existent.",
-				allowed_sec.m_section_name));
+			CDebugConsole::get().output_info<LogCategory::Strings>("Couldn't search for strings inside {} because the section is invalid or non-existent.",
+				allowed_sec.m_section_name);
 			
-			return;
+			continue;
 		}
 
-		uint32_t sec_base_rva = section.m_raw_data_ptr;
-
-		if (section.m_raw_data_size == NULL)
+		if (section.m_raw_data_size == NULL || section.m_raw_data_ptr >= m_byte_buffer.get_size())
 		{
-			return;
+			continue;
 		}
 
-		uint32_t strings_per_sec = 0;
-		for (uint32_t i = sec_base_rva; i < sec_base_rva + section.m_raw_data_size - 1;)
+		// Raw data of the last section may be truncated on disk.
+		uint64_t sec_begin = section.m_raw_data_ptr;
+		uint64_t sec_size = std::min<uint64_t>(section.m_raw_data_size, m_byte_buffer.get_size() - sec_begin);
+
+		regions[which] = { m_byte_buffer.get_array_at<const uint8_t>(sec_begin, sec_size), sec_size, va_as_rva(section.m_va_base) };
+
+		for (uint64_t off = 0; off < sec_size; off += k_chunk_size)
 		{
-			ImageString str;
+			chunks.push_back({ which, off, std::min(off + k_chunk_size, sec_size) });
+		}
+	}
 
-			auto c = m_byte_buffer.get_at<const char>(i);
+	add_progress_steps((uint32_t)chunks.size());
 
-			uint32_t pushed_chars = 0;
-			while (is_ascii_fine(*c))
-			{
-				str.m_string.push_back(*c);
+	CTaskGroup scan_group;
+	for (auto& chunk : chunks)
+	{
+		CThreadPool::get().submit(scan_group,
+								  [&]()
+								  {
+									  // Left unfinished, the processor is going away
+									  if (is_cancel_requested())
+										  return;
+
+									  const auto& region = regions[chunk.m_which];
+									  const auto& allowed_sec = allowed_sections[chunk.m_which];
+
+									  PrintableRunScanner::scan(region.m_data, region.m_size, chunk.m_begin, chunk.m_end, allowed_sec.min_len_tolerance,
+																[&](size_t off, size_t len)
+																{
+																	ImageString str;
+																	str.m_string = std::string_view(reinterpret_cast<const char*>(region.m_data) + off, len);
+																	str.m_va = rva_as_va(region.m_base_rva + (uint32_t)off);
+																	str.m_parent_sec_name = allowed_sec.m_section_name;
+																	chunk.m_strings.push_back(str);
+																});
+
+									  complete_progress_steps();
+								  });
+	}
 
-				c++;
-				pushed_chars++;
-			}
+	CThreadPool::get().wait(scan_group);
 
-			if (!str.m_string.empty())
-			{
-				if (str.m_string.length() > allowed_sec.min_len_tolerance)
-				{
-					str.m_va = rva_as_va(i);
-					str.m_parent_sec_name = allowed_sec.m_section_name;
-					concurrent_string_containers[which].push_back(str);
+	// Now merge all chunks
+	std::array<uint32_t, allowed_sections.size()> strings_per_sec = {};
 
-					strings_per_sec++;
-					i += pushed_chars;
-					//CDebugConsole::get().output_message(std::format("Found {}", str.m_string));
-				}
-				else
-				{
-					i += allowed_sec.min_len_tolerance;
-				}
-			}
-			else
-			{
-				i++;
-			}
-		}
+	size_t total_strings = 0;
+	for (const auto& chunk : chunks)
+	{
+		total_strings += chunk.m_strings.size();
+	}
+
+	m_image_strings.reserve(total_strings);
+
+	for (const auto& chunk : chunks)
+	{
+		strings_per_sec[chunk.m_which] += (uint32_t)chunk.m_strings.size();
+		m_image_strings.insert(m_image_strings.end(), chunk.m_strings.begin(), chunk.m_strings.end());
+	}
 
-		if (strings_per_sec != NULL)
+	for (uint32_t which = 0; which < allowed_sections.size(); which++)
+	{
+		if (!regions[which].m_data)
+			continue;
+
+		const auto& allowed_sec = allowed_sections[which];
+
+		if (strings_per_sec[which] != NULL)
 		{
 			m_image_strings_found_in += allowed_sec.m_section_name;
 			m_image_strings_found_in += "; ";
-			CDebugConsole::get().output_message(std::format("Found {} strings in {}.", strings_per_sec, allowed_sec.m_section_name));
+			CDebugConsole::get().output_verbose<LogCategory::Strings>("Found {} strings in {}.", strings_per_sec[which], allowed_sec.m_section_name);
 		}
 		else
 		{
-			CDebugConsole::get().output_info(std::format("Didn't find any strings at all inside {}!", allowed_sec.m_section_name));
+			CDebugConsole::get().output_info<LogCategory::Strings>("Didn't find any strings at all inside {}!", allowed_sec.m_section_name);
 		}
+	}
+
+	if (!m_image_strings_found_in.empty())
+	{
+		m_image_strings_found_in.pop_back(); // remove last ', '
+		m_image_strings_found_in.pop_back();
+	}
+
+	CDebugConsole::get().output_message<LogCategory::Strings>("Found total {} of strings inside the executable", m_image_strings.size());
+}
+
+// https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#process-for-generating-authenticode-pe-image-hash
+void CX86PEProcessor::process_file_digests()
+{
+	// Every hash is fed the same piece while it's still in the cache
+	static constexpr uint64_t k_piece_size = 64 * 1024;
+
+	struct ByteRange
+	{
+		uint64_t m_begin, m_end;
 	};
 
-	std::vector<std::thread> string_processors_for_each_section(allowed_sections.size());
+	const uint8_t* data = m_byte_buffer.get_raw();
+	uint64_t file_size = m_byte_buffer.get_size();
+
+	// The Authenticode spec hashes the headers, then the sections sorted by their file offset
+	// and then the rest of the file. Sections are laid out back to back after the headers,
+	// so that's the file in order without the checksum, the security directory entry and
+	// the certificate table.
+	std::vector<ByteRange> excluded;
 
-	uint32_t i = 0;
-	for (const auto& allowed_sec : allowed_sections)
+	uint64_t checksum_off = m_dos_headers_size + offsetof(pe::ImageNtHeaders32, OptionalHeader.CheckSum);
+	excluded.push_back({ checksum_off, checksum_off + sizeof(uint32_t) });
+
+	if (m_number_of_data_directories > pe::k_directory_entry_security)
 	{
-		string_processors_for_each_section[i++] = std::thread(process_section, allowed_sec, i);
+		// Unlike the checksum, the data directories are further into the header of a PE32+ image
+		uint64_t data_dirs_off = is_pe32_plus() ? offsetof(pe::ImageNtHeaders64, OptionalHeader.DataDirectory) : offsetof(pe::ImageNtHeaders32, OptionalHeader.DataDirectory);
+		uint64_t security_entry_off = m_dos_headers_size + data_dirs_off + pe::k_directory_entry_security * sizeof(pe::ImageDataDirectory);
+		excluded.push_back({ security_entry_off, security_entry_off + sizeof(pe::ImageDataDirectory) });
+
+		// The address of this one is a file offset
+		auto iter = m_data_dirs.find(pe::k_directory_entry_security);
+		if (iter != m_data_dirs.end() && iter->second.is_present())
+		{
+			uint64_t cert_begin = iter->second.m_address;
+			uint64_t cert_end = cert_begin + iter->second.m_size;
+
+			if (cert_end <= file_size)
+				excluded.push_back({ cert_begin, cert_end });
+			else
+				CDebugConsole::get().output_info<LogCategory::Parser>("Certificate table is out of bounds of the file, hashing it as well.");
+		}
 	}
 
-	for (auto& thread : string_processors_for_each_section)
+	std::sort(excluded.begin(), excluded.end(), [](const auto& a, const auto& b) { return a.m_begin < b.m_begin; });
+
+	std::vector<ByteRange> authenticode_ranges;
+
+	uint64_t pos = 0;
+	for (const auto& range : excluded)
 	{
-		thread.join();
+		if (std::min(range.m_begin, file_size) > pos)
+			authenticode_ranges.push_back({ pos, std::min(range.m_begin, file_size) });
+
+		pos = std::max(pos, range.m_end);
 	}
 
-	// Now merge all vectors
-	for (const auto& strings : concurrent_string_containers)
+	if (pos < file_size)
+		authenticode_ranges.push_back({ pos, file_size });
+
+	Md5 md5;
+	Sha256 sha256;
+	Sha1 authenticode_sha1;
+	Sha256 authenticode_sha256;
+
+	// One sweep over the file. The whole piece goes into the file hashes, the parts of it
+	// that aren't excluded go into the Authenticode ones.
+	auto range = authenticode_ranges.begin();
+	for (uint64_t off = 0; off < file_size && !is_cancel_requested(); off += k_piece_size)
 	{
-		m_image_strings.reserve(strings.size());
-		m_image_strings.insert(m_image_strings.end(), strings.begin(), strings.end());
+		uint64_t piece_end = std::min(off + k_piece_size, file_size);
+
+		md5.update(data + off, (size_t)(piece_end - off));
+		sha256.update(data + off, (size_t)(piece_end - off));
+
+		for (; range != authenticode_ranges.end() && range->m_begin < piece_end; range++)
+		{
+			uint64_t begin = std::max(range->m_begin, off);
+			uint64_t end = std::min(range->m_end, piece_end);
+
+			authenticode_sha1.update(data + begin, (size_t)(end - begin));
+			authenticode_sha256.update(data + begin, (size_t)(end - begin));
+
+			// Continues in the next piece
+			if (range->m_end > piece_end)
+				break;
+		}
 	}
 
-	m_image_strings_found_in.pop_back(); // remove last ', '
-	m_image_strings_found_in.pop_back();
+	m_file_md5 = Md5::digest_to_string(md5.finish());
+	m_file_sha256 = Sha256::digest_to_string(sha256.finish());
+	m_authenticode_sha1 = Sha1::digest_to_string(authenticode_sha1.finish());
+	m_authenticode_sha256 = Sha256::digest_to_string(authenticode_sha256.finish());
 
-	CDebugConsole::get().output_message(std::format("Found total {} of strings inside the executable", m_image_strings.size()));
+	CDebugConsole::get().output_message<LogCategory::Parser>("File SHA-256: {}", m_file_sha256);
 }
 
-void CX86PEProcessor::process_load_cfg_guard_flags(uint32_t flags)
+// Hashes and entropy of the raw data of every section
+void CX86PEProcessor::process_section_data()
 {
-	m_load_cfg_guard_flags =
-	{
-		flags,
-		{
-			{ IMAGE_GUARD_CF_INSTRUMENTED,						"Control-flow integrity checks" },
-			{ IMAGE_GUARD_CFW_INSTRUMENTED,						"Control-float and write integrity checks" },
-			{ IMAGE_GUARD_CF_FUNCTION_TABLE_PRESENT,			"Contains valid control-flow function table" },
-			{ IMAGE_GUARD_SECURITY_COOKIE_UNUSED,				"Doesn't use /GS security cookie" },
-			{ IMAGE_GUARD_PROTECT_DELAYLOAD_IAT,				"Supports read-only IAT" },
-			{ IMAGE_GUARD_DELAYLOAD_IAT_IN_ITS_OWN_SECTION,		"Delayload import table in its own .didat section" },
-			{ IMAGE_GUARD_CF_EXPORT_SUPPRESSION_INFO_PRESENT,	"Contains suppressed export information" },
-			{ IMAGE_GUARD_CF_ENABLE_EXPORT_SUPPRESSION,			"Enabled suppression of exports" },
-			{ IMAGE_GUARD_CF_LONGJUMP_TABLE_PRESENT,			"Contains longjmp target information" },
-			{ IMAGE_GUARD_RF_INSTRUMENTED,						"Contains return flow instrumentation and metadata" },
-			{ IMAGE_GUARD_RF_ENABLE,							"Requests that the OS enable return flow protection" },
-			{ IMAGE_GUARD_RF_STRICT,							"Requests that the OS enable return flow protection in strict mode" },
-			{ IMAGE_GUARD_RETPOLINE_PRESENT,					"Was built with retpoline support" },
-			{ IMAGE_GUARD_EH_CONTINUATION_TABLE_PRESENT,		"Contains EH continuation target information" },
+	// All of them are fed the same piece while it's still in the cache
+	static constexpr uint64_t k_piece_size = 64 * 1024;
+
+	CTaskGroup section_group;
+	for (auto& [name, section] : m_sections)
+	{
+		CThreadPool::get().submit(section_group,
+								  [this, &section]()
+								  {
+									  // Raw data of the last section may be truncated on disk.
+									  uint64_t begin = std::min<uint64_t>(section.m_raw_data_ptr, m_byte_buffer.get_size());
+									  uint64_t end = begin + std::min<uint64_t>(section.m_raw_data_size, m_byte_buffer.get_size() - begin);
+
+									  Md5 md5;
+									  Sha256 sha256;
+									  EntropyMeter entropy;
+
+									  for (uint64_t off = begin; off < end; off += k_piece_size)
+									  {
+										  if (is_cancel_requested())
+											  return;
+
+										  size_t size = (size_t)std::min(k_piece_size, end - off);
+										  const uint8_t* piece = m_byte_buffer.get_array_at<const uint8_t>(off, size);
+
+										  md5.update(piece, size);
+										  sha256.update(piece, size);
+										  entropy.update(piece, size);
+									  }
+
+									  section.m_md5 = Md5::digest_to_string(md5.finish());
+									  section.m_sha256 = Sha256::digest_to_string(sha256.finish());
+									  section.m_entropy = entropy.entropy();
+									  section.m_max_window_entropy = entropy.max_window_entropy();
+									  section.m_window_entropies = entropy.get_window_entropies();
+								  });
+	}
+
+	CThreadPool::get().wait(section_group);
+}
+
+// Same as pefile's get_imphash(), so that the hashes can be looked up elsewhere. Except that
+// pefile names ordinal imports of ws2_32, wsock32 and oleaut32 after its own tables, those
+// are "ord<n>" here just like ordinal imports of any other module.
+void CX86PEProcessor::process_import_hash()
+{
+	if (m_image_import_descriptors.empty())
+		return;
+
+	std::string imports;
+
+	for (const auto& descriptor : m_image_import_descriptors)
+	{
+		std::string module_name(descriptor.m_image_name);
+		std::transform(module_name.begin(), module_name.end(), module_name.begin(), [](char c) { return (char)std::tolower((uint8_t)c); });
+
+		size_t dot = module_name.rfind('.');
+		if (dot != std::string::npos)
+		{
+			std::string_view ext = std::string_view(module_name).substr(dot + 1);
+			if (ext == "dll" || ext == "ocx" || ext == "sys")
+				module_name.resize(dot);
 		}
-	};
 
-	CDebugConsole::get().output_message(std::format("Load CFG guard flags: {}", m_load_cfg_guard_flags.as_continuous_string()));
+		for (const auto& thunk : descriptor.m_import_thunks)
+		{
+			if (!imports.empty())
+				imports.push_back(',');
+
+			imports.append(module_name);
+			imports.push_back('.');
+
+			if (thunk.imported_by_name())
+			{
+				for (char c : thunk.m_name)
+					imports.push_back((char)std::tolower((uint8_t)c));
+			}
+			else
+			{
+				imports.append(std::format("ord{}", thunk.m_ordinal.val()));
+			}
+		}
+	}
+
+	Md5 md5;
+	md5.update(reinterpret_cast<const uint8_t*>(imports.data()), imports.size());
+	m_import_hash = Md5::digest_to_string(md5.finish());
+}
+
+void CX86PEProcessor::process_load_cfg_guard_flags(uint32_t flags)
+{
+	m_load_cfg_guard_flags = flags;
+
+	CDebugConsole::get().output_message<LogCategory::Parser>("Load CFG guard flags: {}", m_load_cfg_guard_flags.as_continuous_string());
 }
 
 void CX86PEProcessor::process_load_cfg_process_heap_flags(uint32_t flags)
 {
-	m_load_cfg_process_heap_flags =
-	{
-		flags,
-		{
-			{ HEAP_NO_SERIALIZE,				"" },
-			{ HEAP_GROWABLE,					"" },
-			{ HEAP_GENERATE_EXCEPTIONS,			"" },
-			{ HEAP_ZERO_MEMORY,					"" },
-			{ HEAP_REALLOC_IN_PLACE_ONLY,		"" },
-			{ HEAP_TAIL_CHECKING_ENABLED,		"" },
-			{ HEAP_FREE_CHECKING_ENABLED,		"" },
-			{ HEAP_DISABLE_COALESCE_ON_FREE,	"" },
-			{ HEAP_CREATE_HARDENED,				"" },
-			{ HEAP_CREATE_SEGMENT_HEAP,			"" },
-			{ HEAP_CREATE_ALIGN_16,				"" },
-			{ HEAP_CREATE_ENABLE_TRACING,		"" },
-			{ HEAP_CREATE_ENABLE_EXECUTE,		"" },
+	m_load_cfg_process_heap_flags = flags;
+
+	CDebugConsole::get().output_message<LogCategory::Parser>("Load CFG process heap flags: {}", m_load_cfg_process_heap_flags.as_continuous_string());
+}
+
+void CX86PEProcessor::write_cache_entry(BinaryWriter& writer) const
+{
+	// Views into the image are stored as file offsets
+	auto write_view = [&](std::string_view view)
+	{
+		writer.write((uint64_t)(view.empty() ? 0 : reinterpret_cast<const uint8_t*>(view.data()) - m_byte_buffer.get_raw()));
+		writer.write((uint32_t)view.size());
+	};
+
+	writer.write(m_image_checksum_calc.val());
+
+	// Hashes
+	writer.write_string(m_file_md5);
+	writer.write_string(m_file_sha256);
+	writer.write_string(m_authenticode_sha1);
+	writer.write_string(m_authenticode_sha256);
+	writer.write_string(m_import_hash);
+
+	writer.write((uint32_t)m_sections.size());
+	for (const auto& [name, section] : m_sections)
+	{
+		writer.write_string(name);
+		writer.write_string(section.m_md5);
+		writer.write_string(section.m_sha256);
+		writer.write(section.m_entropy);
+		writer.write(section.m_max_window_entropy);
+		writer.write_array(section.m_window_entropies);
+	}
+
+	// Exports
+	writer.write(m_number_of_exported_functions);
+	writer.write(m_number_of_exported_names);
+	writer.write(m_export_starting_ordinal_num.val());
+	writer.write_string(m_export_dll_name);
+	writer.write(m_export_creation_timestamp.as_integer());
+
+	writer.write((uint32_t)m_image_exports.size());
+	for (const auto& ex : m_image_exports)
+	{
+		write_view(ex.m_name);
+		writer.write(ex.m_ordinal.val());
+		writer.write(ex.m_address.val());
+		writer.write((uint8_t)ex.is_forwarded);
+	}
+
+	// Imports
+	writer.write(m_number_of_import_descriptors);
+	writer.write(m_number_of_import_thunk_ordinals);
+	writer.write(m_number_of_import_thunk_names);
+
+	writer.write((uint32_t)m_image_import_descriptors.size());
+	for (const auto& descriptor : m_image_import_descriptors)
+	{
+		write_view(descriptor.m_image_name);
+		writer.write(descriptor.m_descriptor_va.val());
+
+		writer.write((uint32_t)descriptor.m_import_thunks.size());
+		for (const auto& thunk : descriptor.m_import_thunks)
+		{
+			write_view(thunk.m_name);
+			writer.write(thunk.m_ordinal.val());
+			writer.write(thunk.m_hint.val());
+			writer.write(thunk.m_import_va.val());
+		}
+	}
+
+	// Relocations
+	writer.write((uint32_t)m_relocation_blocks.size());
+	for (const auto& block : m_relocation_blocks)
+	{
+		writer.write(block.m_page_rva.val());
+		writer.write(block.m_size.val());
+
+		writer.write_array(block.m_types);
+		writer.write_array(block.m_offsets);
+	}
+
+	// Strings, their sections are referred to by an index into a table of names
+	writer.write_string(m_image_strings_found_in);
+
+	std::vector<std::string_view> section_names;
+	for (const auto& str : m_image_strings)
+	{
+		if (std::find(section_names.begin(), section_names.end(), str.m_parent_sec_name) == section_names.end())
+			section_names.push_back(str.m_parent_sec_name);
+	}
+
+	writer.write((uint32_t)section_names.size());
+	for (const auto& name : section_names)
+		writer.write_string(name);
+
+	writer.write((uint32_t)m_image_strings.size());
+	for (const auto& str : m_image_strings)
+	{
+		write_view(str.m_string);
+		writer.write(str.m_va.val());
+		writer.write((uint8_t)(std::find(section_names.begin(), section_names.end(), str.m_parent_sec_name) - section_names.begin()));
+	}
+}
+
+// Reads everything written by write_cache_entry(). The entry is intact once it's been
+// loaded, a failure here means that the parser has changed without k_parse_cache_version
+// being bumped.
+bool CX86PEProcessor::restore_from_cache(BinaryReader& reader)
+{
+	auto read_view = [&](std::string_view& view)
+	{
+		uint64_t off = reader.read<uint64_t>();
+		uint32_t size = reader.read<uint32_t>();
+
+		if (reader.failed())
+			return false;
+
+		if (!size)
+		{
+			view = "";
+			return true;
 		}
+
+		auto data = m_byte_buffer.get_array_at<const char>(off, size);
+
+		if (!data)
+			return false;
+
+		view = std::string_view(data, size);
+		return true;
 	};
 
-	CDebugConsole::get().output_message(std::format("Load CFG process heap flags: {}", m_load_cfg_process_heap_flags.as_continuous_string()));
+	m_image_checksum_calc = reader.read<uint32_t>();
+
+	// Hashes
+	reader.read_string(m_file_md5);
+	reader.read_string(m_file_sha256);
+	reader.read_string(m_authenticode_sha1);
+	reader.read_string(m_authenticode_sha256);
+	reader.read_string(m_import_hash);
+
+	uint32_t num_sections = reader.read<uint32_t>();
+	if (num_sections != m_sections.size())
+		return false;
+
+	for (uint32_t i = 0; i < num_sections; i++)
+	{
+		std::string name;
+		reader.read_string(name);
+
+		auto iter = m_sections.find(name);
+		if (iter == m_sections.end())
+			return false;
+
+		auto& section = iter->second;
+
+		reader.read_string(section.m_md5);
+		reader.read_string(section.m_sha256);
+		reader.read(section.m_entropy);
+		reader.read(section.m_max_window_entropy);
+
+		if (!reader.read_array(section.m_window_entropies))
+			return false;
+	}
+
+	// Exports
+	reader.read(m_number_of_exported_functions);
+	reader.read(m_number_of_exported_names);
+	m_export_starting_ordinal_num = reader.read<uint32_t>();
+	reader.read_string(m_export_dll_name);
+
+	uint32_t export_timestamp = reader.read<uint32_t>();
+	if (m_number_of_exported_functions && m_number_of_exported_names)
+		m_export_creation_timestamp = export_timestamp;
+
+	uint32_t num_exports = reader.read<uint32_t>();
+	if (!reader.can_hold(num_exports, 23))
+		return false;
+
+	m_image_exports.resize(num_exports);
+	for (auto& ex : m_image_exports)
+	{
+		if (!read_view(ex.m_name))
+			return false;
+
+		ex.m_ordinal = reader.read<uint16_t>();
+		ex.m_address = reader.read<uint64_t>();
+		ex.is_forwarded = reader.read<uint8_t>() != 0;
+	}
+
+	// Imports
+	reader.read(m_number_of_import_descriptors);
+	reader.read(m_number_of_import_thunk_ordinals);
+	reader.read(m_number_of_import_thunk_names);
+
+	uint32_t num_descriptors = reader.read<uint32_t>();
+	if (!reader.can_hold(num_descriptors, 24))
+		return false;
+
+	m_image_import_descriptors.reserve(num_descriptors);
+	for (uint32_t i = 0; i < num_descriptors; i++)
+	{
+		auto& descriptor = m_image_import_descriptors.emplace_back(&m_arena);
+
+		if (!read_view(descriptor.m_image_name))
+			return false;
+
+		descriptor.m_descriptor_va = reader.read<uint64_t>();
+
+		uint32_t num_thunks = reader.read<uint32_t>();
+		if (!reader.can_hold(num_thunks, 24))
+			return false;
+
+		descriptor.m_import_thunks.resize(num_thunks);
+		for (auto& thunk : descriptor.m_import_thunks)
+		{
+			if (!read_view(thunk.m_name))
+				return false;
+
+			thunk.m_ordinal = reader.read<uint16_t>();
+			thunk.m_hint = reader.read<uint16_t>();
+			thunk.m_import_va = reader.read<uint64_t>();
+		}
+	}
+
+	// Relocations
+	uint32_t num_blocks = reader.read<uint32_t>();
+	if (!reader.can_hold(num_blocks, 16))
+		return false;
+
+	m_relocation_blocks.reserve(num_blocks);
+	for (uint32_t i = 0; i < num_blocks; i++)
+	{
+		auto& block = m_relocation_blocks.emplace_back(&m_arena);
+
+		block.m_page_rva = reader.read<uint32_t>();
+		block.m_size = reader.read<uint32_t>();
+
+		if (!reader.read_array(block.m_types) || !reader.read_array(block.m_offsets) || block.m_types.size() != block.m_offsets.size())
+			return false;
+	}
+
+	// Strings, pointing at names of the sections like the parser does
+	reader.read_string(m_image_strings_found_in);
+
+	uint32_t num_section_names = reader.read<uint32_t>();
+	if (!reader.can_hold(num_section_names, 4))
+		return false;
+
+	std::vector<std::string_view> section_names;
+	for (uint32_t i = 0; i < num_section_names; i++)
+	{
+		std::string name;
+		reader.read_string(name);
+
+		auto iter = m_sections.find(name);
+		if (iter == m_sections.end())
+			return false;
+
+		section_names.push_back(iter->first);
+	}
+
+	uint32_t num_strings = reader.read<uint32_t>();
+	if (!reader.can_hold(num_strings, 21))
+		return false;
+
+	m_image_strings.resize(num_strings);
+	for (auto& str : m_image_strings)
+	{
+		if (!read_view(str.m_string))
+			return false;
+
+		str.m_va = reader.read<uint64_t>();
+
+		uint8_t which = reader.read<uint8_t>();
+		if (which >= section_names.size())
+			return false;
+
+		str.m_parent_sec_name = section_names[which];
+	}
+
+	return !reader.failed() && reader.at_end();
 }
 
-uint32_t CX86PEProcessor::calculate_image_checksum()
+// Leaves everything that restore_from_cache() may have touched as if it never ran
+void CX86PEProcessor::discard_restored_data()
 {
-	uint64_t checksum = 0;
+	m_restored_from_cache = false;
 
-	uint32_t checksumpos = m_dos_headers_size + offsetof(IMAGE_NT_HEADERS, OptionalHeader.CheckSum);
+	m_image_checksum_calc = 0;
 
-	for (uint32_t i = 0; i < m_byte_buffer.get_size(); i += sizeof(uint32_t))
+	m_file_md5.clear();
+	m_file_sha256.clear();
+	m_authenticode_sha1.clear();
+	m_authenticode_sha256.clear();
+	m_import_hash.clear();
+
+	for (auto& [name, section] : m_sections)
 	{
-		if (i == checksumpos)
-			continue;
+		section.m_md5.clear();
+		section.m_sha256.clear();
+		section.m_entropy = section.m_max_window_entropy = 0.0;
+		section.m_window_entropies.clear();
+	}
+
+	m_number_of_exported_functions = m_number_of_exported_names = 0;
+	m_export_starting_ordinal_num = 0;
+	m_export_dll_name.clear();
+	m_export_creation_timestamp = IntegerTimestamp();
+	m_image_exports.clear();
+
+	m_number_of_import_descriptors = m_number_of_import_thunk_ordinals = m_number_of_import_thunk_names = 0;
+	m_image_import_descriptors.clear();
+
+	m_relocation_blocks.clear();
+
+	m_image_strings_found_in.clear();
+	m_image_strings.clear();
+}
 
-		uint32_t dw = *m_byte_buffer.get_at<uint32_t>(i);
+void CX86PEProcessor::store_in_cache_if_decoded()
+{
+	if (!CParseCache::get().is_enabled() || m_restored_from_cache)
+		return;
+
+	if (!is_ready(Stage::Strings) || !is_ready(Stage::Hashes))
+		return;
+
+	// Only whatever could be read has been decoded, such files are always parsed again
+	if (is_malformed())
+		return;
+
+	for (uint32_t i = 0; i < pe::k_numberof_directory_entries; i++)
+	{
+		if (is_data_dir_cached(i) && !is_data_dir_ready(i))
+			return;
+	}
+
+	// The last two parts may finish at the same time
+	if (m_stored_in_cache.exchange(true))
+		return;
 
-		checksum = (checksum & 0xffffffff) + dw + (checksum >> 32);
-		if (checksum > (((uint64_t)(~0ul) + 1)))
-			checksum = (checksum & 0xffffffff) + (checksum >> 32);
+	BinaryWriter writer;
+	write_cache_entry(writer);
+
+	CParseCache::get().store(m_cache_key, k_parse_cache_version, writer);
+}
+
+uint32_t CX86PEProcessor::calculate_image_checksum()
+{
+	// Large files are summed in pieces on the thread pool, one piece is small enough to
+	// be done before the overhead of a task would matter. Must be a multiple of a dword.
+	static constexpr uint64_t k_chunk_size = 4 * 1024 * 1024;
+
+	const uint8_t* data = m_byte_buffer.get_raw();
+	uint64_t size = m_byte_buffer.get_size();
+
+	uint64_t num_chunks = (size + k_chunk_size - 1) / k_chunk_size;
+	std::vector<uint64_t> partial_sums(num_chunks);
+
+	CTaskGroup sum_group;
+	for (uint64_t i = 0; i < num_chunks; i++)
+	{
+		CThreadPool::get().submit(sum_group,
+								  [&, i]()
+								  {
+									  uint64_t begin = i * k_chunk_size;
+									  partial_sums[i] = ImageChecksum::sum_dwords(data + begin, std::min(k_chunk_size, size - begin));
+								  });
 	}
 
-	//Finish checksum
-	checksum = (checksum & 0xffff) + (checksum >> 16);
-	checksum = (checksum)+(checksum >> 16);
-	checksum = checksum & 0xffff;
+	CThreadPool::get().wait(sum_group);
 
-	checksum += m_byte_buffer.get_size();
-	return static_cast<uint32_t>(checksum);
+	uint64_t sum = 0;
+	for (uint64_t partial_sum : partial_sums)
+		sum += partial_sum;
+
+	// The checksum field itself isn't part of the sum
+	uint64_t checksumpos = m_dos_headers_size + offsetof(pe::ImageNtHeaders32, OptionalHeader.CheckSum);
+	if (checksumpos % sizeof(uint32_t) == 0 && checksumpos + sizeof(uint32_t) <= size)
+		sum -= *m_byte_buffer.get_at<uint32_t>(checksumpos);
+
+	return ImageChecksum::finish(sum, size);
 }
 
 std::string CX86PEProcessor::data_dir_name_by_idx(uint32_t i)
 {
 	switch (i)
 	{
-		case IMAGE_DIRECTORY_ENTRY_EXPORT:			return "Export";
-		case IMAGE_DIRECTORY_ENTRY_IMPORT:			return "Import";
-		case IMAGE_DIRECTORY_ENTRY_RESOURCE:		return "Resource";
-		case IMAGE_DIRECTORY_ENTRY_EXCEPTION:		return "Exception";
-		case IMAGE_DIRECTORY_ENTRY_SECURITY:		return "Security";
-		case IMAGE_DIRECTORY_ENTRY_BASERELOC:		return "BaseReloc";
-		case IMAGE_DIRECTORY_ENTRY_DEBUG:			return "Debug";
-		case IMAGE_DIRECTORY_ENTRY_ARCHITECTURE:	return "Arch";
-		case IMAGE_DIRECTORY_ENTRY_GLOBALPTR:		return "Global PTR";
-		case IMAGE_DIRECTORY_ENTRY_TLS:				return "Thread Local Storage";
-		case IMAGE_DIRECTORY_ENTRY_LOAD_CONFIG:		return "Load config";
-		case IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT:	return "Bound import";
-		case IMAGE_DIRECTORY_ENTRY_IAT:				return "Import address table";
-		case IMAGE_DIRECTORY_ENTRY_DELAY_IMPORT:	return "Delay import";
-		case IMAGE_DIRECTORY_ENTRY_COM_DESCRIPTOR:	return "COM descriptor";
+		case pe::k_directory_entry_export:			return "Export";
+		case pe::k_directory_entry_import:			return "Import";
+		case pe::k_directory_entry_resource:		return "Resource";
+		case pe::k_directory_entry_exception:		return "Exception";
+		case pe::k_directory_entry_security:		return "Security";
+		case pe::k_directory_entry_basereloc:		return "BaseReloc";
+		case pe::k_directory_entry_debug:			return "Debug";
+		case pe::k_directory_entry_architecture:	return "Arch";
+		case pe::k_directory_entry_globalptr:		return "Global PTR";
+		case pe::k_directory_entry_tls:				return "Thread Local Storage";
+		case pe::k_directory_entry_load_config:		return "Load config";
+		case pe::k_directory_entry_bound_import:	return "Bound import";
+		case pe::k_directory_entry_iat:				return "Import address table";
+		case pe::k_directory_entry_delay_import:	return "Delay import";
+		case pe::k_directory_entry_com_descriptor:	return "COM descriptor";
 		case 15:									return "Reserved (15)";
 	}
 
-	CDebugConsole::get().output_error(std::format("Unknown data directory index: {}", i));
+	CDebugConsole::get().output_error("Unknown data directory index: {}", i);
 	return "Unknown";
 }
 
-uint32_t CX86PEProcessor::offset_relative_to_a_section(uint32_t rva)
+uint64_t CX86PEProcessor::offset_relative_to_a_section(uint32_t rva)
 {
-	for (const auto& [key, sec] : m_sections)
+	// Tables such as export names or import thunks are walked entry by entry, so most
+	// of the time the address lands inside of the same section as the last one did.
+	size_t last_hit = m_last_section_hit.load(std::memory_order_relaxed);
+	if (last_hit < m_section_intervals.size())
 	{
+		const auto& last = m_section_intervals[last_hit];
+		if (last.contains(rva))
+			return last.translate(rva);
+	}
+
+	// Find the last section that starts at or before the rva
+	auto iter = std::upper_bound(m_section_intervals.begin(), m_section_intervals.end(), rva,
+								 [](uint32_t rva, const ImageSectionInterval& interval)
+								 {
+									 return rva < interval.m_rva_begin;
+								 });
+
+	if (iter != m_section_intervals.begin())
+	{
+		--iter;
+
 		// Check if we're in-bounds
-		if (rva >= va_as_rva(sec.m_va_base) && rva <= va_as_rva(sec.virtual_end_addr()))
-			return (rva - va_as_rva(sec.m_va_base)) + sec.m_raw_data_ptr;
+		if (iter->contains(rva))
+		{
+			m_last_section_hit.store(std::distance(m_section_intervals.begin(), iter), std::memory_order_relaxed);
+			return iter->translate(rva);
+		}
 	}
 
-	CDebugConsole::get().output_error(std::format("Error! Relative section offset couldn't be calculated! Addr=0x{:08X}", rva));
+	CDebugConsole::get().output_error("Error! Relative section offset couldn't be calculated! Addr=0x{:08X}", rva);
 	return 0x00000000;
 }
 
 void ImageSection::process_characteristics(uint32_t characteristics)
 {
-	m_characteristics =
-	{
-		characteristics,
-		{
-			{ IMAGE_SCN_TYPE_NO_PAD,				"Not padded" },
-			{ IMAGE_SCN_CNT_CODE,					"Executable code" },
-			{ IMAGE_SCN_CNT_INITIALIZED_DATA,		"Initialized data" },
-			{ IMAGE_SCN_CNT_UNINITIALIZED_DATA,		"Uninitialized data" },
-			{ IMAGE_SCN_LNK_OTHER,					"Other (reserved)" },
-			{ IMAGE_SCN_LNK_INFO,					"Comments (.drectve)" },
-			{ IMAGE_SCN_LNK_REMOVE,					"Not part of image" },
-			{ IMAGE_SCN_LNK_COMDAT,					"COMDAT data" },
-			{ IMAGE_SCN_GPREL,						"Global Ptr data" },
-			{ IMAGE_SCN_MEM_PURGEABLE,				"Purgeable (reserved)" },
-			{ IMAGE_SCN_MEM_16BIT,					"16bit (reserved)" },
-			{ IMAGE_SCN_MEM_LOCKED,					"Locked (reserved)" },
-			{ IMAGE_SCN_MEM_PRELOAD,				"Preload (reserved)" },
-			{ IMAGE_SCN_ALIGN_1BYTES,				"1-byte aligned" },
-			{ IMAGE_SCN_ALIGN_2BYTES,				"2-byte aligned" },
-			{ IMAGE_SCN_ALIGN_128BYTES,				"128-byte aligned" },
-			{ IMAGE_SCN_LNK_NRELOC_OVFL,			"Extended relocs" },
-			{ IMAGE_SCN_MEM_DISCARDABLE,			"Discardable" },
-			{ IMAGE_SCN_MEM_NOT_CACHED,				"Uncachable" },
-			{ IMAGE_SCN_MEM_NOT_PAGED,				"Unpageable" },
-			{ IMAGE_SCN_MEM_SHARED,					"Memory-shareable" },
-			{ IMAGE_SCN_MEM_EXECUTE,				"Executable" },
-			{ IMAGE_SCN_MEM_READ,					"Readable" },
-			{ IMAGE_SCN_MEM_WRITE,					"Writeable" },
-		}
-	};
+	m_characteristics = characteristics;
 
 	// Too verbose
-	//CDebugConsole::get().output_message(std::format("Section characteristics: {}", m_characteristics.as_continuous_string()));
+	//CDebugConsole::get().output_message<LogCategory::Parser>("Section characteristics: {}", m_characteristics.as_continuous_string());
 }
 
 void ImageWinCertificate::process_revision_version(uint16_t rev_version)
 {
 	switch (rev_version)
 	{
-		case WIN_CERT_REVISION_1_0: m_revision_version = { WIN_CERT_REVISION_1_0, "1.0" }; break;
-		case WIN_CERT_REVISION_2_0: m_revision_version = { WIN_CERT_REVISION_1_0, "2.0" }; break;
+		case pe::k_win_cert_revision_1_0: m_revision_version = { pe::k_win_cert_revision_1_0, "1.0" }; break;
+		case pe::k_win_cert_revision_2_0: m_revision_version = { pe::k_win_cert_revision_1_0, "2.0" }; break;
 
 		default:
 			m_revision_version = { rev_version, std::format("0x{:04X}", rev_version) };
@@ -2519,16 +4070,16 @@ void ImageWinCertificate::process_revision_version(uint16_t rev_version)
 			break;
 	}
 
-	CDebugConsole::get().output_message(std::format("Certificate revision version is: {}", m_revision_version.name()));
+	CDebugConsole::get().output_verbose<LogCategory::Parser>("Certificate revision version is: {}", m_revision_version.name());
 }
 
 void ImageWinCertificate::process_cert_type(uint16_t cert_type)
 {
 	switch (cert_type)
 	{
-		case WIN_CERT_TYPE_X509: m_cert_type = { WIN_CERT_TYPE_X509, "X.509" }; break;
-		case WIN_CERT_TYPE_PKCS_SIGNED_DATA: m_cert_type = { WIN_CERT_TYPE_PKCS_SIGNED_DATA, "PKCS#7 SignedData" }; break;
-		case WIN_CERT_TYPE_TS_STACK_SIGNED: m_cert_type = { WIN_CERT_TYPE_RESERVED_1, "Terminal Server Protocol Stack" }; break;
+		case pe::k_win_cert_type_x509: m_cert_type = { pe::k_win_cert_type_x509, "X.509" }; break;
+		case pe::k_win_cert_type_pkcs_signed_data: m_cert_type = { pe::k_win_cert_type_pkcs_signed_data, "PKCS#7 SignedData" }; break;
+		case pe::k_win_cert_type_ts_stack_signed: m_cert_type = { pe::k_win_cert_type_reserved_1, "Terminal Server Protocol Stack" }; break;
 
 		default:
 			m_cert_type = { cert_type, std::format("0x{:04X}", cert_type) };
@@ -2536,57 +4087,53 @@ void ImageWinCertificate::process_cert_type(uint16_t cert_type)
 			break;
 	}
 
-	CDebugConsole::get().output_message(std::format("Certificate type is: {}", m_cert_type.name()));
+	CDebugConsole::get().output_verbose<LogCategory::Parser>("Certificate type is: {}", m_cert_type.name());
 }
 
-void ImageRelocationBlock::BlockInfo::process_block_info_type(uint32_t type)
+const char* ImageRelocationBlock::type_name(uint8_t type)
 {
-	switch (type)
+	static constexpr const char* k_type_names[] =
 	{
-		case IMAGE_REL_BASED_ABSOLUTE: m_type = { IMAGE_REL_BASED_ABSOLUTE, "Absolute based" }; break;
-		case IMAGE_REL_BASED_HIGH: m_type = { IMAGE_REL_BASED_HIGH, "High based" }; break;
-		case IMAGE_REL_BASED_LOW: m_type = { IMAGE_REL_BASED_LOW, "Low based" }; break;
-		case IMAGE_REL_BASED_HIGHLOW: m_type = { IMAGE_REL_BASED_HIGHLOW, "High-Low based" }; break;
-		case IMAGE_REL_BASED_HIGHADJ: m_type = { IMAGE_REL_BASED_HIGHADJ, "High-Adj based" }; break;
-		case IMAGE_REL_BASED_MACHINE_SPECIFIC_5: m_type = { IMAGE_REL_BASED_MACHINE_SPECIFIC_5, "Machine specific (5)" }; break;
-		case IMAGE_REL_BASED_RESERVED: m_type = { IMAGE_REL_BASED_RESERVED, "Reserved" }; break;
-		case IMAGE_REL_BASED_MACHINE_SPECIFIC_7: m_type = { IMAGE_REL_BASED_MACHINE_SPECIFIC_7, "Machine specific (7)" }; break;
-		case IMAGE_REL_BASED_MACHINE_SPECIFIC_8: m_type = { IMAGE_REL_BASED_MACHINE_SPECIFIC_8, "Machine specific (8)" }; break;
-		case IMAGE_REL_BASED_MACHINE_SPECIFIC_9: m_type = { IMAGE_REL_BASED_MACHINE_SPECIFIC_9, "Machine specific (9)" }; break;
-		case IMAGE_REL_BASED_DIR64: m_type = { IMAGE_REL_BASED_DIR64, "Dir 64" }; break;
+		"Absolute based",		// pe::k_rel_based_absolute
+		"High based",			// pe::k_rel_based_high
+		"Low based",			// pe::k_rel_based_low
+		"High-Low based",		// pe::k_rel_based_highlow
+		"High-Adj based",		// pe::k_rel_based_highadj
+		"Machine specific (5)", // pe::k_rel_based_machine_specific_5
+		"Reserved",				// pe::k_rel_based_reserved
+		"Machine specific (7)", // pe::k_rel_based_machine_specific_7
+		"Machine specific (8)", // pe::k_rel_based_machine_specific_8
+		"Machine specific (9)", // pe::k_rel_based_machine_specific_9
+		"Dir 64",				// pe::k_rel_based_dir64
+	};
 
-		default:
-			m_type = { type, std::format("0x{:04X}", type) };
-			CDebugConsole::get().output_error("Invalid relocation block info type");
-			break;
-	}
+	static_assert(std::size(k_type_names) == pe::k_rel_based_dir64 + 1);
 
-	// too verbose
-	//CDebugConsole::get().output_message(std::format("Image relocation block info type is: {}", m_type.name()));
+	return type < std::size(k_type_names) ? k_type_names[type] : nullptr;
 }
 
 void ImageDebugDirectory::process_type(uint32_t type)
 {
 	switch (type)
 	{
-		case IMAGE_DEBUG_TYPE_UNKNOWN: m_type = { IMAGE_DEBUG_TYPE_UNKNOWN, "Unknown" }; break;
-		case IMAGE_DEBUG_TYPE_COFF: m_type = { IMAGE_DEBUG_TYPE_COFF, "COFF" }; break;
-		case IMAGE_DEBUG_TYPE_CODEVIEW: m_type = { IMAGE_DEBUG_TYPE_CODEVIEW, "Code view" }; break;
-		case IMAGE_DEBUG_TYPE_FPO: m_type = { IMAGE_DEBUG_TYPE_FPO, "FPO" }; break;
-		case IMAGE_DEBUG_TYPE_MISC: m_type = { IMAGE_DEBUG_TYPE_MISC, "Miscellaneous" }; break;
-		case IMAGE_DEBUG_TYPE_EXCEPTION: m_type = { IMAGE_DEBUG_TYPE_EXCEPTION, "Exception" }; break;
-		case IMAGE_DEBUG_TYPE_FIXUP: m_type = { IMAGE_DEBUG_TYPE_FIXUP, "Fixup" }; break;
-		case IMAGE_DEBUG_TYPE_OMAP_TO_SRC: m_type = { IMAGE_DEBUG_TYPE_OMAP_TO_SRC, "OMAP to source" }; break;
-		case IMAGE_DEBUG_TYPE_OMAP_FROM_SRC: m_type = { IMAGE_DEBUG_TYPE_OMAP_FROM_SRC, "OMAP from source" }; break;
-		case IMAGE_DEBUG_TYPE_BORLAND: m_type = { IMAGE_DEBUG_TYPE_BORLAND, "borland" }; break;
-		case IMAGE_DEBUG_TYPE_RESERVED10: m_type = { IMAGE_DEBUG_TYPE_RESERVED10, "Reserved (10)" }; break;
-		case IMAGE_DEBUG_TYPE_CLSID: m_type = { IMAGE_DEBUG_TYPE_CLSID, "Class ID (CLSID)" }; break;
-		case IMAGE_DEBUG_TYPE_VC_FEATURE: m_type = { IMAGE_DEBUG_TYPE_VC_FEATURE, "VC feature" }; break;
-		case IMAGE_DEBUG_TYPE_POGO: m_type = { IMAGE_DEBUG_TYPE_POGO, "POGO" }; break;
-		case IMAGE_DEBUG_TYPE_ILTCG: m_type = { IMAGE_DEBUG_TYPE_ILTCG, "ILTCG" }; break;
-		case IMAGE_DEBUG_TYPE_MPX: m_type = { IMAGE_DEBUG_TYPE_MPX, "MPX" }; break;
-		case IMAGE_DEBUG_TYPE_REPRO: m_type = { IMAGE_DEBUG_TYPE_REPRO, "REPRO" }; break;
-		case IMAGE_DEBUG_TYPE_EX_DLLCHARACTERISTICS: m_type = { IMAGE_DEBUG_TYPE_EX_DLLCHARACTERISTICS, "External DLL characteristics" }; break;
+		case pe::k_debug_type_unknown: m_type = { pe::k_debug_type_unknown, "Unknown" }; break;
+		case pe::k_debug_type_coff: m_type = { pe::k_debug_type_coff, "COFF" }; break;
+		case pe::k_debug_type_codeview: m_type = { pe::k_debug_type_codeview, "Code view" }; break;
+		case pe::k_debug_type_fpo: m_type = { pe::k_debug_type_fpo, "FPO" }; break;
+		case pe::k_debug_type_misc: m_type = { pe::k_debug_type_misc, "Miscellaneous" }; break;
+		case pe::k_debug_type_exception: m_type = { pe::k_debug_type_exception, "Exception" }; break;
+		case pe::k_debug_type_fixup: m_type = { pe::k_debug_type_fixup, "Fixup" }; break;
+		case pe::k_debug_type_omap_to_src: m_type = { pe::k_debug_type_omap_to_src, "OMAP to source" }; break;
+		case pe::k_debug_type_omap_from_src: m_type = { pe::k_debug_type_omap_from_src, "OMAP from source" }; break;
+		case pe::k_debug_type_borland: m_type = { pe::k_debug_type_borland, "borland" }; break;
+		case pe::k_debug_type_reserved10: m_type = { pe::k_debug_type_reserved10, "Reserved (10)" }; break;
+		case pe::k_debug_type_clsid: m_type = { pe::k_debug_type_clsid, "Class ID (CLSID)" }; break;
+		case pe::k_debug_type_vc_feature: m_type = { pe::k_debug_type_vc_feature, "VC feature" }; break;
+		case pe::k_debug_type_pogo: m_type = { pe::k_debug_type_pogo, "POGO" }; break;
+		case pe::k_debug_type_iltcg: m_type = { pe::k_debug_type_iltcg, "ILTCG" }; break;
+		case pe::k_debug_type_mpx: m_type = { pe::k_debug_type_mpx, "MPX" }; break;
+		case pe::k_debug_type_repro: m_type = { pe::k_debug_type_repro, "REPRO" }; break;
+		case pe::k_debug_type_ex_dllcharacteristics: m_type = { pe::k_debug_type_ex_dllcharacteristics, "External DLL characteristics" }; break;
 
 		default:
 			m_type = { type, std::format("0x{:08X}", type) };
@@ -2594,15 +4141,20 @@ void ImageDebugDirectory::process_type(uint32_t type)
 			break;
 	}
 
-	CDebugConsole::get().output_message(std::format("Debug directory type is: {}", m_type.name()));
+	CDebugConsole::get().output_verbose<LogCategory::Parser>("Debug directory type is: {}", m_type.name());
 }
 
-void ImageDebugDirectory::process_type_cv(const ByteBuffer<uint32_t>& byte_buffer)
+bool ImageDebugDirectory::process_type_cv(const ByteBuffer<uint64_t>& byte_buffer)
 {
 	auto& cv = m_cv;
 
 	// The first dword is the signature.
-	auto magic_signature = *byte_buffer.get_at<DWORD>(m_file_pointer_to_raw_data);
+	auto pmagic_signature = byte_buffer.get_at<uint32_t>(m_file_pointer_to_raw_data);
+
+	if (!pmagic_signature)
+		return false;
+
+	auto magic_signature = *pmagic_signature;
 
 	switch (magic_signature)
 	{
@@ -2612,19 +4164,22 @@ void ImageDebugDirectory::process_type_cv(const ByteBuffer<uint32_t>& byte_buffe
 
 			struct RSDSI // RSDS debug info
 			{
-				DWORD	magic;		// RSDS
-				GUID	guidSig;	// pdg signature
-				DWORD	age;		// pdg age
-				CHAR	pdbpath[1];
+				uint32_t	magic;		// RSDS
+				pe::Guid	guidSig;	// pdg signature
+				uint32_t	age;		// pdg age
+				char	pdbpath[1];
 			};
 
 			auto rsdsi = byte_buffer.get_at<RSDSI>(m_file_pointer_to_raw_data);
 
+			if (!rsdsi)
+				return false;
+
 			cv.m_rsds_guid_pdb_sig.stringify_me(rsdsi->guidSig);
 			cv.m_pdb_age = rsdsi->age;
-			cv.m_pdb_path = rsdsi->pdbpath;
+			cv.m_pdb_path = byte_buffer.get_cstring_at(m_file_pointer_to_raw_data + offsetof(RSDSI, pdbpath));
 
-			CDebugConsole::get().output_message("Processed RSDS codeview signature data.");
+			CDebugConsole::get().output_verbose<LogCategory::Parser>("Processed RSDS codeview signature data.");
 			break;
 		}
 		// These two guys have no structure or an uknown one
@@ -2641,31 +4196,36 @@ void ImageDebugDirectory::process_type_cv(const ByteBuffer<uint32_t>& byte_buffe
 
 			struct NB10I // NB10 debug info
 			{
-				DWORD	magic;	// NB10
-				DWORD	off;	// offset, always 0
-				DWORD	sig;	// pdg signature
-				DWORD	age;	// pdg age
-				CHAR	pdbpath[1];
+				uint32_t	magic;	// NB10
+				uint32_t	off;	// offset, always 0
+				uint32_t	sig;	// pdg signature
+				uint32_t	age;	// pdg age
+				char	pdbpath[1];
 			};
 
 			auto nb10i = byte_buffer.get_at<NB10I>(m_file_pointer_to_raw_data);
 
+			if (!nb10i)
+				return false;
+
 			cv.m_nb10_pdb_sig = nb10i->sig;
 			cv.m_pdb_age = nb10i->age;
-			cv.m_pdb_path = nb10i->pdbpath;
+			cv.m_pdb_path = byte_buffer.get_cstring_at(m_file_pointer_to_raw_data + offsetof(NB10I, pdbpath));
 
-			CDebugConsole::get().output_message("Processed NBXX codeview signature data.");
+			CDebugConsole::get().output_verbose<LogCategory::Parser>("Processed NBXX codeview signature data.");
 			break;
 		}
 		default:
 		{
-			CDebugConsole::get().output_info(std::format("Got invalid codeview magic signature: 0x{:08X}", magic_signature));
+			CDebugConsole::get().output_info<LogCategory::Parser>("Got invalid codeview magic signature: 0x{:08X}", magic_signature);
 			break;
 		}
 	}
+
+	return true;
 }
 
-void GUIDString::stringify_me(const GUID& guid)
+void GUIDString::stringify_me(const pe::Guid& guid)
 {
 	m_str_guid = CUtil::guid_to_string(guid);
 }
@@ -2676,20 +4236,30 @@ IntegerTimestamp::IntegerTimestamp(uint32_t timestamp) :
 {
 	if (!timestamp)
 	{
-		CDebugConsole::get().output_info("Warning, got invalid (null) integer timestamp.");
+		CDebugConsole::get().output_info<LogCategory::Parser>("Warning, got invalid (null) integer timestamp.");
 
 		return; // Kinda no point in converting the string when it's null.
 	}
 
 	time_t time = m_dw_timestamp;
 
-	tm* t = std::gmtime(&time);
+	// Images are parsed on several threads at once, gmtime() and asctime() share
+	// one static buffer between all of them.
+	tm t;
+#ifdef _WIN32
+	bool converted = gmtime_s(&t, &time) == 0;
+#else
+	bool converted = gmtime_r(&time, &t) != nullptr;
+#endif
 
-	if (!t)
+	if (!converted)
 	{
-		CDebugConsole::get().output_error(std::format("Got nullptr tm struct for {:08X} timestamp.", timestamp));
+		CDebugConsole::get().output_error("Failed to convert {:08X} timestamp.", timestamp);
 		return;
 	}
 
-	m_str_timestamp = std::asctime(t);
+	// Same layout as asctime(), without the newline
+	char buffer[32];
+	if (std::strftime(buffer, sizeof(buffer), "%a %b %e %H:%M:%S %Y", &t))
+		m_str_timestamp = buffer;
 }
\ No newline at end of file
@@ -31,6 +31,111 @@
 
 #pragma once
 
+//
+// Descriptions of the individual flags of bitfields, shared by every NamedBitfieldConstant
+// of that kind.
+//
+
+// https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#characteristics
+inline constexpr NamedBit<uint16_t> k_nt_characteristics_names[] =
+{
+	{ pe::k_file_relocs_stripped,			"No reloc" },
+	{ pe::k_file_executable_image,			"Executable" },
+	{ pe::k_file_line_nums_stripped,		"No line numbers" },
+	{ pe::k_file_local_syms_stripped,		"No symbols" },
+	{ pe::k_file_aggresive_ws_trim,			"Aggressively trim working set" },
+	{ pe::k_file_large_address_aware,		">2gb addrs" },
+	{ pe::k_file_bytes_reversed_lo,			"Machine word bytes reversed low" },
+	{ pe::k_file_32bit_machine,				"32-bit word machine" },
+	{ pe::k_file_debug_stripped,			"No debug (inside .DBG file instead)" },
+	{ pe::k_file_removable_run_from_swap,	"If on removable media, copy & run from the swap file" },
+	{ pe::k_file_net_run_from_swap,			"If on Net, copy & run from the swap file" },
+	{ pe::k_file_system,					"System File" },
+	{ pe::k_file_dll,						"DLL" },
+	{ pe::k_file_up_system_only,			"Should only be run on a UP machine" },
+	{ pe::k_file_bytes_reversed_hi,			"Machine word bytes are reversed high" },
+};
+
+// https://docs.microsoft.com/en-us/windows/win32/debug/pe-format#dll-characteristics
+inline constexpr NamedBit<uint16_t> k_nt_dll_characteristics_names[] =
+{
+	{ pe::k_dllcharacteristics_high_entropy_va,			"High entropy 64-bit VA space" },
+	{ pe::k_dllcharacteristics_dynamic_base,			"DLL with dynamic base" },
+	{ pe::k_dllcharacteristics_force_integrity,			"Code integrity" },
+	{ pe::k_dllcharacteristics_nx_compat,				"NX compatible" },
+	{ pe::k_dllcharacteristics_no_isolation,			"Image can't afford isolation" },
+	{ pe::k_dllcharacteristics_no_seh,					"No SE handler" },
+	{ pe::k_dllcharacteristics_no_bind,					"Not bindable" },
+	{ pe::k_dllcharacteristics_appcontainer,			"App container executable" },
+	{ pe::k_dllcharacteristics_wdm_driver,				"WDM driver model" },
+	{ pe::k_dllcharacteristics_guard_cf,				"Control Flow Guard support" },
+	{ pe::k_dllcharacteristics_terminal_server_aware,	"Terminal server aware" },
+};
+
+// https://docs.microsoft.com/en-us/windows/win32/debug/pe-format#section-flags
+inline constexpr NamedBit<uint32_t> k_section_characteristics_names[] =
+{
+	{ pe::k_scn_type_no_pad,				"Not padded" },
+	{ pe::k_scn_cnt_code,					"Executable code" },
+	{ pe::k_scn_cnt_initialized_data,		"Initialized data" },
+	{ pe::k_scn_cnt_uninitialized_data,		"Uninitialized data" },
+	{ pe::k_scn_lnk_other,					"Other (reserved)" },
+	{ pe::k_scn_lnk_info,					"Comments (.drectve)" },
+	{ pe::k_scn_lnk_remove,					"Not part of image" },
+	{ pe::k_scn_lnk_comdat,					"COMDAT data" },
+	{ pe::k_scn_gprel,						"Global Ptr data" },
+	{ pe::k_scn_mem_purgeable,				"Purgeable (reserved)" },
+	{ pe::k_scn_mem_16bit,					"16bit (reserved)" },
+	{ pe::k_scn_mem_locked,					"Locked (reserved)" },
+	{ pe::k_scn_mem_preload,				"Preload (reserved)" },
+	{ pe::k_scn_align_1bytes,				"1-byte aligned" },
+	{ pe::k_scn_align_2bytes,				"2-byte aligned" },
+	{ pe::k_scn_align_128bytes,				"128-byte aligned" },
+	{ pe::k_scn_lnk_nreloc_ovfl,			"Extended relocs" },
+	{ pe::k_scn_mem_discardable,			"Discardable" },
+	{ pe::k_scn_mem_not_cached,				"Uncachable" },
+	{ pe::k_scn_mem_not_paged,				"Unpageable" },
+	{ pe::k_scn_mem_shared,					"Memory-shareable" },
+	{ pe::k_scn_mem_execute,				"Executable" },
+	{ pe::k_scn_mem_read,					"Readable" },
+	{ pe::k_scn_mem_write,					"Writeable" },
+};
+
+inline constexpr NamedBit<uint32_t> k_load_cfg_guard_flags_names[] =
+{
+	{ pe::k_guard_cf_instrumented,						"Control-flow integrity checks" },
+	{ pe::k_guard_cfw_instrumented,						"Control-float and write integrity checks" },
+	{ pe::k_guard_cf_function_table_present,			"Contains valid control-flow function table" },
+	{ pe::k_guard_security_cookie_unused,				"Doesn't use /GS security cookie" },
+	{ pe::k_guard_protect_delayload_iat,				"Supports read-only IAT" },
+	{ pe::k_guard_delayload_iat_in_its_own_section,		"Delayload import table in its own .didat section" },
+	{ pe::k_guard_cf_export_suppression_info_present,	"Contains suppressed export information" },
+	{ pe::k_guard_cf_enable_export_suppression,			"Enabled suppression of exports" },
+	{ pe::k_guard_cf_longjump_table_present,			"Contains longjmp target information" },
+	{ pe::k_guard_rf_instrumented,						"Contains return flow instrumentation and metadata" },
+	{ pe::k_guard_rf_enable,							"Requests that the OS enable return flow protection" },
+	{ pe::k_guard_rf_strict,							"Requests that the OS enable return flow protection in strict mode" },
+	{ pe::k_guard_retpoline_present,					"Was built with retpoline support" },
+	{ pe::k_guard_eh_continuation_table_present,		"Contains EH continuation target information" },
+};
+
+inline constexpr NamedBit<uint32_t> k_load_cfg_process_heap_flags_names[] =
+{
+	{ pe::k_heap_no_serialize,				"" },
+	{ pe::k_heap_growable,					"" },
+	{ pe::k_heap_generate_exceptions,			"" },
+	{ pe::k_heap_zero_memory,					"" },
+	{ pe::k_heap_realloc_in_place_only,		"" },
+	{ pe::k_heap_tail_checking_enabled,		"" },
+	{ pe::k_heap_free_checking_enabled,		"" },
+	{ pe::k_heap_disable_coalesce_on_free,	"" },
+	{ pe::k_heap_create_hardened,				"" },
+	{ pe::k_heap_create_segment_heap,			"" },
+	{ pe::k_heap_create_align_16,				"" },
+	{ pe::k_heap_create_enable_tracing,		"" },
+	{ pe::k_heap_create_enable_execute,		"" },
+};
+
 class IntegerTimestamp
 {
 public:
@@ -43,8 +148,10 @@ public:
 
 	inline bool is_valid() const { return m_dw_timestamp != 0; }
 
+	inline uint32_t as_integer() const { return m_dw_timestamp; }
+
 private:
-	uint32_t m_dw_timestamp;
+	uint32_t m_dw_timestamp = 0;
 	std::string m_str_timestamp;
 };
 
@@ -56,7 +163,7 @@ public:
 	{
 	}
 
-	void stringify_me(const GUID& guid);
+	void stringify_me(const pe::Guid& guid);
 
 public:
 	inline const auto& get() const { return m_str_guid; }
@@ -78,12 +185,15 @@ public:
 	SmartDecValue<uint32_t> m_size;
 };
 
+// Names of exports, imports and strings found inside of the image are views into
+// the processor's byte buffer and are valid for as long as the processor is alive.
+
 class ImageExport
 {
 public:
-	std::string m_name;
+	std::string_view m_name;
 	SmartDecValue<uint16_t> m_ordinal;
-	SmartHexValue<uint32_t> m_address;
+	SmartAddrValue<uint64_t> m_address;
 	bool is_forwarded;
 };
 
@@ -94,43 +204,59 @@ public:
 	inline bool imported_by_name() const { return !m_name.empty(); }
 
 public:
-	std::string m_name; // Can be imported either by name or by an ordinal
+	std::string_view m_name; // Can be imported either by name or by an ordinal
 	
 	SmartDecValue<uint16_t> m_ordinal;
 	SmartDecValue<uint16_t> m_hint; // This comes with the name
 
 	// VA to an entry inside IAT
-	SmartHexValue<uint32_t> m_import_va;
+	SmartAddrValue<uint64_t> m_import_va;
 };
 
 class ImageImportDescriptor
 {
+public:
+	ImageImportDescriptor() = default;
+
+	explicit ImageImportDescriptor(std::pmr::memory_resource* arena) :
+		m_import_thunks(arena)
+	{
+	}
+
 public:
 	inline bool has_thunks() const { return !m_import_thunks.empty(); }
 
 public:
-	std::string m_image_name;
-	std::vector<ImageImportThunk> m_import_thunks;
+	std::string_view m_image_name;
+	std::pmr::vector<ImageImportThunk> m_import_thunks;
 
 	// VA to an entry inside IAT. Descriptors also have one.
-	SmartHexValue<uint32_t> m_descriptor_va;
+	SmartAddrValue<uint64_t> m_descriptor_va;
 };
 
 class ImageDelayedImportDescriptor
 {
+public:
+	ImageDelayedImportDescriptor() = default;
+
+	explicit ImageDelayedImportDescriptor(std::pmr::memory_resource* arena) :
+		m_import_thunks(arena)
+	{
+	}
+
 public:
 	inline bool has_thunks() const { return !m_import_thunks.empty(); }
 
 public:
-	DLAttr m_attributes;
+	uint32_t m_attributes;
 
-	std::string m_image_name;
+	std::string_view m_image_name;
 	SmartHexValue<uint32_t> m_module_handle_rva;
 
-	std::vector<ImageImportThunk> m_import_thunks;
+	std::pmr::vector<ImageImportThunk> m_import_thunks;
 
 	// VA to an entry inside IAT. Descriptors also have one.
-	SmartHexValue<uint32_t> m_descriptor_va;
+	SmartAddrValue<uint64_t> m_descriptor_va;
 
 	IntegerTimestamp m_timestamp;
 };
@@ -138,9 +264,9 @@ public:
 class ImageIATEntry
 {
 public:
-	SmartHexValue<uint32_t> m_va;
+	SmartAddrValue<uint64_t> m_va;
 
-	std::string m_refered_thunk_or_descriptor_name;
+	std::string_view m_refered_thunk_or_descriptor_name;
 };
 
 class ImageSection
@@ -152,7 +278,7 @@ public:
 	// Returns end address of the section
 	inline auto virtual_end_addr() const 
 	{ 
-		return SmartHexValue<uint32_t>(m_va_base + m_va_size - 1);
+		return SmartAddrValue<uint64_t>(m_va_base + m_va_size - 1);
 	}
 
 	inline bool is_valid() const 
@@ -163,7 +289,7 @@ public:
 public:
 	std::string m_name;
 
-	SmartHexValue<uint32_t> m_va_base;
+	SmartAddrValue<uint64_t> m_va_base;
 	SmartHexValue<uint32_t> m_va_size;
 
 	SmartHexValue<int32_t> m_zero_padding;
@@ -177,7 +303,64 @@ public:
 	SmartHexValue<uint32_t> m_relocs_ptr;
 	SmartHexValue<uint16_t> m_relocs_num;
 
-	NamedBitfieldConstant<uint32_t> m_characteristics;
+	NamedBitfieldConstant<uint32_t, k_section_characteristics_names> m_characteristics;
+
+	// Of the raw data
+	std::string m_md5, m_sha256;
+
+	// Bits per byte, high values hint at packed or encrypted data
+	double m_entropy = 0.0, m_max_window_entropy = 0.0;
+	std::vector<float> m_window_entropies; // See EntropyMeter
+};
+
+// Contiguous RVA range of a section together with the file pointer it translates to.
+// Kept inside of a sorted vector so that RVA lookups are a binary search.
+class ImageSectionInterval
+{
+public:
+	inline bool contains(uint32_t rva) const { return rva >= m_rva_begin && rva < m_rva_end; }
+	inline uint64_t translate(uint32_t rva) const { return (uint64_t)(rva - m_rva_begin) + m_raw_data_ptr; }
+
+public:
+	uint32_t m_rva_begin, m_rva_end; // [begin, end)
+	uint32_t m_raw_data_ptr;
+};
+
+// Leaf of the resource tree, one per type, name and language. Only where the data is
+// gets indexed, it's decoded once something asks for it.
+class ImageResource
+{
+public:
+	// Name of a RT_* type, nullptr if the type isn't defined.
+	static const char* type_name(uint16_t type);
+
+	// Named types have the high bit set, so they never match an id
+	inline bool is_type(uint16_t type) const { return m_type == type; }
+
+	// Outside of the image, there's nothing to decode
+	inline bool has_data() const { return m_data_off != 0; }
+
+public:
+	uint64_t m_data_off; // File pointer to the data, 0 if it isn't inside of any section
+
+	// Name fields of the directory entries on the way to this leaf, exactly as they are
+	// in the image. Either an id or an offset of the name, see resource_entry_name().
+	uint32_t m_type, m_name;
+
+	SmartHexValue<uint32_t> m_data_rva;
+	SmartDecValue<uint32_t> m_size;
+	SmartDecValue<uint32_t> m_codepage;
+	SmartHexValue<uint16_t> m_language;
+};
+
+// Decoded from a RT_VERSION resource whenever it's asked for
+class ImageVersionInfo
+{
+public:
+	std::string m_file_version, m_product_version; // Of the fixed part, "major.minor.build.revision"
+
+	// StringFileInfo, e.g. CompanyName or OriginalFilename
+	std::vector<std::pair<std::string, std::string>> m_strings;
 };
 
 class ImageWinCertificate
@@ -191,7 +374,7 @@ public:
 	// offsetting to the next entry.
 	SmartDecValue<uint32_t> m_entry_length;
 
-	SmartHexValue<uint32_t> m_cert_raw_data_va;
+	SmartAddrValue<uint64_t> m_cert_raw_data_va;
 
 	NamedConstant<uint16_t> m_revision_version;
 	NamedConstant<uint16_t> m_cert_type;
@@ -200,19 +383,26 @@ public:
 class ImageRelocationBlock
 {
 public:
-	SmartHexValue<uint32_t> m_page_rva;
-	SmartDecValue<uint32_t> m_size; // block size
+	ImageRelocationBlock() = default;
 
-	struct BlockInfo
+	explicit ImageRelocationBlock(std::pmr::memory_resource* arena) :
+		m_types(arena), m_offsets(arena)
 	{
-		void process_block_info_type(uint32_t type);
+	}
 
-		NamedConstant<uint32_t> m_type;
-		SmartHexValue<uint32_t> m_offset;
-	};
+public:
+	// Name of a IMAGE_REL_BASED_* type, nullptr if the type isn't defined.
+	static const char* type_name(uint8_t type);
+
+	inline size_t num_entries() const { return m_offsets.size(); }
+
+	SmartHexValue<uint32_t> m_page_rva;
+	SmartDecValue<uint32_t> m_size; // block size
 
-	// Type & offset
-	std::vector<BlockInfo> m_block_info_entries;
+	// Type & offset of every entry, stored apart so that a block costs about as much
+	// as it does in the image. Names are only looked up when rendered.
+	std::pmr::vector<uint8_t> m_types;
+	std::pmr::vector<uint16_t> m_offsets;
 };
 
 class ImageDebugDirectory
@@ -220,7 +410,7 @@ class ImageDebugDirectory
 public:
 	void process_type(uint32_t type);
 
-	void process_type_cv(const ByteBuffer<uint32_t>& byte_buffer);
+	bool process_type_cv(const ByteBuffer<uint64_t>& byte_buffer);
 
 public:
 	IntegerTimestamp m_timestamp;
@@ -230,7 +420,7 @@ public:
 	NamedConstant<uint32_t> m_type;
 
 	SmartHexValue<uint32_t> m_size_of_data;
-	SmartHexValue<uint32_t> m_address_of_raw_data_va;
+	SmartAddrValue<uint64_t> m_address_of_raw_data_va;
 	SmartHexValue<uint32_t> m_file_pointer_to_raw_data;
 
 public:
@@ -238,13 +428,13 @@ public:
 	{
 	public:
 		// CodeView magic signatures
-		static inline constexpr const ULONG k_sigRSDS = 'SDSR';
-		static inline constexpr const ULONG k_sigNB09 = '90BN';
-		static inline constexpr const ULONG k_sigNB10 = '01BN';
-		static inline constexpr const ULONG k_sigNB11 = '11BN';
+		static inline constexpr const uint32_t k_sigRSDS = 'SDSR';
+		static inline constexpr const uint32_t k_sigNB09 = '90BN';
+		static inline constexpr const uint32_t k_sigNB10 = '01BN';
+		static inline constexpr const uint32_t k_sigNB11 = '11BN';
 
 	public:
-		NamedConstant<ULONG> m_magic_signature;
+		NamedConstant<uint32_t> m_magic_signature;
 
 		// RSDS
 		GUIDString m_rsds_guid_pdb_sig;
@@ -264,11 +454,11 @@ public:
 class ImageString
 {
 public:
-	std::string m_string;
-	SmartHexValue<uint32_t> m_va;
+	std::string_view m_string; // Not NUL-terminated!
+	SmartAddrValue<uint64_t> m_va;
 
 	// Section where we did find this string
-	std::string m_parent_sec_name;
+	std::string_view m_parent_sec_name;
 };
 
 class ImageLoadCFGCodeIntegrity
@@ -282,40 +472,95 @@ public:
 class CX86PEProcessor final : public IBaseProcessor
 {
 public:
+	// Parts of the image that can be rendered while the rest is still being processed.
+	// Data directories have flags of their own.
+	enum class Stage
+	{
+		Dos,
+		Sections,
+		NtHeaders, // Including the list of data directories
+		Strings,
+		Hashes, // Including the checksum and the entropy of sections
+	};
+
+public:
+	// Decoding that may still run on the thread pool has to finish first
+	~CX86PEProcessor();
+
+	// Parses only the headers and the sections, everything else is decoded on demand.
 	bool process(const std::filesystem::path& filepath) override;
 
+	void decode_all() override;
+
+	// Writes only what has been decoded so far
+	void write_summary(JsonLineWriter& record) const override;
+
+	// Resources are only indexed along with the resource directory. Their data is looked
+	// at by these, whenever the caller needs it.
+	std::string_view resource_data(const ImageResource& resource) const;
+	std::string resource_entry_name(uint32_t name) const;
+	const ImageResource* find_resource(uint16_t type) const;
+	bool decode_version_info(const ImageResource& resource, ImageVersionInfo& info) const;
+
+#ifndef EXEIN_HEADLESS
 	void render_gui() override;
 
 private:
+	void render_headers();
 	void render_tabs();
 	void render_tab_sections();
 	void render_tab_exports();
 	void render_tab_imports();
 	void render_tab_certificates();
+	void render_tab_hashes();
 	void render_tab_relocations();
+	void render_tab_resources();
+	std::string make_resource_preview(const ImageResource& resource) const;
 	void render_tab_debug();
 	void render_tab_load_cfg();
 	void render_tab_strings();
 	void render_tab_misc();
 	void render_content_tab(const std::string& label, bool does_exist, const std::function<void()>& pfn_contents);
 
+	// For lazily decoded parts. The part is requested only once the tab has been opened,
+	// the contents are rendered after it's been decoded.
+	void render_content_tab(const std::string& label, bool does_exist, const std::function<bool()>& pfn_request, const std::function<void()>& pfn_contents);
+
 	template<typename T>
 	void render_named_bitfield_constant_generic(const T& flags, const std::string& label, const char* child, uint32_t& active_flags_static);
+#endif
 
+private:
 	bool process_dos();
 	bool process_dos_magic(uint16_t magic);
 	void process_dos_stub(uint32_t off, uint32_t size);
 
+	// Everything that depends on the layout of the image is templated over pe::Pe32Traits
+	// and pe::Pe64Traits. The format is only branched on once per header or directory.
 	bool process_nt_headers();
+	template<typename Traits> bool process_nt_headers(const typename Traits::NtHeaders* pnt_hdrs);
 	bool process_nt_sig(uint32_t sig);
-	bool process_nt_file_hdr(const IMAGE_FILE_HEADER* pfile_hdr);
-	bool process_nt_opt_hdr(const IMAGE_OPTIONAL_HEADER* popt_hdr);
+	template<typename Traits> bool process_nt_file_hdr(const pe::ImageFileHeader* pfile_hdr);
+	template<typename Traits> bool process_nt_opt_hdr(const typename Traits::OptionalHeader* popt_hdr);
 	void process_nt_characteristics(uint16_t characs);
-	bool process_nt_data_dir_entries(const IMAGE_OPTIONAL_HEADER* popt_hdr);
+	template<typename Traits> bool process_nt_data_dir_entries(const typename Traits::OptionalHeader* popt_hdr);
+
+	// Everything past the headers is decoded by whichever thread asks for it first, at most
+	// once. Other threads asking for it at the same time block until it has been decoded.
+	void decode_data_dir(uint32_t i);
+	void decode_strings();
+	void decode_hashes();
+
+	// Non-blocking. The part is decoded on the thread pool the first time it's requested,
+	// returns whether it's been decoded already.
+	bool request_data_dir(uint32_t i);
+	bool request_stage(Stage stage);
+
+	template<typename Traits>
+	static auto data_dir_decoder(uint32_t i) -> void(CX86PEProcessor::*)(const ImageDataDir&);
 
-	void process_nt_data_directories();
 	void process_nt_data_dir_exports(const ImageDataDir& dir_entry);
-	void process_nt_data_dir_imports(const ImageDataDir& dir_entry);
+	template<typename Traits> void process_nt_data_dir_imports(const ImageDataDir& dir_entry);
 	void process_nt_data_dir_resources(const ImageDataDir& dir_entry);
 	void process_nt_data_dir_exceptions(const ImageDataDir& dir_entry);
 	void process_nt_data_dir_certificates(const ImageDataDir& dir_entry);
@@ -323,11 +568,12 @@ private:
 	void process_nt_data_dir_debug(const ImageDataDir& dir_entry);
 	void process_nt_data_dir_arch(const ImageDataDir& dir_entry);
 	void process_nt_data_dir_global_ptr(const ImageDataDir& dir_entry);
-	void process_nt_data_dir_tls(const ImageDataDir& dir_entry);
-	void process_nt_data_dir_load_cfg(const ImageDataDir& dir_entry);
+	template<typename Traits> void process_nt_data_dir_tls(const ImageDataDir& dir_entry);
+	template<typename Traits> void process_nt_data_dir_load_cfg(const ImageDataDir& dir_entry);
 	void process_nt_data_dir_bound_import(const ImageDataDir& dir_entry);
-	void process_nt_data_dir_iat(const ImageDataDir& dir_entry);
-	void process_nt_data_dir_delay_import(const ImageDataDir& dir_entry);
+	template<typename Traits> void process_nt_data_dir_iat(const ImageDataDir& dir_entry);
+	void build_iat_slot_owners();
+	template<typename Traits> void process_nt_data_dir_delay_import(const ImageDataDir& dir_entry);
 	void process_nt_data_dir_clr_runtime(const ImageDataDir& dir_entry);
 
 	void process_nt_machine(uint16_t machine);
@@ -336,12 +582,26 @@ private:
 	void process_nt_dll_characteristics(uint16_t dll_characteristics);
 
 	bool process_sections();
+	void build_section_intervals();
+	void process_overlay();
 
 	void process_image_strings();
 
+	void process_file_digests();
+	void process_section_data();
+	void process_import_hash();
+
 	void process_load_cfg_guard_flags(uint32_t flags);
 	void process_load_cfg_process_heap_flags(uint32_t flags);
 
+	// Everything that is expensive to parse, in the order of the parser
+	void write_cache_entry(BinaryWriter& writer) const;
+	bool restore_from_cache(BinaryReader& reader);
+	void discard_restored_data();
+
+	// Stores the entry once every cached part has been decoded
+	void store_in_cache_if_decoded();
+
 private:
 	// https://docs.microsoft.com/en-us/windows/win32/debug/pe-format#coff-file-header-object-and-image
 	static inline uint32_t max_number_of_sections() { return 96; }
@@ -355,7 +615,7 @@ private:
 	// Accepts rva address and returns file pointer to the address 
 	// relative to the start of appropriate section. If the rva is
 	// out of bounds of all sections, 0 is returned.
-	uint32_t offset_relative_to_a_section(uint32_t rva);
+	uint64_t offset_relative_to_a_section(uint32_t rva);
 
 	inline const ImageSection& get_section_by_name(const std::string& section_name) const
 	{
@@ -366,17 +626,70 @@ private:
 		}
 		catch (...)
 		{
-			CDebugConsole::get().output_error(std::format("Failed to obtain section: {}", section_name));
+			CDebugConsole::get().output_error("Failed to obtain section: {}", section_name);
 			return dummy_section;
 		}
 	}
 
 	inline bool image_has_tls() const { return m_tls_raw_data_start_va && m_tls_raw_data_size; }
 
-	inline uint32_t va_as_rva(uint32_t va) const { return va - m_img_base; }
-	inline uint32_t rva_as_va(uint32_t rva) const { return rva + m_img_base; }
+	// Lookup only, unlike operator[] this is safe while the directories are being processed.
+	inline bool is_data_dir_present(uint32_t i) const
+	{
+		auto iter = m_data_dirs.find(i);
+		return iter != m_data_dirs.end() && iter->second.is_present();
+	}
+
+	// Same but safe to call while the headers are still being processed, e.g. by the GUI
+	inline bool data_dir_exists(uint32_t i) const { return is_ready(Stage::NtHeaders) && is_data_dir_present(i); }
+
+	// Data of a stage or a directory is never touched by the processing thread once
+	// it's been marked as ready, so the GUI can read it without any locking.
+	inline void mark_ready(Stage stage) { m_ready_stages.fetch_or(1u << (uint32_t)stage, std::memory_order_release); }
+	inline bool is_ready(Stage stage) const { return m_ready_stages.load(std::memory_order_acquire) & (1u << (uint32_t)stage); }
+
+	inline void mark_data_dir_ready(uint32_t i) { m_ready_data_dirs.fetch_or(1u << i, std::memory_order_release); }
+	inline bool is_data_dir_ready(uint32_t i) const { return m_ready_data_dirs.load(std::memory_order_acquire) & (1u << i); }
+
+	inline uint32_t va_as_rva(uint64_t va) const { return (uint32_t)(va - m_img_base); }
+	inline uint64_t rva_as_va(uint32_t rva) const { return rva + m_img_base; }
+
+	inline bool is_pe32_plus() const { return m_nt_magic.is(pe::k_nt_optional_hdr64_magic); }
 
 private:
+	// One step per stage done by process(). Parts decoded on demand add their own steps,
+	// one per data directory and hash stage and one per string scan chunk.
+	static constexpr uint32_t k_num_progress_steps = 3;
+
+	// Has to be bumped whenever anything that is cached gets parsed differently or the
+	// layout of the entry changes, entries of older versions are then never looked up.
+	static constexpr uint32_t k_parse_cache_version = 4;
+
+	// Directories that are restored from the parse cache rather than parsed
+	static inline bool is_data_dir_cached(uint32_t i)
+	{
+		return i == pe::k_directory_entry_export || i == pe::k_directory_entry_import || i == pe::k_directory_entry_basereloc;
+	}
+
+	std::atomic<uint32_t> m_ready_stages = 0, m_ready_data_dirs = 0;
+
+	// Parts that have been handed to the thread pool, see request_data_dir()
+	std::atomic<uint32_t> m_requested_stages = 0, m_requested_data_dirs = 0;
+	CTaskGroup m_decode_group;
+
+	std::array<std::once_flag, pe::k_numberof_directory_entries> m_data_dirs_decoded;
+	std::once_flag m_strings_decoded, m_hashes_decoded;
+
+	// Parse cache entry of this file, mapped only while it's being processed
+	CParseCache::Key m_cache_key;
+	CParseCacheEntry m_cache_entry;
+	bool m_restored_from_cache = false;
+	std::atomic<bool> m_stored_in_cache = false;
+
+	// Parsed records are allocated from here and given back all at once when the processor
+	// goes away. Has to be declared before any container that allocates from it.
+	Arena m_arena;
+
 	// DOS header
 	NamedConstant<uint16_t> m_dos_magic;
 	uint16_t m_number_of_pages;
@@ -391,75 +704,104 @@ private:
 	NamedConstant<uint16_t> m_nt_machine; // CPU type
 	uint32_t m_num_sections;
 	IntegerTimestamp m_nt_time_date_stamp; // Creation of the file
-	NamedBitfieldConstant<uint16_t> m_nt_characteristics;
+	NamedBitfieldConstant<uint16_t, k_nt_characteristics_names> m_nt_characteristics;
 
 	// Optional header
 	NamedConstant<uint16_t> m_nt_magic;
-	SmartHexValue<uint32_t> m_img_base;
-	SmartHexValue<uint32_t> m_code_base_va;
+	SmartAddrValue<uint64_t> m_img_base;
+	SmartAddrValue<uint64_t> m_code_base_va;
 	SmartHexValue<uint32_t> m_code_size;
-	SmartHexValue<uint32_t> m_data_base_va;
+	SmartAddrValue<uint64_t> m_data_base_va;
 	SmartHexValue<uint32_t> m_uninitialized_data_size; // Uninitialized data section (.bss)
 	SmartHexValue<uint32_t> m_initialized_data_size;
-	SmartHexValue<uint32_t> m_entry_point_va;
+	SmartAddrValue<uint64_t> m_entry_point_va;
 	SmartHexValue<uint32_t> m_section_alignment, m_file_alignment;
 	SmartHexValue<uint32_t> m_size_of_image; // Size including all headers as the image is loaded in memory
 	SmartHexValue<uint32_t> m_size_of_hdrs;
 	SmartHexValue<uint32_t> m_image_checksum_calc, m_image_checksum_real;
 	NamedConstant<uint32_t> m_nt_subsystem;
-	NamedBitfieldConstant<uint16_t> m_nt_dll_characteristics;
+	NamedBitfieldConstant<uint16_t, k_nt_dll_characteristics_names> m_nt_dll_characteristics;
 	uint32_t m_number_of_data_directories;
 
 	// Sections
 	std::unordered_map<std::string, ImageSection> m_sections;
 
-	// Data directories (Use MAGE_DIRECTORY_ENTRY_* macros as keys)
+	// Sections sorted by their RVA, used for RVA to file offset translation.
+	std::vector<ImageSectionInterval> m_section_intervals;
+	// Index of the interval that resolved the last lookup. Data directories are parsed
+	// concurrently, the hint is validated before use so a relaxed race on it is harmless.
+	std::atomic<size_t> m_last_section_hit = 0;
+
+	// Overlay (data appended past the last section, e.g. installer payloads)
+	uint64_t m_overlay_offset = 0, m_overlay_size = 0;
+
+	// Data directories (Use pe::k_directory_entry_* constants as keys)
 	std::unordered_map<uint32_t, ImageDataDir> m_data_dirs;
 
 	// Exports
-	uint32_t m_number_of_exported_functions;
-	uint32_t m_number_of_exported_names;
+	uint32_t m_number_of_exported_functions = 0;
+	uint32_t m_number_of_exported_names = 0;
 	SmartDecValue<uint32_t> m_export_starting_ordinal_num; // Obtained by IMAGE_EXPORT_DIRECTORY::Base
 	std::string m_export_dll_name; // Obtained by IMAGE_EXPORT_DIRECTORY::Name
 	IntegerTimestamp m_export_creation_timestamp;
-	std::vector<ImageExport> m_image_exports;
+	std::pmr::vector<ImageExport> m_image_exports{ &m_arena };
 
 	// Imports
-	uint32_t m_number_of_import_descriptors;
-	uint32_t m_number_of_import_thunk_ordinals, m_number_of_import_thunk_names; // number of imports snapped by ordinal or name. The sum of these two is the total sum
-	SmartHexValue<uint32_t> m_imports_iat_base;
-	std::vector<ImageImportDescriptor> m_image_import_descriptors;
+	uint32_t m_number_of_import_descriptors = 0;
+	uint32_t m_number_of_import_thunk_ordinals = 0, m_number_of_import_thunk_names = 0; // number of imports snapped by ordinal or name. The sum of these two is the total sum
+	SmartAddrValue<uint64_t> m_imports_iat_base;
+	std::pmr::vector<ImageImportDescriptor> m_image_import_descriptors{ &m_arena };
 
 	// Delayed Imports
-	uint32_t m_number_of_delayed_import_descriptors;
-	uint32_t m_number_of_delayed_import_thunk_ordinals, m_number_of_delayed_import_thunk_names; // number of imports snapped by ordinal or name. The sum of these two is the total sum
-	std::vector<ImageDelayedImportDescriptor> m_image_delayed_import_descriptors;
+	uint32_t m_number_of_delayed_import_descriptors = 0;
+	uint32_t m_number_of_delayed_import_thunk_ordinals = 0, m_number_of_delayed_import_thunk_names = 0; // number of imports snapped by ordinal or name. The sum of these two is the total sum
+	std::pmr::vector<ImageDelayedImportDescriptor> m_image_delayed_import_descriptors{ &m_arena };
 
 	// Import Address Table (IAT)
-	std::vector<ImageIATEntry> m_iat_entries;
+	std::pmr::vector<ImageIATEntry> m_iat_entries{ &m_arena };
+
+	// VA of an IAT slot -> name of the thunk or descriptor that owns it. Built from
+	// the (delayed) import thunks so that the IAT can be named in one pass.
+	std::pmr::unordered_map<uint64_t, std::string_view> m_iat_slot_owners{ &m_arena };
 
 	// Certificates
-	std::vector<ImageWinCertificate> m_image_certificates;
+	std::pmr::vector<ImageWinCertificate> m_image_certificates{ &m_arena };
+
+	// Hashes
+	std::string m_file_md5, m_file_sha256;
+	std::string m_authenticode_sha1, m_authenticode_sha256; // Computed whether the image is signed or not
+	std::string m_import_hash; // Empty without imports
 
 	// Global register pointer
 	SmartHexValue<uint32_t> m_global_ptr_register;
 
 	// TLS data
-	SmartHexValue<uint32_t> m_tls_raw_data_start_va, m_tls_raw_data_end_va;
+	SmartAddrValue<uint64_t> m_tls_raw_data_start_va, m_tls_raw_data_end_va;
 	SmartHexValue<uint32_t> m_tls_raw_data_size;
-	SmartHexValue<uint32_t> m_tls_index_va; // VA to the address of __tls_index
+	SmartAddrValue<uint64_t> m_tls_index_va; // VA to the address of __tls_index
 	SmartHexValue<uint32_t> m_tls_size_of_zero_fill;
-	SmartHexValue<uint32_t> m_tls_base_of_callbacks_va; // VA to the base of callbacks
-	std::vector<SmartValue<uint32_t>> m_tls_callbacks_va; // Vector containing VAs to individual callbacks
+	SmartAddrValue<uint64_t> m_tls_base_of_callbacks_va; // VA to the base of callbacks
+	std::pmr::vector<SmartAddrValue<uint64_t>> m_tls_callbacks_va{ &m_arena }; // Vector containing VAs to individual callbacks
 
 	// Relocations
-	std::vector<ImageRelocationBlock> m_relocation_blocks;
+	std::pmr::vector<ImageRelocationBlock> m_relocation_blocks{ &m_arena };
+
+	// Resources, in the order of the tree
+	uint64_t m_resources_off = 0; // File pointer to the root directory, names are relative to it
+	uint32_t m_number_of_resource_types = 0;
+	std::pmr::vector<ImageResource> m_image_resources{ &m_arena };
+
+#ifndef EXEIN_HEADLESS
+	// Picked inside of the resources tab, decoded only when the pick changes
+	size_t m_gui_selected_resource = SIZE_MAX;
+	std::string m_gui_resource_preview;
+#endif
 
 	// Debug directories
-	std::vector<ImageDebugDirectory> m_debug_directories;
+	std::pmr::vector<ImageDebugDirectory> m_debug_directories{ &m_arena };
 
 	// Strings
-	std::vector<ImageString> m_image_strings;
+	std::pmr::vector<ImageString> m_image_strings{ &m_arena };
 	std::string m_image_strings_found_in; // Silly name but basically separated string of section names in
 	// which we found any strings.
 
@@ -468,41 +810,41 @@ private:
 	SmartHexValue<uint32_t> m_load_cfg_global_flags_clear;
 	SmartHexValue<uint32_t> m_load_cfg_global_flags_set;
 	SmartHexValue<uint32_t> m_load_cfg_cs_default_timeout; // critical section
-	SmartHexValue<uint32_t> m_load_cfg_decommit_free_block_threshold;
-	SmartHexValue<uint32_t> m_load_cfg_decommit_total_block_threshold;
-	SmartHexValue<uint32_t> m_load_cfg_lock_prefix_table_va;
-	SmartHexValue<uint32_t> m_load_cfg_max_proc_heap_alloc_size;
-	SmartHexValue<uint32_t> m_load_cfg_vm_threshold; // virtual memory
-	NamedBitfieldConstant<uint32_t> m_load_cfg_process_heap_flags;
-	SmartHexValue<uint32_t> m_load_cfg_process_affinity_mask;
+	SmartAddrValue<uint64_t> m_load_cfg_decommit_free_block_threshold;
+	SmartAddrValue<uint64_t> m_load_cfg_decommit_total_block_threshold;
+	SmartAddrValue<uint64_t> m_load_cfg_lock_prefix_table_va;
+	SmartAddrValue<uint64_t> m_load_cfg_max_proc_heap_alloc_size;
+	SmartAddrValue<uint64_t> m_load_cfg_vm_threshold; // virtual memory
+	NamedBitfieldConstant<uint32_t, k_load_cfg_process_heap_flags_names> m_load_cfg_process_heap_flags;
+	SmartAddrValue<uint64_t> m_load_cfg_process_affinity_mask;
 	SmartHexValue<uint16_t> m_load_cfg_service_pack_ver_id;
 	SmartHexValue<uint16_t> m_load_cfg_dependent_load_flags;
-	SmartHexValue<uint32_t> m_load_cfg_edit_list_va;
-	SmartHexValue<uint32_t> m_load_cfg_security_cookie_va;
-	SmartHexValue<uint32_t> m_load_cfg_seh_table_va;
-	SmartDecValue<uint32_t> m_load_cfg_seh_handlers_count;
-	SmartHexValue<uint32_t> m_load_cfg_guard_cfg_check_func_ptr_va;		// VA of Control Flow Guard check-function pointer
-	SmartHexValue<uint32_t> m_load_cfg_guard_cfg_dispatch_func_ptr_va;	// VA of Control Flow Guard dispatch-function pointer
-	SmartHexValue<uint32_t> m_load_cfg_guard_cfg_func_table_va;			// VA of the sorted table of RVAs of each Control Flow Guard function in the image
-	SmartDecValue<uint32_t> m_load_cfg_guard_cfg_func_table_entries;
-	NamedBitfieldConstant<uint32_t> m_load_cfg_guard_flags;
+	SmartAddrValue<uint64_t> m_load_cfg_edit_list_va;
+	SmartAddrValue<uint64_t> m_load_cfg_security_cookie_va;
+	SmartAddrValue<uint64_t> m_load_cfg_seh_table_va;
+	SmartDecValue<uint64_t> m_load_cfg_seh_handlers_count;
+	SmartAddrValue<uint64_t> m_load_cfg_guard_cfg_check_func_ptr_va;		// VA of Control Flow Guard check-function pointer
+	SmartAddrValue<uint64_t> m_load_cfg_guard_cfg_dispatch_func_ptr_va;	// VA of Control Flow Guard dispatch-function pointer
+	SmartAddrValue<uint64_t> m_load_cfg_guard_cfg_func_table_va;			// VA of the sorted table of RVAs of each Control Flow Guard function in the image
+	SmartDecValue<uint64_t> m_load_cfg_guard_cfg_func_table_entries;
+	NamedBitfieldConstant<uint32_t, k_load_cfg_guard_flags_names> m_load_cfg_guard_flags;
 	ImageLoadCFGCodeIntegrity m_load_cfg_ci; // code integrity
-	SmartHexValue<uint32_t> m_load_cfg_guard_addr_taken_iat_entry_table_va;			// VA of Control Flow Guard address taken IAT table
-	SmartDecValue<uint32_t> m_load_cfg_guard_addr_taken_iat_entry_table_entries;
-	SmartHexValue<uint32_t> m_load_cfg_guard_long_jump_target_table_va;				// VA of Control Flow Guard long jump target table
-	SmartDecValue<uint32_t> m_load_cfg_guard_long_jump_target_table_entries;
-	SmartHexValue<uint32_t> m_load_cfg_dynamic_value_reloc_table_va;
-	SmartHexValue<uint32_t> m_load_cfg_chpe_metadata;
-	SmartHexValue<uint32_t> m_load_cfg_guard_rf_failure_routine_va;
-	SmartHexValue<uint32_t> m_load_cfg_guard_rf_failure_routine_func_ptr_va;
+	SmartAddrValue<uint64_t> m_load_cfg_guard_addr_taken_iat_entry_table_va;			// VA of Control Flow Guard address taken IAT table
+	SmartDecValue<uint64_t> m_load_cfg_guard_addr_taken_iat_entry_table_entries;
+	SmartAddrValue<uint64_t> m_load_cfg_guard_long_jump_target_table_va;				// VA of Control Flow Guard long jump target table
+	SmartDecValue<uint64_t> m_load_cfg_guard_long_jump_target_table_entries;
+	SmartAddrValue<uint64_t> m_load_cfg_dynamic_value_reloc_table_va;
+	SmartAddrValue<uint64_t> m_load_cfg_chpe_metadata;
+	SmartAddrValue<uint64_t> m_load_cfg_guard_rf_failure_routine_va;
+	SmartAddrValue<uint64_t> m_load_cfg_guard_rf_failure_routine_func_ptr_va;
 	SmartHexValue<uint32_t> m_load_cfg_dynamic_value_reloc_table_offs;
 	SmartHexValue<uint16_t> m_load_cfg_dynamic_value_reloc_table_section;
-	SmartHexValue<uint32_t> m_load_cfg_guard_rf_verify_stack_ptr_func_ptr_va;
+	SmartAddrValue<uint64_t> m_load_cfg_guard_rf_verify_stack_ptr_func_ptr_va;
 	SmartHexValue<uint32_t> m_load_cfg_hot_patch_table_offs;
-	SmartHexValue<uint32_t> m_load_cfg_enclave_config_ptr_va;
-	SmartHexValue<uint32_t> m_load_cfg_volatile_metadata_pointer_va;
-	SmartHexValue<uint32_t> m_load_cfg_guard_eh_continuation_table_va;
-	SmartDecValue<uint32_t> m_load_cfg_guard_eh_continuation_table_entries;
+	SmartAddrValue<uint64_t> m_load_cfg_enclave_config_ptr_va;
+	SmartAddrValue<uint64_t> m_load_cfg_volatile_metadata_pointer_va;
+	SmartAddrValue<uint64_t> m_load_cfg_guard_eh_continuation_table_va;
+	SmartDecValue<uint64_t> m_load_cfg_guard_eh_continuation_table_entries;
 };
 
 #endif
\ No newline at end of file
@@ -36,25 +36,75 @@
 class IBaseProcessor
 {
 public:
+	// The buffer is released only here, parsed records may hold views into it.
+	virtual ~IBaseProcessor()
+	{
+		if (m_byte_buffer.get_raw())
+			m_byte_buffer.destroy();
+	}
+
 	// Digs out as much information as possible from the binary stream
 	virtual bool process(const std::filesystem::path& filepath) { return false; }
+
+	// Decodes everything that process() has left to be decoded on demand. Only
+	// valid after process() has succeeded.
+	virtual void decode_all() {}
 	
 	// Render contents specific to information we gained from this file.
 	virtual void render_gui() {}
 
+	// Machine-readable summary of the processed file, used by the batch scanner.
+	virtual void write_summary(JsonLineWriter&) const {}
+
 	// To tell outside code whenether we've finished or not
-	inline bool finished_processing() const { return m_processed; }
+	inline bool finished_processing() const { return m_processed.load(std::memory_order_acquire); }
 
 	inline const auto& get_input_file() const { return m_input_file; }
 
+	// process() may run on a background thread, everything below is safe to
+	// call from any other thread while it does.
+
+	// Asks process() to stop as soon as possible, it then returns false.
+	inline void request_cancel() { m_cancel_requested.store(true, std::memory_order_relaxed); }
+	inline bool is_cancel_requested() const { return m_cancel_requested.load(std::memory_order_relaxed); }
+
+	// Something inside of the file points outside of it, e.g. when the file is truncated.
+	// Whatever could be decoded is kept, but the file shouldn't be taken as processed fine.
+	inline bool is_malformed() const { return m_malformed.load(std::memory_order_relaxed); }
+
+	// In range of 0 to 1
+	inline float get_progress() const
+	{
+		uint64_t progress = m_progress.load(std::memory_order_relaxed);
+		uint32_t total = progress_total(progress);
+		return total ? std::min(1.f, (float)progress_done(progress) / total) : 0.f;
+	}
+
+	// Parts decoded on demand are still being worked on
+	inline bool is_progress_pending() const
+	{
+		uint64_t progress = m_progress.load(std::memory_order_relaxed);
+		return progress_done(progress) < progress_total(progress);
+	}
+
+	// Name of the stage that has been entered last
+	inline const char* get_progress_stage() const { return m_progress_stage.load(std::memory_order_relaxed); }
+
 protected:
+	// Called by the decoders whenever a structure they need doesn't fit into the file
+	void report_malformed(const char* what)
+	{
+		CDebugConsole::get().output_error("{} lies outside of the file, the file seems to be truncated.", what);
+		m_malformed.store(true, std::memory_order_relaxed);
+	}
+
 	// Has to be called every time we start parsing!
 	// Creates the file buffer for reading.
 	bool on_processing_start(const std::filesystem::path& filepath)
 	{
 		m_input_file = filepath;
 
-		CDebugConsole::get().output_message(std::format("Input file: {}", m_input_file.string()));
+		CDebugConsole::get().output_message<LogCategory::Parser>("Input file: {}", m_input_file.string());
 
 		if (!check_file_permissions())
 		{
@@ -63,7 +113,7 @@ protected:
 		}
 
 		m_start_timestamp = std::chrono::high_resolution_clock::now();
-		uint32_t filesize;
+		uint64_t filesize;
 
 		// This should be the first call to filesystem. We'll catch errors here if any.
 		try
@@ -76,9 +126,14 @@ protected:
 			return false;
 		}
 
-		m_byte_buffer.create(m_input_file, filesize);
+		// Map the file rather than reading it, the OS pages in only what we touch.
+		if (!m_byte_buffer.map(m_input_file, filesize))
+		{
+			CDebugConsole::get().output_error("Failed to map the input file.");
+			return false;
+		}
 
-		CDebugConsole::get().output_message("Created file data to read");
+		CDebugConsole::get().output_message<LogCategory::Parser>("Mapped file data to read");
 
 		return true;
 	}
@@ -86,15 +141,32 @@ protected:
 	// Has to be called when the processor has finished parsing
 	void on_processing_end()
 	{
-		m_processed = true;
+		m_processed.store(true, std::memory_order_release);
 
 		m_end_timestamp = std::chrono::high_resolution_clock::now();
 
-		m_byte_buffer.destroy();
+		CDebugConsole::get().output_message<LogCategory::Parser>("Took {} seconds to process", get_process_time_sec());
+	}
+
+	// Progress is reported in steps of equal weight. The stage name is read from
+	// other threads without any lock, it has to live as long as the processor.
+	inline void begin_progress(uint32_t num_steps) { m_progress.store((uint64_t)num_steps << 32, std::memory_order_relaxed); }
 
-		CDebugConsole::get().output_message(std::format("Took {} seconds to process", get_process_time_sec()));
+	// Steps of work that's started later on, e.g. parts that are decoded on demand. Once all
+	// the previous steps are done, the progress starts over with just these.
+	inline void add_progress_steps(uint32_t num_steps)
+	{
+		uint64_t progress = m_progress.load(std::memory_order_relaxed), next;
+		do
+		{
+			uint32_t total = progress_total(progress);
+			next = progress_done(progress) == total ? (uint64_t)num_steps << 32 : progress + ((uint64_t)num_steps << 32);
+		} while (!m_progress.compare_exchange_weak(progress, next, std::memory_order_relaxed));
 	}
 
+	inline void enter_progress_stage(const char* stage) { m_progress_stage.store(stage, std::memory_order_relaxed); }
+	inline void complete_progress_steps(uint32_t num_steps = 1) { m_progress.fetch_add(num_steps, std::memory_order_relaxed); }
+
 	// Return processing time in seconds since the processing has started
 	inline double get_process_time_sec() const
 	{
@@ -123,15 +195,27 @@ private:
 		//	return false;
 		//}
 
-		CDebugConsole::get().output_message("Enough permission to process the file.");
+		CDebugConsole::get().output_message<LogCategory::Parser>("Enough permission to process the file.");
 
 		return true;
 	}
 
 protected:
-	ByteBuffer<uint32_t> m_byte_buffer;
+	// Addressed with 64-bit file offsets, so that large installers and memory dumps
+	// don't wrap around. RVAs inside of the image itself stay 32-bit.
+	ByteBuffer<uint64_t> m_byte_buffer;
+
+	std::atomic<bool> m_processed = false;
+
+	std::atomic<bool> m_cancel_requested = false;
+	std::atomic<bool> m_malformed = false;
 
-	bool m_processed = false;
+	// Total steps in the upper half, steps done in the lower one. Kept together, so that
+	// starting over can't lose a step that's being completed at the same time.
+	std::atomic<uint64_t> m_progress = 0;
+	static inline uint32_t progress_done(uint64_t progress) { return (uint32_t)progress; }
+	static inline uint32_t progress_total(uint64_t progress) { return (uint32_t)(progress >> 32); }
+	std::atomic<const char*> m_progress_stage = "Starting";
 
 	using TimePoint_t = std::chrono::high_resolution_clock::time_point;
 	TimePoint_t	m_start_timestamp, m_end_timestamp;
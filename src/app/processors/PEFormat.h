@@ -0,0 +1,833 @@
+/*
+*	x86executable_inspector developed by oxiKKK
+*	Copyright (c) 2023
+*
+*	This program is licensed under the MIT license. By downloading, copying,
+*	installing or using this software you agree to this license.
+*
+*	License Agreement
+*
+*	Permission is hereby granted, free of charge, to any person obtaining a
+*	copy of this software and associated documentation files (the "Software"),
+*	to deal in the Software without restriction, including without limitation
+*	the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*	and/or sell copies of the Software, and to permit persons to whom the
+*	Software is furnished to do so, subject to the following conditions:
+*
+*	The above copyright notice and this permission notice shall be included
+*	in all copies or substantial portions of the Software.
+*
+*	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+*	OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+*	THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+*	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+*	IN THE SOFTWARE.
+*/
+
+#ifndef EXEIN_PE_FORMAT_H
+#define EXEIN_PE_FORMAT_H
+
+#pragma once
+
+// On-disk layouts of the PE image structures we parse. These mirror the ones
+// from the Windows SDK (field names included), but are fixed-width and packed,
+// so that the parser doesn't depend on any platform header. Structures that differ
+// between PE32 and PE32+ images come in both layouts, see the image format traits
+// at the bottom.
+//
+// https://learn.microsoft.com/en-us/windows/win32/debug/pe-format
+
+// Every multi-byte field is read straight out of the mapped image.
+static_assert(std::endian::native == std::endian::little, "PE structures are little-endian, big-endian hosts aren't supported.");
+
+namespace pe
+{
+
+//===========================================================================
+// 
+// Constants
+// 
+//===========================================================================
+
+// Signatures
+inline constexpr uint16_t k_dos_signature = 0x5A4D; // MZ
+inline constexpr uint16_t k_os2_signature = 0x454E; // NE
+inline constexpr uint16_t k_os2_signature_le = 0x454C; // LE
+inline constexpr uint16_t k_vxd_signature = 0x454C; // LE
+inline constexpr uint32_t k_nt_signature = 0x00004550; // PE00
+
+// Machine types
+inline constexpr uint16_t k_file_machine_unknown = 0x0000;
+inline constexpr uint16_t k_file_machine_target_host = 0x0001;
+inline constexpr uint16_t k_file_machine_i386 = 0x014C;
+inline constexpr uint16_t k_file_machine_r3000 = 0x0162;
+inline constexpr uint16_t k_file_machine_r4000 = 0x0166;
+inline constexpr uint16_t k_file_machine_r10000 = 0x0168;
+inline constexpr uint16_t k_file_machine_wcemipsv2 = 0x0169;
+inline constexpr uint16_t k_file_machine_alpha = 0x0184;
+inline constexpr uint16_t k_file_machine_sh3 = 0x01A2;
+inline constexpr uint16_t k_file_machine_sh3dsp = 0x01A3;
+inline constexpr uint16_t k_file_machine_sh3e = 0x01A4;
+inline constexpr uint16_t k_file_machine_sh4 = 0x01A6;
+inline constexpr uint16_t k_file_machine_sh5 = 0x01A8;
+inline constexpr uint16_t k_file_machine_arm = 0x01C0;
+inline constexpr uint16_t k_file_machine_thumb = 0x01C2;
+inline constexpr uint16_t k_file_machine_armnt = 0x01C4;
+inline constexpr uint16_t k_file_machine_am33 = 0x01D3;
+inline constexpr uint16_t k_file_machine_powerpc = 0x01F0;
+inline constexpr uint16_t k_file_machine_powerpcfp = 0x01F1;
+inline constexpr uint16_t k_file_machine_ia64 = 0x0200;
+inline constexpr uint16_t k_file_machine_mips16 = 0x0266;
+inline constexpr uint16_t k_file_machine_alpha64 = 0x0284;
+inline constexpr uint16_t k_file_machine_mipsfpu = 0x0366;
+inline constexpr uint16_t k_file_machine_mipsfpu16 = 0x0466;
+inline constexpr uint16_t k_file_machine_tricore = 0x0520;
+inline constexpr uint16_t k_file_machine_cef = 0x0CEF;
+inline constexpr uint16_t k_file_machine_ebc = 0x0EBC;
+inline constexpr uint16_t k_file_machine_amd64 = 0x8664;
+inline constexpr uint16_t k_file_machine_m32r = 0x9041;
+inline constexpr uint16_t k_file_machine_arm64 = 0xAA64;
+inline constexpr uint16_t k_file_machine_cee = 0xC0EE;
+
+// File header characteristics
+inline constexpr uint16_t k_file_relocs_stripped = 0x0001;
+inline constexpr uint16_t k_file_executable_image = 0x0002;
+inline constexpr uint16_t k_file_line_nums_stripped = 0x0004;
+inline constexpr uint16_t k_file_local_syms_stripped = 0x0008;
+inline constexpr uint16_t k_file_aggresive_ws_trim = 0x0010;
+inline constexpr uint16_t k_file_large_address_aware = 0x0020;
+inline constexpr uint16_t k_file_bytes_reversed_lo = 0x0080;
+inline constexpr uint16_t k_file_32bit_machine = 0x0100;
+inline constexpr uint16_t k_file_debug_stripped = 0x0200;
+inline constexpr uint16_t k_file_removable_run_from_swap = 0x0400;
+inline constexpr uint16_t k_file_net_run_from_swap = 0x0800;
+inline constexpr uint16_t k_file_system = 0x1000;
+inline constexpr uint16_t k_file_dll = 0x2000;
+inline constexpr uint16_t k_file_up_system_only = 0x4000;
+inline constexpr uint16_t k_file_bytes_reversed_hi = 0x8000;
+
+// Optional header magic
+inline constexpr uint16_t k_nt_optional_hdr32_magic = 0x010B;
+inline constexpr uint16_t k_nt_optional_hdr64_magic = 0x020B;
+inline constexpr uint16_t k_rom_optional_hdr_magic = 0x0107;
+
+// Subsystems
+inline constexpr uint16_t k_subsystem_unknown = 0;
+inline constexpr uint16_t k_subsystem_native = 1;
+inline constexpr uint16_t k_subsystem_windows_gui = 2;
+inline constexpr uint16_t k_subsystem_windows_cui = 3;
+inline constexpr uint16_t k_subsystem_os2_cui = 5;
+inline constexpr uint16_t k_subsystem_posix_cui = 7;
+inline constexpr uint16_t k_subsystem_native_windows = 8;
+inline constexpr uint16_t k_subsystem_windows_ce_gui = 9;
+inline constexpr uint16_t k_subsystem_efi_application = 10;
+inline constexpr uint16_t k_subsystem_efi_boot_service_driver = 11;
+inline constexpr uint16_t k_subsystem_efi_runtime_driver = 12;
+inline constexpr uint16_t k_subsystem_efi_rom = 13;
+inline constexpr uint16_t k_subsystem_xbox = 14;
+inline constexpr uint16_t k_subsystem_windows_boot_application = 16;
+
+// DLL characteristics
+inline constexpr uint16_t k_dllcharacteristics_high_entropy_va = 0x0020;
+inline constexpr uint16_t k_dllcharacteristics_dynamic_base = 0x0040;
+inline constexpr uint16_t k_dllcharacteristics_force_integrity = 0x0080;
+inline constexpr uint16_t k_dllcharacteristics_nx_compat = 0x0100;
+inline constexpr uint16_t k_dllcharacteristics_no_isolation = 0x0200;
+inline constexpr uint16_t k_dllcharacteristics_no_seh = 0x0400;
+inline constexpr uint16_t k_dllcharacteristics_no_bind = 0x0800;
+inline constexpr uint16_t k_dllcharacteristics_appcontainer = 0x1000;
+inline constexpr uint16_t k_dllcharacteristics_wdm_driver = 0x2000;
+inline constexpr uint16_t k_dllcharacteristics_guard_cf = 0x4000;
+inline constexpr uint16_t k_dllcharacteristics_terminal_server_aware = 0x8000;
+
+// Data directory indexes
+inline constexpr uint32_t k_directory_entry_export = 0;
+inline constexpr uint32_t k_directory_entry_import = 1;
+inline constexpr uint32_t k_directory_entry_resource = 2;
+inline constexpr uint32_t k_directory_entry_exception = 3;
+inline constexpr uint32_t k_directory_entry_security = 4;
+inline constexpr uint32_t k_directory_entry_basereloc = 5;
+inline constexpr uint32_t k_directory_entry_debug = 6;
+inline constexpr uint32_t k_directory_entry_architecture = 7;
+inline constexpr uint32_t k_directory_entry_globalptr = 8;
+inline constexpr uint32_t k_directory_entry_tls = 9;
+inline constexpr uint32_t k_directory_entry_load_config = 10;
+inline constexpr uint32_t k_directory_entry_bound_import = 11;
+inline constexpr uint32_t k_directory_entry_iat = 12;
+inline constexpr uint32_t k_directory_entry_delay_import = 13;
+inline constexpr uint32_t k_directory_entry_com_descriptor = 14;
+
+inline constexpr uint32_t k_numberof_directory_entries = 16;
+
+// Section headers
+inline constexpr uint32_t k_sizeof_short_name = 8;
+inline constexpr uint32_t k_sizeof_section_header = 40;
+
+inline constexpr uint32_t k_scn_type_no_pad = 0x00000008;
+inline constexpr uint32_t k_scn_cnt_code = 0x00000020;
+inline constexpr uint32_t k_scn_cnt_initialized_data = 0x00000040;
+inline constexpr uint32_t k_scn_cnt_uninitialized_data = 0x00000080;
+inline constexpr uint32_t k_scn_lnk_other = 0x00000100;
+inline constexpr uint32_t k_scn_lnk_info = 0x00000200;
+inline constexpr uint32_t k_scn_lnk_remove = 0x00000800;
+inline constexpr uint32_t k_scn_lnk_comdat = 0x00001000;
+inline constexpr uint32_t k_scn_gprel = 0x00008000;
+inline constexpr uint32_t k_scn_mem_purgeable = 0x00020000;
+inline constexpr uint32_t k_scn_mem_16bit = 0x00020000;
+inline constexpr uint32_t k_scn_mem_locked = 0x00040000;
+inline constexpr uint32_t k_scn_mem_preload = 0x00080000;
+inline constexpr uint32_t k_scn_align_1bytes = 0x00100000;
+inline constexpr uint32_t k_scn_align_2bytes = 0x00200000;
+inline constexpr uint32_t k_scn_align_128bytes = 0x00800000;
+inline constexpr uint32_t k_scn_lnk_nreloc_ovfl = 0x01000000;
+inline constexpr uint32_t k_scn_mem_discardable = 0x02000000;
+inline constexpr uint32_t k_scn_mem_not_cached = 0x04000000;
+inline constexpr uint32_t k_scn_mem_not_paged = 0x08000000;
+inline constexpr uint32_t k_scn_mem_shared = 0x10000000;
+inline constexpr uint32_t k_scn_mem_execute = 0x20000000;
+inline constexpr uint32_t k_scn_mem_read = 0x40000000;
+inline constexpr uint32_t k_scn_mem_write = 0x80000000;
+
+// Base relocation types
+inline constexpr uint8_t k_rel_based_absolute = 0;
+inline constexpr uint8_t k_rel_based_high = 1;
+inline constexpr uint8_t k_rel_based_low = 2;
+inline constexpr uint8_t k_rel_based_highlow = 3;
+inline constexpr uint8_t k_rel_based_highadj = 4;
+inline constexpr uint8_t k_rel_based_machine_specific_5 = 5;
+inline constexpr uint8_t k_rel_based_reserved = 6;
+inline constexpr uint8_t k_rel_based_machine_specific_7 = 7;
+inline constexpr uint8_t k_rel_based_machine_specific_8 = 8;
+inline constexpr uint8_t k_rel_based_machine_specific_9 = 9;
+inline constexpr uint8_t k_rel_based_dir64 = 10;
+
+// Debug directory types
+inline constexpr uint32_t k_debug_type_unknown = 0;
+inline constexpr uint32_t k_debug_type_coff = 1;
+inline constexpr uint32_t k_debug_type_codeview = 2;
+inline constexpr uint32_t k_debug_type_fpo = 3;
+inline constexpr uint32_t k_debug_type_misc = 4;
+inline constexpr uint32_t k_debug_type_exception = 5;
+inline constexpr uint32_t k_debug_type_fixup = 6;
+inline constexpr uint32_t k_debug_type_omap_to_src = 7;
+inline constexpr uint32_t k_debug_type_omap_from_src = 8;
+inline constexpr uint32_t k_debug_type_borland = 9;
+inline constexpr uint32_t k_debug_type_reserved10 = 10;
+inline constexpr uint32_t k_debug_type_clsid = 11;
+inline constexpr uint32_t k_debug_type_vc_feature = 12;
+inline constexpr uint32_t k_debug_type_pogo = 13;
+inline constexpr uint32_t k_debug_type_iltcg = 14;
+inline constexpr uint32_t k_debug_type_mpx = 15;
+inline constexpr uint32_t k_debug_type_repro = 16;
+inline constexpr uint32_t k_debug_type_ex_dllcharacteristics = 20;
+
+// Resource types, ids of the entries at the first level of the resource tree
+inline constexpr uint16_t k_rt_cursor = 1;
+inline constexpr uint16_t k_rt_bitmap = 2;
+inline constexpr uint16_t k_rt_icon = 3;
+inline constexpr uint16_t k_rt_menu = 4;
+inline constexpr uint16_t k_rt_dialog = 5;
+inline constexpr uint16_t k_rt_string = 6;
+inline constexpr uint16_t k_rt_fontdir = 7;
+inline constexpr uint16_t k_rt_font = 8;
+inline constexpr uint16_t k_rt_accelerator = 9;
+inline constexpr uint16_t k_rt_rcdata = 10;
+inline constexpr uint16_t k_rt_messagetable = 11;
+inline constexpr uint16_t k_rt_group_cursor = 12;
+inline constexpr uint16_t k_rt_group_icon = 14;
+inline constexpr uint16_t k_rt_version = 16;
+inline constexpr uint16_t k_rt_dlginclude = 17;
+inline constexpr uint16_t k_rt_plugplay = 19;
+inline constexpr uint16_t k_rt_vxd = 20;
+inline constexpr uint16_t k_rt_anicursor = 21;
+inline constexpr uint16_t k_rt_aniicon = 22;
+inline constexpr uint16_t k_rt_html = 23;
+inline constexpr uint16_t k_rt_manifest = 24;
+
+// Version resource
+inline constexpr uint32_t k_vs_ffi_signature = 0xFEEF04BD;
+
+// Load config guard flags
+inline constexpr uint32_t k_guard_cf_instrumented = 0x00000100;
+inline constexpr uint32_t k_guard_cfw_instrumented = 0x00000200;
+inline constexpr uint32_t k_guard_cf_function_table_present = 0x00000400;
+inline constexpr uint32_t k_guard_security_cookie_unused = 0x00000800;
+inline constexpr uint32_t k_guard_protect_delayload_iat = 0x00001000;
+inline constexpr uint32_t k_guard_delayload_iat_in_its_own_section = 0x00002000;
+inline constexpr uint32_t k_guard_cf_export_suppression_info_present = 0x00004000;
+inline constexpr uint32_t k_guard_cf_enable_export_suppression = 0x00008000;
+inline constexpr uint32_t k_guard_cf_longjump_table_present = 0x00010000;
+inline constexpr uint32_t k_guard_rf_instrumented = 0x00020000;
+inline constexpr uint32_t k_guard_rf_enable = 0x00040000;
+inline constexpr uint32_t k_guard_rf_strict = 0x00080000;
+inline constexpr uint32_t k_guard_retpoline_present = 0x00100000;
+inline constexpr uint32_t k_guard_eh_continuation_table_present = 0x00400000;
+
+// Process heap flags, as stored inside the load config
+inline constexpr uint32_t k_heap_no_serialize = 0x00000001;
+inline constexpr uint32_t k_heap_growable = 0x00000002;
+inline constexpr uint32_t k_heap_generate_exceptions = 0x00000004;
+inline constexpr uint32_t k_heap_zero_memory = 0x00000008;
+inline constexpr uint32_t k_heap_realloc_in_place_only = 0x00000010;
+inline constexpr uint32_t k_heap_tail_checking_enabled = 0x00000020;
+inline constexpr uint32_t k_heap_free_checking_enabled = 0x00000040;
+inline constexpr uint32_t k_heap_disable_coalesce_on_free = 0x00000080;
+inline constexpr uint32_t k_heap_create_segment_heap = 0x00000100;
+inline constexpr uint32_t k_heap_create_hardened = 0x00000200;
+inline constexpr uint32_t k_heap_create_align_16 = 0x00010000;
+inline constexpr uint32_t k_heap_create_enable_tracing = 0x00020000;
+inline constexpr uint32_t k_heap_create_enable_execute = 0x00040000;
+
+// Attribute certificates
+inline constexpr uint16_t k_win_cert_revision_1_0 = 0x0100;
+inline constexpr uint16_t k_win_cert_revision_2_0 = 0x0200;
+
+inline constexpr uint16_t k_win_cert_type_x509 = 0x0001;
+inline constexpr uint16_t k_win_cert_type_pkcs_signed_data = 0x0002;
+inline constexpr uint16_t k_win_cert_type_reserved_1 = 0x0003;
+inline constexpr uint16_t k_win_cert_type_ts_stack_signed = 0x0004;
+
+// Delay load descriptor attributes
+inline constexpr uint32_t k_dlattr_rva = 0x1;
+
+// Import thunks
+inline constexpr uint32_t k_ordinal_flag32 = 0x80000000;
+inline constexpr uint64_t k_ordinal_flag64 = 0x8000000000000000;
+
+inline constexpr bool snap_by_ordinal32(uint32_t thunk) { return (thunk & k_ordinal_flag32) != 0; }
+inline constexpr bool snap_by_ordinal64(uint64_t thunk) { return (thunk & k_ordinal_flag64) != 0; }
+inline constexpr uint16_t ordinal(uint64_t thunk) { return thunk & 0xFFFF; }
+
+//===========================================================================
+// 
+// Structures
+// 
+//===========================================================================
+
+#pragma pack(push, 1)
+
+struct ImageDosHeader
+{
+	uint16_t	e_magic;
+	uint16_t	e_cblp;
+	uint16_t	e_cp;
+	uint16_t	e_crlc;
+	uint16_t	e_cparhdr;
+	uint16_t	e_minalloc;
+	uint16_t	e_maxalloc;
+	uint16_t	e_ss;
+	uint16_t	e_sp;
+	uint16_t	e_csum;
+	uint16_t	e_ip;
+	uint16_t	e_cs;
+	uint16_t	e_lfarlc;
+	uint16_t	e_ovno;
+	uint16_t	e_res[4];
+	uint16_t	e_oemid;
+	uint16_t	e_oeminfo;
+	uint16_t	e_res2[10];
+	int32_t		e_lfanew;
+};
+
+struct ImageFileHeader
+{
+	uint16_t	Machine;
+	uint16_t	NumberOfSections;
+	uint32_t	TimeDateStamp;
+	uint32_t	PointerToSymbolTable;
+	uint32_t	NumberOfSymbols;
+	uint16_t	SizeOfOptionalHeader;
+	uint16_t	Characteristics;
+};
+
+struct ImageDataDirectory
+{
+	uint32_t	VirtualAddress;
+	uint32_t	Size;
+};
+
+struct ImageOptionalHeader32
+{
+	uint16_t	Magic;
+	uint8_t		MajorLinkerVersion;
+	uint8_t		MinorLinkerVersion;
+	uint32_t	SizeOfCode;
+	uint32_t	SizeOfInitializedData;
+	uint32_t	SizeOfUninitializedData;
+	uint32_t	AddressOfEntryPoint;
+	uint32_t	BaseOfCode;
+	uint32_t	BaseOfData;
+	uint32_t	ImageBase;
+	uint32_t	SectionAlignment;
+	uint32_t	FileAlignment;
+	uint16_t	MajorOperatingSystemVersion;
+	uint16_t	MinorOperatingSystemVersion;
+	uint16_t	MajorImageVersion;
+	uint16_t	MinorImageVersion;
+	uint16_t	MajorSubsystemVersion;
+	uint16_t	MinorSubsystemVersion;
+	uint32_t	Win32VersionValue;
+	uint32_t	SizeOfImage;
+	uint32_t	SizeOfHeaders;
+	uint32_t	CheckSum;
+	uint16_t	Subsystem;
+	uint16_t	DllCharacteristics;
+	uint32_t	SizeOfStackReserve;
+	uint32_t	SizeOfStackCommit;
+	uint32_t	SizeOfHeapReserve;
+	uint32_t	SizeOfHeapCommit;
+	uint32_t	LoaderFlags;
+	uint32_t	NumberOfRvaAndSizes;
+	ImageDataDirectory DataDirectory[k_numberof_directory_entries];
+};
+
+struct ImageNtHeaders32
+{
+	uint32_t				Signature;
+	ImageFileHeader			FileHeader;
+	ImageOptionalHeader32	OptionalHeader;
+};
+
+struct ImageOptionalHeader64
+{
+	uint16_t	Magic;
+	uint8_t		MajorLinkerVersion;
+	uint8_t		MinorLinkerVersion;
+	uint32_t	SizeOfCode;
+	uint32_t	SizeOfInitializedData;
+	uint32_t	SizeOfUninitializedData;
+	uint32_t	AddressOfEntryPoint;
+	uint32_t	BaseOfCode;
+	uint64_t	ImageBase;
+	uint32_t	SectionAlignment;
+	uint32_t	FileAlignment;
+	uint16_t	MajorOperatingSystemVersion;
+	uint16_t	MinorOperatingSystemVersion;
+	uint16_t	MajorImageVersion;
+	uint16_t	MinorImageVersion;
+	uint16_t	MajorSubsystemVersion;
+	uint16_t	MinorSubsystemVersion;
+	uint32_t	Win32VersionValue;
+	uint32_t	SizeOfImage;
+	uint32_t	SizeOfHeaders;
+	uint32_t	CheckSum;
+	uint16_t	Subsystem;
+	uint16_t	DllCharacteristics;
+	uint64_t	SizeOfStackReserve;
+	uint64_t	SizeOfStackCommit;
+	uint64_t	SizeOfHeapReserve;
+	uint64_t	SizeOfHeapCommit;
+	uint32_t	LoaderFlags;
+	uint32_t	NumberOfRvaAndSizes;
+	ImageDataDirectory DataDirectory[k_numberof_directory_entries];
+};
+
+struct ImageNtHeaders64
+{
+	uint32_t				Signature;
+	ImageFileHeader			FileHeader;
+	ImageOptionalHeader64	OptionalHeader;
+};
+
+struct ImageSectionHeader
+{
+	char		Name[k_sizeof_short_name];
+	union
+	{
+		uint32_t PhysicalAddress;
+		uint32_t VirtualSize;
+	} Misc;
+	uint32_t	VirtualAddress;
+	uint32_t	SizeOfRawData;
+	uint32_t	PointerToRawData;
+	uint32_t	PointerToRelocations;
+	uint32_t	PointerToLinenumbers;
+	uint16_t	NumberOfRelocations;
+	uint16_t	NumberOfLinenumbers;
+	uint32_t	Characteristics;
+};
+
+struct ImageExportDirectory
+{
+	uint32_t	Characteristics;
+	uint32_t	TimeDateStamp;
+	uint16_t	MajorVersion;
+	uint16_t	MinorVersion;
+	uint32_t	Name;
+	uint32_t	Base;
+	uint32_t	NumberOfFunctions;
+	uint32_t	NumberOfNames;
+	uint32_t	AddressOfFunctions;
+	uint32_t	AddressOfNames;
+	uint32_t	AddressOfNameOrdinals;
+};
+
+struct ImageImportDescriptor
+{
+	union
+	{
+		uint32_t Characteristics; // 0 for the terminating null descriptor
+		uint32_t OriginalFirstThunk; // RVA to the original unbound IAT (ImageThunkData32)
+	};
+	uint32_t	TimeDateStamp;
+	uint32_t	ForwarderChain;
+	uint32_t	Name;
+	uint32_t	FirstThunk;
+};
+
+struct ImageThunkData32
+{
+	union
+	{
+		uint32_t ForwarderString;
+		uint32_t Function;
+		uint32_t Ordinal;
+		uint32_t AddressOfData; // RVA to ImageImportByName
+	} u1;
+};
+
+struct ImageThunkData64
+{
+	union
+	{
+		uint64_t ForwarderString;
+		uint64_t Function;
+		uint64_t Ordinal;
+		uint64_t AddressOfData; // RVA to ImageImportByName
+	} u1;
+};
+
+struct ImageImportByName
+{
+	uint16_t	Hint;
+	char		Name[1];
+};
+
+struct ImageDelayLoadDescriptor
+{
+	uint32_t	grAttrs; // k_dlattr_rva when the fields below are RVAs
+	uint32_t	rvaDLLName;
+	uint32_t	rvaHmod;
+	uint32_t	rvaIAT;
+	uint32_t	rvaINT;
+	uint32_t	rvaBoundIAT;
+	uint32_t	rvaUnloadIAT;
+	uint32_t	dwTimeStamp;
+};
+
+struct ImageResourceDirectory
+{
+	uint32_t	Characteristics;
+	uint32_t	TimeDateStamp;
+	uint16_t	MajorVersion;
+	uint16_t	MinorVersion;
+	uint16_t	NumberOfNamedEntries;
+	uint16_t	NumberOfIdEntries;
+};
+
+// The SDK describes the high bits with bitfields, we decode them by hand.
+struct ImageResourceDirectoryEntry
+{
+	uint32_t	Name;
+	uint32_t	OffsetToData;
+
+	inline bool name_is_string() const { return (Name & 0x80000000) != 0; }
+	inline uint32_t name_offset() const { return Name & 0x7FFFFFFF; }
+	inline uint16_t id() const { return Name & 0xFFFF; }
+
+	inline bool data_is_directory() const { return (OffsetToData & 0x80000000) != 0; }
+	inline uint32_t offset_to_directory() const { return OffsetToData & 0x7FFFFFFF; }
+};
+
+struct ImageResourceDataEntry
+{
+	uint32_t	OffsetToData; // RVA, unlike the offsets inside of the directory entries
+	uint32_t	Size;
+	uint32_t	CodePage;
+	uint32_t	Reserved;
+};
+
+// Names of the entries are counted UTF-16 strings, not NUL-terminated
+struct ImageResourceDirStringU
+{
+	uint16_t	Length; // In characters
+	uint16_t	NameString[1];
+};
+
+struct ImageRuntimeFunctionEntry
+{
+	uint32_t	BeginAddress;
+	uint32_t	EndAddress;
+	union
+	{
+		uint32_t UnwindInfoAddress;
+		uint32_t UnwindData;
+	};
+};
+
+struct WinCertificate
+{
+	uint32_t	dwLength;
+	uint16_t	wRevision;
+	uint16_t	wCertificateType;
+	uint8_t		bCertificate[1];
+};
+
+struct ImageBaseRelocation
+{
+	uint32_t	VirtualAddress;
+	uint32_t	SizeOfBlock;
+	// uint16_t TypeOffset[1];
+};
+
+struct ImageDebugDirectory
+{
+	uint32_t	Characteristics;
+	uint32_t	TimeDateStamp;
+	uint16_t	MajorVersion;
+	uint16_t	MinorVersion;
+	uint32_t	Type;
+	uint32_t	SizeOfData;
+	uint32_t	AddressOfRawData;
+	uint32_t	PointerToRawData;
+};
+
+struct ImageTlsDirectory32
+{
+	uint32_t	StartAddressOfRawData;
+	uint32_t	EndAddressOfRawData;
+	uint32_t	AddressOfIndex;
+	uint32_t	AddressOfCallBacks;
+	uint32_t	SizeOfZeroFill;
+	uint32_t	Characteristics;
+};
+
+struct ImageTlsDirectory64
+{
+	uint64_t	StartAddressOfRawData;
+	uint64_t	EndAddressOfRawData;
+	uint64_t	AddressOfIndex;
+	uint64_t	AddressOfCallBacks;
+	uint32_t	SizeOfZeroFill;
+	uint32_t	Characteristics;
+};
+
+struct ImageLoadConfigCodeIntegrity
+{
+	uint16_t	Flags;
+	uint16_t	Catalog;
+	uint32_t	CatalogOffset;
+	uint32_t	Reserved;
+};
+
+// Layout as of the Windows 11 SDK. Older linkers emit a shorter directory.
+struct ImageLoadConfigDirectory32
+{
+	uint32_t	Size;
+	uint32_t	TimeDateStamp;
+	uint16_t	MajorVersion;
+	uint16_t	MinorVersion;
+	uint32_t	GlobalFlagsClear;
+	uint32_t	GlobalFlagsSet;
+	uint32_t	CriticalSectionDefaultTimeout;
+	uint32_t	DeCommitFreeBlockThreshold;
+	uint32_t	DeCommitTotalFreeThreshold;
+	uint32_t	LockPrefixTable;
+	uint32_t	MaximumAllocationSize;
+	uint32_t	VirtualMemoryThreshold;
+	uint32_t	ProcessHeapFlags;
+	uint32_t	ProcessAffinityMask;
+	uint16_t	CSDVersion;
+	uint16_t	DependentLoadFlags;
+	uint32_t	EditList;
+	uint32_t	SecurityCookie;
+	uint32_t	SEHandlerTable;
+	uint32_t	SEHandlerCount;
+	uint32_t	GuardCFCheckFunctionPointer;
+	uint32_t	GuardCFDispatchFunctionPointer;
+	uint32_t	GuardCFFunctionTable;
+	uint32_t	GuardCFFunctionCount;
+	uint32_t	GuardFlags;
+	ImageLoadConfigCodeIntegrity CodeIntegrity;
+	uint32_t	GuardAddressTakenIatEntryTable;
+	uint32_t	GuardAddressTakenIatEntryCount;
+	uint32_t	GuardLongJumpTargetTable;
+	uint32_t	GuardLongJumpTargetCount;
+	uint32_t	DynamicValueRelocTable;
+	uint32_t	CHPEMetadataPointer;
+	uint32_t	GuardRFFailureRoutine;
+	uint32_t	GuardRFFailureRoutineFunctionPointer;
+	uint32_t	DynamicValueRelocTableOffset;
+	uint16_t	DynamicValueRelocTableSection;
+	uint16_t	Reserved2;
+	uint32_t	GuardRFVerifyStackPointerFunctionPointer;
+	uint32_t	HotPatchTableOffset;
+	uint32_t	Reserved3;
+	uint32_t	EnclaveConfigurationPointer;
+	uint32_t	VolatileMetadataPointer;
+	uint32_t	GuardEHContinuationTable;
+	uint32_t	GuardEHContinuationCount;
+	uint32_t	GuardXFGCheckFunctionPointer;
+	uint32_t	GuardXFGDispatchFunctionPointer;
+	uint32_t	GuardXFGTableDispatchFunctionPointer;
+	uint32_t	CastGuardOsDeterminedFailureMode;
+	uint32_t	GuardMemcpyFunctionPointer;
+};
+
+// Not only wider than the 32-bit one, ProcessAffinityMask comes before ProcessHeapFlags here.
+struct ImageLoadConfigDirectory64
+{
+	uint32_t	Size;
+	uint32_t	TimeDateStamp;
+	uint16_t	MajorVersion;
+	uint16_t	MinorVersion;
+	uint32_t	GlobalFlagsClear;
+	uint32_t	GlobalFlagsSet;
+	uint32_t	CriticalSectionDefaultTimeout;
+	uint64_t	DeCommitFreeBlockThreshold;
+	uint64_t	DeCommitTotalFreeThreshold;
+	uint64_t	LockPrefixTable;
+	uint64_t	MaximumAllocationSize;
+	uint64_t	VirtualMemoryThreshold;
+	uint64_t	ProcessAffinityMask;
+	uint32_t	ProcessHeapFlags;
+	uint16_t	CSDVersion;
+	uint16_t	DependentLoadFlags;
+	uint64_t	EditList;
+	uint64_t	SecurityCookie;
+	uint64_t	SEHandlerTable;
+	uint64_t	SEHandlerCount;
+	uint64_t	GuardCFCheckFunctionPointer;
+	uint64_t	GuardCFDispatchFunctionPointer;
+	uint64_t	GuardCFFunctionTable;
+	uint64_t	GuardCFFunctionCount;
+	uint32_t	GuardFlags;
+	ImageLoadConfigCodeIntegrity CodeIntegrity;
+	uint64_t	GuardAddressTakenIatEntryTable;
+	uint64_t	GuardAddressTakenIatEntryCount;
+	uint64_t	GuardLongJumpTargetTable;
+	uint64_t	GuardLongJumpTargetCount;
+	uint64_t	DynamicValueRelocTable;
+	uint64_t	CHPEMetadataPointer;
+	uint64_t	GuardRFFailureRoutine;
+	uint64_t	GuardRFFailureRoutineFunctionPointer;
+	uint32_t	DynamicValueRelocTableOffset;
+	uint16_t	DynamicValueRelocTableSection;
+	uint16_t	Reserved2;
+	uint64_t	GuardRFVerifyStackPointerFunctionPointer;
+	uint32_t	HotPatchTableOffset;
+	uint32_t	Reserved3;
+	uint64_t	EnclaveConfigurationPointer;
+	uint64_t	VolatileMetadataPointer;
+	uint64_t	GuardEHContinuationTable;
+	uint64_t	GuardEHContinuationCount;
+	uint64_t	GuardXFGCheckFunctionPointer;
+	uint64_t	GuardXFGDispatchFunctionPointer;
+	uint64_t	GuardXFGTableDispatchFunctionPointer;
+	uint64_t	CastGuardOsDeterminedFailureMode;
+	uint64_t	GuardMemcpyFunctionPointer;
+};
+
+// Fixed part of the VS_VERSIONINFO resource
+struct VsFixedFileInfo
+{
+	uint32_t	dwSignature; // k_vs_ffi_signature
+	uint32_t	dwStrucVersion;
+	uint32_t	dwFileVersionMS;
+	uint32_t	dwFileVersionLS;
+	uint32_t	dwProductVersionMS;
+	uint32_t	dwProductVersionLS;
+	uint32_t	dwFileFlagsMask;
+	uint32_t	dwFileFlags;
+	uint32_t	dwFileOS;
+	uint32_t	dwFileType;
+	uint32_t	dwFileSubtype;
+	uint32_t	dwFileDateMS;
+	uint32_t	dwFileDateLS;
+};
+
+struct Guid
+{
+	uint32_t	Data1;
+	uint16_t	Data2;
+	uint16_t	Data3;
+	uint8_t		Data4[8];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(ImageDosHeader) == 64);
+static_assert(sizeof(ImageFileHeader) == 20);
+static_assert(sizeof(ImageDataDirectory) == 8);
+static_assert(sizeof(ImageOptionalHeader32) == 224);
+static_assert(sizeof(ImageNtHeaders32) == 248);
+static_assert(sizeof(ImageOptionalHeader64) == 240);
+static_assert(sizeof(ImageNtHeaders64) == 264);
+static_assert(sizeof(ImageSectionHeader) == k_sizeof_section_header);
+static_assert(sizeof(ImageExportDirectory) == 40);
+static_assert(sizeof(ImageImportDescriptor) == 20);
+static_assert(sizeof(ImageThunkData32) == 4);
+static_assert(sizeof(ImageThunkData64) == 8);
+static_assert(sizeof(ImageDelayLoadDescriptor) == 32);
+static_assert(sizeof(ImageResourceDirectory) == 16);
+static_assert(sizeof(ImageResourceDirectoryEntry) == 8);
+static_assert(sizeof(ImageResourceDataEntry) == 16);
+static_assert(sizeof(ImageRuntimeFunctionEntry) == 12);
+static_assert(sizeof(ImageBaseRelocation) == 8);
+static_assert(sizeof(ImageDebugDirectory) == 28);
+static_assert(sizeof(ImageTlsDirectory32) == 24);
+static_assert(sizeof(ImageTlsDirectory64) == 40);
+static_assert(sizeof(ImageLoadConfigCodeIntegrity) == 12);
+static_assert(sizeof(ImageLoadConfigDirectory32) == 192);
+static_assert(sizeof(ImageLoadConfigDirectory64) == 320);
+static_assert(sizeof(VsFixedFileInfo) == 52);
+static_assert(sizeof(Guid) == 16);
+
+//===========================================================================
+// 
+// Image format traits
+// 
+//===========================================================================
+
+// Everything that differs between PE32 and PE32+ images. The parser is templated over
+// these, so that either format is parsed by code of its own.
+
+struct Pe32Traits
+{
+	using Address = uint32_t; // Width of VAs stored inside of the image
+	using NtHeaders = ImageNtHeaders32;
+	using OptionalHeader = ImageOptionalHeader32;
+	using ThunkData = ImageThunkData32;
+	using TlsDirectory = ImageTlsDirectory32;
+	using LoadConfigDirectory = ImageLoadConfigDirectory32;
+
+	static constexpr uint16_t k_magic = k_nt_optional_hdr32_magic;
+	static constexpr uint16_t k_machine = k_file_machine_i386;
+
+	static inline constexpr bool snap_by_ordinal(Address thunk) { return snap_by_ordinal32(thunk); }
+};
+
+struct Pe64Traits
+{
+	using Address = uint64_t;
+	using NtHeaders = ImageNtHeaders64;
+	using OptionalHeader = ImageOptionalHeader64;
+	using ThunkData = ImageThunkData64;
+	using TlsDirectory = ImageTlsDirectory64;
+	using LoadConfigDirectory = ImageLoadConfigDirectory64;
+
+	static constexpr uint16_t k_magic = k_nt_optional_hdr64_magic;
+	static constexpr uint16_t k_machine = k_file_machine_amd64;
+
+	static inline constexpr bool snap_by_ordinal(Address thunk) { return snap_by_ordinal64(thunk); }
+};
+
+// Read by code that isn't specialized, so these have to be at the same offsets in both
+static_assert(offsetof(ImageNtHeaders32, OptionalHeader.CheckSum) == offsetof(ImageNtHeaders64, OptionalHeader.CheckSum));
+static_assert(offsetof(ImageNtHeaders32, OptionalHeader.Magic) == offsetof(ImageNtHeaders64, OptionalHeader.Magic));
+
+} // namespace pe
+
+#endif